@@ -22,9 +22,12 @@
 #define NAV2_AMCL__AMCL_NODE_HPP_
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -120,9 +123,25 @@ protected:
   rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::PoseArray>::SharedPtr particlecloud_pub_;
   rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::ParticleCloud>::SharedPtr
     particle_cloud_pub_;
+  // Latest particles, for the particle cloud to be published at its own rate
+  std::mutex particle_cloud_mutex_;
+  std::vector<pf_sample_t> particle_cloud_samples_;
+  bool particle_cloud_updated_{false};
+  rclcpp::TimerBase::SharedPtr particle_cloud_timer_;
   void initialPoseReceived(geometry_msgs::msg::PoseWithCovarianceStamped::SharedPtr msg);
   void laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan);
 
+  // Filter thread, updating the filter with the scans queued by laserReceived
+  void startFilterThread();
+  void stopFilterThread();
+  void filterThread();
+  void processScans(const std::vector<sensor_msgs::msg::LaserScan::ConstSharedPtr> & scans);
+  std::thread filter_thread_;
+  std::mutex scan_queue_mutex_;
+  std::condition_variable scan_queue_cv_;
+  std::deque<sensor_msgs::msg::LaserScan::ConstSharedPtr> scan_queue_;
+  bool filter_thread_running_{false};
+
   // Services and service callbacks
   void initServices();
   rclcpp::Service<std_srvs::srv::Empty>::SharedPtr global_loc_srv_;
@@ -189,7 +208,8 @@ protected:
     const int & laser_index,
     const sensor_msgs::msg::LaserScan::ConstSharedPtr & laser_scan,
     const pf_vector_t & pose);
-  void publishParticleCloud(const pf_sample_set_t * set);
+  void storeParticleCloud(const pf_sample_set_t * set);
+  void publishParticleCloud();
   bool getMaxWeightHyp(
     std::vector<amcl_hyp_t> & hyps, amcl_hyp_t & max_weight_hyps,
     int & max_weight_hyp);
@@ -231,8 +251,10 @@ protected:
   std::string sensor_model_type_;
   int max_beams_;
   int max_particles_;
+  int max_published_particles_;
   int min_particles_;
   std::string odom_frame_id_;
+  double particle_cloud_publish_rate_;
   double pf_err_;
   double pf_z_;
   double alpha_fast_;
@@ -240,6 +262,8 @@ protected:
   int resample_interval_;
   std::string robot_model_type_;
   tf2::Duration save_pose_period_;
+  double scan_batch_window_;
+  int scan_queue_size_;
   double sigma_hit_;
   bool tf_broadcast_;
   tf2::Duration transform_tolerance_;
@@ -36,6 +36,8 @@ public:
   virtual ~Laser();
   virtual bool sensorUpdate(pf_t * pf, LaserData * data) = 0;
   void SetLaserPose(pf_vector_t & laser_pose);
+  // Step between the beams the model uses, out of a scan of range_count beams
+  virtual int getBeamStep(int range_count) const;
 
 protected:
   double z_hit_;
@@ -102,6 +104,7 @@ public:
     double beam_skip_threshold, double beam_skip_error_threshold,
     size_t max_beams, map_t * map);
   bool sensorUpdate(pf_t * pf, LaserData * data);
+  int getBeamStep(int range_count) const;
 
 private:
   static double sensorFunction(LaserData * data, pf_sample_set_t * set);
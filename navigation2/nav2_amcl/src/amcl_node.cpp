@@ -147,6 +147,12 @@ AmclNode::AmclNode()
     "max_particles", rclcpp::ParameterValue(2000),
     "Minimum allowed number of particles");
 
+  add_parameter(
+    "max_published_particles", rclcpp::ParameterValue(0),
+    "Maximum number of particles to publish in the particle cloud, the ones with the highest "
+    "weights",
+    "0 to publish all of them");
+
   add_parameter(
     "min_particles", rclcpp::ParameterValue(500),
     "Maximum allowed number of particles");
@@ -155,6 +161,11 @@ AmclNode::AmclNode()
     "odom_frame_id", rclcpp::ParameterValue(std::string("odom")),
     "Which frame to use for odometry");
 
+  add_parameter(
+    "particle_cloud_publish_rate", rclcpp::ParameterValue(10.0),
+    "Maximum rate (Hz) at which to publish the particle cloud, apart from the filter updates",
+    "0.0 to publish it with every filter update instead");
+
   add_parameter("pf_err", rclcpp::ParameterValue(0.05));
   add_parameter("pf_z", rclcpp::ParameterValue(0.99));
 
@@ -183,6 +194,18 @@ AmclNode::AmclNode()
     "on subsequent runs to initialize the filter",
     "-1.0 to disable");
 
+  add_parameter(
+    "scan_batch_window", rclcpp::ParameterValue(0.0),
+    "Maximum time difference (s) between the scans of different lasers to update the filter "
+    "once with all of them, when using the filter thread",
+    "0.0 to update the filter with each scan");
+
+  add_parameter(
+    "scan_queue_size", rclcpp::ParameterValue(0),
+    "Size of the queue of scans for the filter thread, the oldest scans are dropped when it "
+    "is full",
+    "0 to update the filter in the scan callback instead of a filter thread");
+
   add_parameter("sigma_hit", rclcpp::ParameterValue(0.2));
 
   add_parameter(
@@ -226,6 +249,7 @@ AmclNode::AmclNode()
 AmclNode::~AmclNode()
 {
   RCLCPP_INFO(get_logger(), "Destroying");
+  stopFilterThread();
 }
 
 nav2_util::CallbackReturn
@@ -278,6 +302,14 @@ AmclNode::on_activate(const rclcpp_lifecycle::State & /*state*/)
   particlecloud_pub_->on_activate();
   particle_cloud_pub_->on_activate();
 
+  // The particle cloud is only for visualization, so it is published at its
+  // own rate rather than by the filter
+  if (particle_cloud_publish_rate_ > 0.0) {
+    particle_cloud_timer_ = create_wall_timer(
+      std::chrono::duration<double>(1.0 / particle_cloud_publish_rate_),
+      std::bind(&AmclNode::publishParticleCloud, this));
+  }
+
   RCLCPP_WARN(
     get_logger(),
     "Publishing the particle cloud as geometry_msgs/PoseArray msg is deprecated, "
@@ -289,6 +321,8 @@ AmclNode::on_activate(const rclcpp_lifecycle::State & /*state*/)
   // process incoming callbacks until we are
   active_ = true;
 
+  startFilterThread();
+
   if (set_initial_pose_) {
     auto msg = std::make_shared<geometry_msgs::msg::PoseWithCovarianceStamped>();
 
@@ -314,6 +348,9 @@ AmclNode::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
 
   active_ = false;
 
+  stopFilterThread();
+  particle_cloud_timer_.reset();
+
   // Lifecycle publishers must be explicitly deactivated
   pose_pub_->on_deactivate();
   particlecloud_pub_->on_deactivate();
@@ -351,6 +388,8 @@ AmclNode::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
   pose_pub_.reset();
   particlecloud_pub_.reset();
   particle_cloud_pub_.reset();
+  particle_cloud_samples_.clear();
+  particle_cloud_updated_ = false;
 
   // Odometry
   motion_model_.reset();
@@ -525,6 +564,8 @@ AmclNode::nomotionUpdateCallback(
   std::shared_ptr<std_srvs::srv::Empty::Response>/*res*/)
 {
   RCLCPP_INFO(get_logger(), "Requesting no-motion update");
+  // Between filter updates, so that the filter thread does not clear it before using it
+  std::lock_guard<std::mutex> lock(pf_mutex_);
   force_update_ = true;
 }
 
@@ -629,6 +670,127 @@ AmclNode::handleInitialPose(geometry_msgs::msg::PoseWithCovarianceStamped & msg)
 
 void
 AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
+{
+  if (scan_queue_size_ <= 0) {
+    processScans({laser_scan});
+    return;
+  }
+
+  // Hand the scan to the filter thread, dropping the oldest one if it is behind
+  {
+    std::lock_guard<std::mutex> lock(scan_queue_mutex_);
+    if (scan_queue_.size() >= static_cast<size_t>(scan_queue_size_)) {
+      RCLCPP_DEBUG(get_logger(), "Scan queue is full, dropping the oldest scan");
+      scan_queue_.pop_front();
+    }
+    scan_queue_.push_back(laser_scan);
+  }
+  scan_queue_cv_.notify_one();
+}
+
+void
+AmclNode::startFilterThread()
+{
+  if (scan_queue_size_ <= 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(scan_queue_mutex_);
+    scan_queue_.clear();
+    filter_thread_running_ = true;
+  }
+  filter_thread_ = std::thread(&AmclNode::filterThread, this);
+}
+
+void
+AmclNode::stopFilterThread()
+{
+  {
+    std::lock_guard<std::mutex> lock(scan_queue_mutex_);
+    filter_thread_running_ = false;
+    scan_queue_.clear();
+  }
+  scan_queue_cv_.notify_one();
+  if (filter_thread_.joinable()) {
+    filter_thread_.join();
+  }
+}
+
+void
+AmclNode::filterThread()
+{
+  // Frames of the lasers seen recently, with the number of batches since their last scan,
+  // to stop waiting once every laser is in a batch. A laser missing from this many batches
+  // in a row is forgotten, so a laser which stopped publishing does not hold up every batch.
+  const int max_missed_batches = 10;
+  std::map<std::string, int> laser_frames;
+
+  while (true) {
+    std::vector<sensor_msgs::msg::LaserScan::ConstSharedPtr> scans;
+    {
+      std::unique_lock<std::mutex> lock(scan_queue_mutex_);
+      scan_queue_cv_.wait(
+        lock, [this]() {return !filter_thread_running_ || !scan_queue_.empty();});
+      if (!filter_thread_running_) {
+        return;
+      }
+      scans.push_back(scan_queue_.front());
+      scan_queue_.pop_front();
+      laser_frames[scans.front()->header.frame_id] = 0;
+
+      // Wait for the scans of the other lasers taken within the window of the first one,
+      // to update the filter once with all of them
+      const rclcpp::Time first_stamp(scans.front()->header.stamp);
+      const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(scan_batch_window_));
+      while (scan_batch_window_ > 0.0 && scans.size() < laser_frames.size()) {
+        if (!scan_queue_cv_.wait_until(
+            lock, deadline, [this]() {return !filter_thread_running_ || !scan_queue_.empty();}))
+        {
+          break;
+        }
+        if (!filter_thread_running_) {
+          return;
+        }
+        const auto & scan = scan_queue_.front();
+        const bool same_laser = std::any_of(
+          scans.begin(), scans.end(),
+          [&scan](const sensor_msgs::msg::LaserScan::ConstSharedPtr & other) {
+            return other->header.frame_id == scan->header.frame_id;
+          });
+        if (same_laser ||
+          fabs((rclcpp::Time(scan->header.stamp) - first_stamp).seconds()) >
+          scan_batch_window_)
+        {
+          // It belongs to the next batch
+          break;
+        }
+        laser_frames[scan->header.frame_id] = 0;
+        scans.push_back(scan);
+        scan_queue_.pop_front();
+      }
+    }
+
+    for (auto it = laser_frames.begin(); it != laser_frames.end(); ) {
+      const bool in_batch = std::any_of(
+        scans.begin(), scans.end(),
+        [&it](const sensor_msgs::msg::LaserScan::ConstSharedPtr & scan) {
+          return scan->header.frame_id == it->first;
+        });
+      if (!in_batch && ++it->second > max_missed_batches) {
+        it = laser_frames.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    processScans(scans);
+  }
+}
+
+void
+AmclNode::processScans(const std::vector<sensor_msgs::msg::LaserScan::ConstSharedPtr> & scans)
 {
   std::lock_guard<std::mutex> lock(pf_mutex_);
 
@@ -643,20 +805,34 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
     return;
   }
 
-  std::string laser_scan_frame_id = nav2_util::strip_leading_slash(laser_scan->header.frame_id);
   last_laser_received_ts_ = now();
-  int laser_index = -1;
-  geometry_msgs::msg::PoseStamped laser_pose;
 
-  // Do we have the base->base_laser Tx yet?
-  if (frame_to_laser_.find(laser_scan_frame_id) == frame_to_laser_.end()) {
-    if (!addNewScanner(laser_index, laser_scan, laser_scan_frame_id, laser_pose)) {
-      return;  // could not find transform
+  std::vector<sensor_msgs::msg::LaserScan::ConstSharedPtr> laser_scans;
+  std::vector<int> laser_indices;
+  for (const auto & scan : scans) {
+    std::string laser_scan_frame_id = nav2_util::strip_leading_slash(scan->header.frame_id);
+    int laser_index = -1;
+    geometry_msgs::msg::PoseStamped laser_pose;
+
+    // Do we have the base->base_laser Tx yet?
+    if (frame_to_laser_.find(laser_scan_frame_id) == frame_to_laser_.end()) {
+      if (!addNewScanner(laser_index, scan, laser_scan_frame_id, laser_pose)) {
+        continue;  // could not find transform
+      }
+    } else {
+      // we have the laser pose, retrieve laser index
+      laser_index = frame_to_laser_[scan->header.frame_id];
     }
-  } else {
-    // we have the laser pose, retrieve laser index
-    laser_index = frame_to_laser_[laser_scan->header.frame_id];
+    laser_scans.push_back(scan);
+    laser_indices.push_back(laser_index);
   }
+  if (laser_scans.empty()) {
+    return;
+  }
+
+  // The robot pose and the published outputs are those of the first scan, the others
+  // were taken within the batch window of it
+  const sensor_msgs::msg::LaserScan::ConstSharedPtr & laser_scan = laser_scans.front();
 
   // Where was the robot when this scan was taken?
   pf_vector_t pose;
@@ -670,6 +846,7 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
 
   pf_vector_t delta = pf_vector_zero();
   bool force_publication = false;
+  bool update = false;
   if (!pf_init_) {
     // Pose at last filter update
     pf_odom_pose_ = pose;
@@ -681,6 +858,7 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
 
     force_publication = true;
     resample_count_ = 0;
+    update = true;
   } else {
     // Set the laser update flags
     if (shouldUpdateFilter(pose, delta)) {
@@ -688,7 +866,10 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
         lasers_update_[i] = true;
       }
     }
-    if (lasers_update_[laser_index]) {
+    update = std::any_of(
+      laser_indices.begin(), laser_indices.end(),
+      [this](int laser_index) {return lasers_update_[laser_index];});
+    if (update) {
       motion_model_->odometryUpdate(pf_, pose, delta);
     }
     force_update_ = false;
@@ -696,9 +877,13 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
 
   bool resampled = false;
 
-  // If the robot has moved, update the filter
-  if (lasers_update_[laser_index]) {
-    updateFilter(laser_index, laser_scan, pose);
+  // If the robot has moved, update the filter with every scan of the batch
+  if (update) {
+    for (size_t i = 0; i < laser_scans.size(); i++) {
+      if (lasers_update_[laser_indices[i]]) {
+        updateFilter(laser_indices[i], laser_scans[i], pose);
+      }
+    }
 
     // Resample the particles
     if (!(++resample_count_ % resample_interval_)) {
@@ -710,7 +895,7 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
     RCLCPP_DEBUG(get_logger(), "Num samples: %d\n", set->sample_count);
 
     if (!force_update_) {
-      publishParticleCloud(set);
+      storeParticleCloud(set);
     }
   }
   if (resampled || force_publication || !first_pose_sent_) {
@@ -797,9 +982,13 @@ bool AmclNode::updateFilter(
   const sensor_msgs::msg::LaserScan::ConstSharedPtr & laser_scan,
   const pf_vector_t & pose)
 {
+  // Only the beams the model uses are converted, so it goes through all of them
+  const int range_count = laser_scan->ranges.size();
+  const int step = lasers_[laser_index]->getBeamStep(range_count);
+
   nav2_amcl::LaserData ldata;
   ldata.laser = lasers_[laser_index];
-  ldata.range_count = laser_scan->ranges.size();
+  ldata.range_count = (range_count + step - 1) / step;
   // To account for lasers that are mounted upside-down, we determine the
   // min, max, and increment angles of the laser in the base frame.
   //
@@ -847,16 +1036,17 @@ bool AmclNode::updateFilter(
   // The LaserData destructor will free this memory
   ldata.ranges = new double[ldata.range_count][2];
   for (int i = 0; i < ldata.range_count; i++) {
+    const int beam = i * step;
     // amcl doesn't (yet) have a concept of min range.  So we'll map short
     // readings to max range.
-    if (laser_scan->ranges[i] <= range_min) {
+    if (laser_scan->ranges[beam] <= range_min) {
       ldata.ranges[i][0] = ldata.range_max;
     } else {
-      ldata.ranges[i][0] = laser_scan->ranges[i];
+      ldata.ranges[i][0] = laser_scan->ranges[beam];
     }
     // Compute bearing
     ldata.ranges[i][1] = angle_min +
-      (i * angle_increment);
+      (beam * angle_increment);
   }
   lasers_[laser_index]->sensorUpdate(pf_, reinterpret_cast<nav2_amcl::LaserData *>(&ldata));
   lasers_update_[laser_index] = false;
@@ -865,29 +1055,84 @@ bool AmclNode::updateFilter(
 }
 
 void
-AmclNode::publishParticleCloud(const pf_sample_set_t * set)
+AmclNode::storeParticleCloud(const pf_sample_set_t * set)
 {
   // If initial pose is not known, AMCL does not know the current pose
   if (!initial_pose_is_known_) {return;}
-  auto cloud_with_weights_msg = std::make_unique<nav2_msgs::msg::ParticleCloud>();
-  cloud_with_weights_msg->header.stamp = this->now();
-  cloud_with_weights_msg->header.frame_id = global_frame_id_;
-  cloud_with_weights_msg->particles.resize(set->sample_count);
+  if (particlecloud_pub_->get_subscription_count() == 0 &&
+    particle_cloud_pub_->get_subscription_count() == 0)
+  {
+    return;
+  }
+
+  // Only the samples are copied here, the messages are made when publishing
+  {
+    std::lock_guard<std::mutex> lock(particle_cloud_mutex_);
+    particle_cloud_samples_.assign(set->samples, set->samples + set->sample_count);
+    particle_cloud_updated_ = true;
+  }
+
+  if (particle_cloud_publish_rate_ <= 0.0) {
+    publishParticleCloud();
+  }
+}
+
+void
+AmclNode::publishParticleCloud()
+{
+  std::vector<pf_sample_t> samples;
+  {
+    std::lock_guard<std::mutex> lock(particle_cloud_mutex_);
+    if (!particle_cloud_updated_) {
+      return;
+    }
+    samples.swap(particle_cloud_samples_);
+    particle_cloud_updated_ = false;
+  }
+
+  // Keep the particles with the highest weights
+  if (max_published_particles_ > 0 &&
+    samples.size() > static_cast<size_t>(max_published_particles_))
+  {
+    std::nth_element(
+      samples.begin(), samples.begin() + max_published_particles_, samples.end(),
+      [](const pf_sample_t & a, const pf_sample_t & b) {return a.weight > b.weight;});
+    samples.resize(max_published_particles_);
+  }
+
+  const bool publish_cloud = particlecloud_pub_->get_subscription_count() > 0;
+  const bool publish_cloud_with_weights = particle_cloud_pub_->get_subscription_count() > 0;
 
   auto cloud_msg = std::make_unique<geometry_msgs::msg::PoseArray>();
   cloud_msg->header.stamp = this->now();
   cloud_msg->header.frame_id = global_frame_id_;
-  cloud_msg->poses.resize(set->sample_count);
-  for (int i = 0; i < set->sample_count; i++) {
-    cloud_msg->poses[i].position.x = set->samples[i].pose.v[0];
-    cloud_msg->poses[i].position.y = set->samples[i].pose.v[1];
+  cloud_msg->poses.resize(samples.size());
+  for (size_t i = 0; i < samples.size(); i++) {
+    cloud_msg->poses[i].position.x = samples[i].pose.v[0];
+    cloud_msg->poses[i].position.y = samples[i].pose.v[1];
     cloud_msg->poses[i].position.z = 0;
-    cloud_msg->poses[i].orientation = orientationAroundZAxis(set->samples[i].pose.v[2]);
-    cloud_with_weights_msg->particles[i].pose = (*cloud_msg).poses[i];
-    cloud_with_weights_msg->particles[i].weight = set->samples[i].weight;
+    cloud_msg->poses[i].orientation = orientationAroundZAxis(samples[i].pose.v[2]);
+  }
+
+  if (publish_cloud_with_weights) {
+    auto cloud_with_weights_msg = std::make_unique<nav2_msgs::msg::ParticleCloud>();
+    cloud_with_weights_msg->header = cloud_msg->header;
+    cloud_with_weights_msg->particles.resize(samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+      cloud_with_weights_msg->particles[i].pose = cloud_msg->poses[i];
+      cloud_with_weights_msg->particles[i].weight = samples[i].weight;
+    }
+    particle_cloud_pub_->publish(std::move(cloud_with_weights_msg));
+  }
+  if (publish_cloud) {
+    particlecloud_pub_->publish(std::move(cloud_msg));
+  }
+
+  // Give the memory back for the next samples, if they were not stored meanwhile
+  std::lock_guard<std::mutex> lock(particle_cloud_mutex_);
+  if (!particle_cloud_updated_) {
+    particle_cloud_samples_.swap(samples);
   }
-  particlecloud_pub_->publish(std::move(cloud_msg));
-  particle_cloud_pub_->publish(std::move(cloud_with_weights_msg));
 }
 
 bool
@@ -1085,8 +1330,10 @@ AmclNode::initParameters()
   get_parameter("initial_pose.yaw", initial_pose_yaw_);
   get_parameter("max_beams", max_beams_);
   get_parameter("max_particles", max_particles_);
+  get_parameter("max_published_particles", max_published_particles_);
   get_parameter("min_particles", min_particles_);
   get_parameter("odom_frame_id", odom_frame_id_);
+  get_parameter("particle_cloud_publish_rate", particle_cloud_publish_rate_);
   get_parameter("pf_err", pf_err_);
   get_parameter("pf_z", pf_z_);
   get_parameter("recovery_alpha_fast", alpha_fast_);
@@ -1094,6 +1341,8 @@ AmclNode::initParameters()
   get_parameter("resample_interval", resample_interval_);
   get_parameter("robot_model_type", robot_model_type_);
   get_parameter("save_pose_rate", save_pose_rate);
+  get_parameter("scan_batch_window", scan_batch_window_);
+  get_parameter("scan_queue_size", scan_queue_size_);
   get_parameter("sigma_hit", sigma_hit_);
   get_parameter("tf_broadcast", tf_broadcast_);
   get_parameter("transform_tolerance", tmp_tol);
@@ -1159,6 +1408,8 @@ AmclNode::handleMapMessage(const nav_msgs::msg::OccupancyGrid & msg)
       msg.header.frame_id.c_str(),
       global_frame_id_.c_str());
   }
+  // The filter thread may be using the map
+  std::lock_guard<std::mutex> lock(pf_mutex_);
   freeMapDependentMemory();
   map_ = convertMap(msg);
 
@@ -59,6 +59,8 @@ BeamModel::sensorFunction(LaserData * data, pf_sample_set_t * set)
 
   total_weight = 0.0;
 
+  step = self->getBeamStep(data->range_count);
+
   // Compute the sample weights
   for (j = 0; j < set->sample_count; j++) {
     sample = set->samples + j;
@@ -69,7 +71,6 @@ BeamModel::sensorFunction(LaserData * data, pf_sample_set_t * set)
 
     p = 1.0;
 
-    step = (data->range_count - 1) / (self->max_beams_ - 1);
     for (i = 0; i < data->range_count; i += step) {
       obs_range = data->ranges[i][0];
       obs_bearing = data->ranges[i][1];
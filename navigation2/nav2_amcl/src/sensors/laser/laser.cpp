@@ -70,4 +70,19 @@ Laser::SetLaserPose(pf_vector_t & laser_pose)
   laser_pose_ = laser_pose;
 }
 
+int
+Laser::getBeamStep(int range_count) const
+{
+  if (max_beams_ < 2) {
+    return 1;
+  }
+  int step = (range_count - 1) / (max_beams_ - 1);
+
+  // Step size must be at least 1
+  if (step < 1) {
+    step = 1;
+  }
+  return step;
+}
+
 }  // namespace nav2_amcl
@@ -55,6 +55,8 @@ LikelihoodFieldModel::sensorFunction(LaserData * data, pf_sample_set_t * set)
 
   total_weight = 0.0;
 
+  step = self->getBeamStep(data->range_count);
+
   // Compute the sample weights
   for (j = 0; j < set->sample_count; j++) {
     sample = set->samples + j;
@@ -69,13 +71,6 @@ LikelihoodFieldModel::sensorFunction(LaserData * data, pf_sample_set_t * set)
     double z_hit_denom = 2 * self->sigma_hit_ * self->sigma_hit_;
     double z_rand_mult = 1.0 / data->range_max;
 
-    step = (data->range_count - 1) / (self->max_beams_ - 1);
-
-    // Step size must be at least 1
-    if (step < 1) {
-      step = 1;
-    }
-
     for (i = 0; i < data->range_count; i += step) {
       obs_range = data->ranges[i][0];
       obs_bearing = data->ranges[i][1];
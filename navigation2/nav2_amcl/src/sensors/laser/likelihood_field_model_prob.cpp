@@ -65,12 +65,7 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
 
   total_weight = 0.0;
 
-  step = ceil((data->range_count) / static_cast<double>(self->max_beams_));
-
-  // Step size must be at least 1
-  if (step < 1) {
-    step = 1;
-  }
+  step = self->getBeamStep(data->range_count);
 
   // Pre-compute a couple of things
   double z_hit_denom = 2 * self->sigma_hit_ * self->sigma_hit_;
@@ -240,6 +235,18 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
   return total_weight;
 }
 
+int
+LikelihoodFieldModelProb::getBeamStep(int range_count) const
+{
+  int step = ceil(range_count / static_cast<double>(max_beams_));
+
+  // Step size must be at least 1
+  if (step < 1) {
+    step = 1;
+  }
+  return step;
+}
+
 bool
 LikelihoodFieldModelProb::sensorUpdate(pf_t * pf, LaserData * data)
 {
@@ -0,0 +1,92 @@
+// Copyright (c) 2020 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "nav2_amcl/map/map.hpp"
+#include "nav2_amcl/sensors/laser/laser.hpp"
+
+// A small free map, for the likelihood field models to compute their distances on
+map_t * makeMap()
+{
+  map_t * map = map_alloc();
+  map->size_x = 10;
+  map->size_y = 10;
+  map->scale = 0.1;
+  map->cells = static_cast<map_cell_t *>(calloc(map->size_x * map->size_y, sizeof(map_cell_t)));
+  for (int i = 0; i != map->size_x * map->size_y; i++) {
+    map->cells[i].occ_state = -1;
+  }
+  return map;
+}
+
+// The scan reduced to the beams the model uses must give a step of 1, so that the
+// model goes through all of its beams
+void expectReducedScanStep(const nav2_amcl::Laser & laser)
+{
+  for (int range_count = 1; range_count != 2000; range_count++) {
+    const int step = laser.getBeamStep(range_count);
+    ASSERT_GE(step, 1) << range_count << " beams";
+    const int reduced_count = (range_count + step - 1) / step;
+    ASSERT_EQ(laser.getBeamStep(reduced_count), 1) << range_count << " beams";
+  }
+}
+
+TEST(LaserBeamStep, BeamModel)
+{
+  map_t * map = makeMap();
+  nav2_amcl::BeamModel laser(0.5, 0.05, 0.05, 0.5, 0.2, 0.1, 0.05, 60, map);
+  // (range_count - 1) / (max_beams - 1), at least 1
+  EXPECT_EQ(laser.getBeamStep(360), 6);
+  EXPECT_EQ(laser.getBeamStep(121), 2);
+  EXPECT_EQ(laser.getBeamStep(120), 2);
+  EXPECT_EQ(laser.getBeamStep(60), 1);
+  EXPECT_EQ(laser.getBeamStep(10), 1);
+  expectReducedScanStep(laser);
+
+  // too few beams to take a step between them
+  nav2_amcl::BeamModel single_beam(0.5, 0.05, 0.05, 0.5, 0.2, 0.1, 0.05, 1, map);
+  EXPECT_EQ(single_beam.getBeamStep(360), 1);
+  map_free(map);
+}
+
+TEST(LaserBeamStep, LikelihoodFieldModel)
+{
+  map_t * map = makeMap();
+  for (size_t max_beams : {2, 30, 60, 100}) {
+    nav2_amcl::LikelihoodFieldModel laser(0.5, 0.5, 0.2, 2.0, max_beams, map);
+    // (range_count - 1) / (max_beams - 1), at least 1
+    const int beams = static_cast<int>(max_beams);
+    EXPECT_EQ(laser.getBeamStep(360), std::max(1, 359 / (beams - 1)));
+    expectReducedScanStep(laser);
+  }
+  map_free(map);
+}
+
+TEST(LaserBeamStep, LikelihoodFieldModelProb)
+{
+  map_t * map = makeMap();
+  for (size_t max_beams : {2, 30, 60, 100}) {
+    nav2_amcl::LikelihoodFieldModelProb laser(
+      0.5, 0.5, 0.2, 2.0, false, 0.5, 0.3, 0.9, max_beams, map);
+    // range_count / max_beams, rounded up
+    const int beams = static_cast<int>(max_beams);
+    EXPECT_EQ(laser.getBeamStep(360), (360 + beams - 1) / beams);
+    EXPECT_EQ(laser.getBeamStep(361), (361 + beams - 1) / beams);
+    expectReducedScanStep(laser);
+  }
+  map_free(map);
+}
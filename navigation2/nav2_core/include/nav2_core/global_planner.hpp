@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
 #include "tf2_ros/buffer.h"
@@ -76,6 +77,37 @@ public:
   virtual nav_msgs::msg::Path createPlan(
     const geometry_msgs::msg::PoseStamped & start,
     const geometry_msgs::msg::PoseStamped & goal) = 0;
+
+  /**
+   * @brief Method create the plans from a starting pose to many goals. Planners which
+   * can share their search between the goals, like a Dijkstra expansion from the
+   * start, should override it, else it plans to each goal in turn.
+   * @param start The starting pose of the robot
+   * @param goals The goal poses of the robot
+   * @return      The sequence of poses to get from start to each goal, empty if none
+   */
+  virtual std::vector<nav_msgs::msg::Path> createPlans(
+    const geometry_msgs::msg::PoseStamped & start,
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals)
+  {
+    std::vector<nav_msgs::msg::Path> paths;
+    paths.reserve(goals.size());
+    for (const auto & goal : goals) {
+      paths.push_back(createPlan(start, goal));
+    }
+    return paths;
+  }
+
+  /**
+   * @brief Whether instances of the planner can plan concurrently, with each other and
+   * with other planners. Planners sharing state between their instances, such as static
+   * lookup tables, or writing to the costmap must not override it.
+   * @return true if the planner is reentrant
+   */
+  virtual bool isReentrant() const
+  {
+    return false;
+  }
 };
 
 }  // namespace nav2_core
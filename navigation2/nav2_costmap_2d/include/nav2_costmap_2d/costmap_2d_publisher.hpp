@@ -107,6 +107,12 @@ public:
    */
   void publishCostmap();
 
+  /**
+   * @brief Check if any of the costmap topics is subscribed to
+   * @return True if the costmap, its updates or the raw costmap have a subscriber
+   */
+  bool hasSubscribers();
+
   /**
    * @brief Check if the publisher is active
    * @return True if the frequency for the publisher is non-zero, false otherwise
@@ -38,7 +38,10 @@
 #ifndef NAV2_COSTMAP_2D__COSTMAP_2D_ROS_HPP_
 #define NAV2_COSTMAP_2D__COSTMAP_2D_ROS_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -66,6 +69,16 @@
 namespace nav2_costmap_2d
 {
 
+/**
+ * @brief An immutable copy of the master costmap, as of the end of a map update
+ */
+struct CostmapSnapshot
+{
+  Costmap2D costmap;
+  uint64_t version{0};  ///< Incremented by each map update, 0 before the first one
+  rclcpp::Time stamp{0, 0, RCL_ROS_TIME};  ///< Time of the map update
+};
+
 /** @brief A ROS wrapper for a 2D Costmap. Handles subscribing to
  * topics that provide observations about obstacles in either the form
  * of PointCloud or LaserScan messages. */
@@ -185,6 +198,22 @@ public:
     return layered_costmap_;
   }
 
+  /**
+   * @brief Return the last snapshot of the master costmap, published by the update
+   * thread at the end of each map update.
+   *
+   * A snapshot is never written once published, so it can be read without locking
+   * for as long as it is held, without blocking the map updates. Snapshots are only
+   * published once one was requested, the first request copies the master costmap.
+   */
+  std::shared_ptr<const CostmapSnapshot> getCostmapSnapshot();
+
+  /**
+   * @brief Publish a new snapshot of the master costmap now, with a new version. Only
+   * needed when the master costmap was written outside of the map updates.
+   */
+  void publishCostmapSnapshot();
+
   /** @brief Returns the current padded footprint as a geometry_msgs::msg::Polygon. */
   geometry_msgs::msg::Polygon getRobotFootprintPolygon()
   {
@@ -285,6 +314,19 @@ protected:
   rclcpp::Duration publish_cycle_{1, 0};
   pluginlib::ClassLoader<Layer> plugin_loader_{"nav2_costmap_2d", "nav2_costmap_2d::Layer"};
 
+  /**
+   * @brief Copy the master costmap into a new snapshot and publish it
+   * @param version Version of the snapshot
+   */
+  void publishSnapshot(uint64_t version);
+
+  // Costmap snapshots, double buffered: the spare one is reused by the next update
+  // unless a reader still holds it
+  std::shared_ptr<CostmapSnapshot> snapshot_;
+  std::shared_ptr<CostmapSnapshot> spare_snapshot_;
+  std::mutex snapshot_mutex_;
+  std::atomic<uint64_t> snapshot_version_{0};
+
   // Parameters
   void getParameters();
   bool always_send_full_costmap_{false};
@@ -116,6 +116,18 @@ public:
     return cost;
   }
 
+  /** @brief  Get the rate at which the cost falls off with the distance from an obstacle */
+  double getCostScalingFactor() const
+  {
+    return cost_scaling_factor_;
+  }
+
+  /** @brief  Get the distance from an obstacle up to which costs are inflated */
+  double getInflationRadius() const
+  {
+    return inflation_radius_;
+  }
+
   // Provide a typedef to ease future code maintenance
   typedef std::recursive_mutex mutex_t;
   mutex_t * getMutex()
@@ -119,6 +119,12 @@ public:
     return current_;
   }
 
+  /** @brief Whether the layer is enabled, so that it updates the costmap */
+  bool isEnabled() const
+  {
+    return enabled_;
+  }
+
   /** @brief Convenience function for layered_costmap_->getFootprint(). */
   const std::vector<geometry_msgs::msg::Point> & getFootprint() const;
 
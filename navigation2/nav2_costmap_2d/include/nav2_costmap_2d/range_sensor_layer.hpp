@@ -93,9 +93,7 @@ private:
   inline double sensor_model(double r, double phi, double theta);
 
   inline void get_deltas(double angle, double * dx, double * dy);
-  inline void update_cell(
-    double ox, double oy, double ot,
-    double r, double nx, double ny, bool clear);
+  inline unsigned char update_cell(double sensor, unsigned char cost);
 
   inline double to_prob(unsigned char c)
   {
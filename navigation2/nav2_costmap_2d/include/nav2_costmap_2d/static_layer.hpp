@@ -38,6 +38,7 @@
 #ifndef NAV2_COSTMAP_2D__STATIC_LAYER_HPP_
 #define NAV2_COSTMAP_2D__STATIC_LAYER_HPP_
 
+#include <array>
 #include <mutex>
 #include <string>
 
@@ -76,6 +77,15 @@ private:
   void getParameters();
   void processMap(const nav_msgs::msg::OccupancyGrid & new_map);
 
+  /**
+   * @brief  Add an area of the layer to the bounds reported by the next updateBounds
+   * @param x The x coordinate of the area, in cells
+   * @param y The y coordinate of the area, in cells
+   * @param width The width of the area, in cells
+   * @param height The height of the area, in cells
+   */
+  void addUpdatedBounds(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
   /**
    * @brief  Callback to update the costmap's map from the map_server
    * @param new_map The map to put into the costmap. The origin of the new
@@ -109,6 +119,7 @@ private:
   unsigned char lethal_threshold_;
   unsigned char unknown_cost_value_;
   bool trinary_costmap_;
+  std::array<unsigned char, 256> cost_lut_;
   bool map_received_{false};
   tf2::Duration transform_tolerance_;
   std::atomic<bool> update_in_progress_;
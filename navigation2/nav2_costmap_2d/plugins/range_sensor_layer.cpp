@@ -33,7 +33,6 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <angles/angles.h>
 #include <algorithm>
 #include <list>
 #include <limits>
@@ -215,9 +214,9 @@ void RangeSensorLayer::updateCostmap()
 {
   std::list<sensor_msgs::msg::Range> range_msgs_buffer_copy;
 
+  // Take all the readings of this cycle at once, without copying them
   range_message_mutex_.lock();
-  range_msgs_buffer_copy = std::list<sensor_msgs::msg::Range>(range_msgs_buffer_);
-  range_msgs_buffer_.clear();
+  range_msgs_buffer_copy.swap(range_msgs_buffer_);
   range_message_mutex_.unlock();
 
   for (auto & range_msgs_it : range_msgs_buffer_copy) {
@@ -286,6 +285,7 @@ void RangeSensorLayer::updateCostmap(
   in.header.stamp = range_message.header.stamp;
   in.header.frame_id = range_message.header.frame_id;
 
+  // This runs under the costmap lock, so never wait for the transform
   if (!tf_->canTransform(
       in.header.frame_id, global_frame_, tf2_ros::fromMsg(in.header.stamp)))
   {
@@ -295,13 +295,25 @@ void RangeSensorLayer::updateCostmap(
     return;
   }
 
-  tf_->transform(in, out, global_frame_, transform_tolerance_);
+  // Both points of the reading are transformed with a single lookup
+  geometry_msgs::msg::TransformStamped transform;
+  try {
+    transform = tf_->lookupTransform(
+      global_frame_, in.header.frame_id, tf2_ros::fromMsg(in.header.stamp));
+  } catch (tf2::TransformException & ex) {
+    RCLCPP_INFO(
+      node_->get_logger(), "Range sensor layer can't transform from %s to %s",
+      global_frame_.c_str(), in.header.frame_id.c_str());
+    return;
+  }
+
+  tf2::doTransform(in, out, transform);
 
   double ox = out.point.x, oy = out.point.y;
 
   in.point.x = range_message.range;
 
-  tf_->transform(in, out, global_frame_, transform_tolerance_);
+  tf2::doTransform(in, out, transform);
 
   double tx = out.point.x, ty = out.point.y;
 
@@ -354,13 +366,22 @@ void RangeSensorLayer::updateCostmap(
   // Limit Bounds to Grid
   bx0 = std::max(0, bx0);
   by0 = std::max(0, by0);
-  bx1 = std::min(static_cast<int>(size_x_), bx1);
-  by1 = std::min(static_cast<int>(size_y_), by1);
-
-  for (unsigned int x = bx0; x <= (unsigned int)bx1; x++) {
-    for (unsigned int y = by0; y <= (unsigned int)by1; y++) {
-      bool update_xy_cell = true;
-
+  bx1 = std::min(static_cast<int>(size_x_) - 1, bx1);
+  by1 = std::min(static_cast<int>(size_y_) - 1, by1);
+
+  // The sensor model is exactly 0.5 past the reading and outside of the cone,
+  // which leaves the probability of a cell as it is, so only the cells in the
+  // cone and in front of the reading are evaluated when not clearing
+  const double r = range_message.range;
+  const double max_phi = r + resolution_ * r;
+  const double sq_max_phi = max_phi * max_phi;
+  const double cos_theta = cos(theta), sin_theta = sin(theta);
+  const bool narrow_cone = max_angle_ < M_PI_2;
+  const double tan_max_angle = narrow_cone ? tan(max_angle_) : 0.0;
+  const float bcciath = -static_cast<float>(inflate_cone_) * area(Ax, Ay, Bx, By, Ox, Oy);
+
+  for (int y = by0; y <= by1; y++) {
+    for (int x = bx0; x <= bx1; x++) {
       // Unless inflate_cone_ is set to 100 %, we update cells only within the
       // (partially inflated) sensor cone, projected on the costmap as a triangle.
       // 0 % corresponds to just the triangle, but if your sensor fov is very
@@ -374,15 +395,37 @@ void RangeSensorLayer::updateCostmap(
 
         // Barycentric coordinates inside area threshold; this is not mathematically
         // sound at all, but it works!
-        float bcciath = -static_cast<float>(inflate_cone_) * area(Ax, Ay, Bx, By, Ox, Oy);
-        update_xy_cell = w0 >= bcciath && w1 >= bcciath && w2 >= bcciath;
+        if (w0 < bcciath || w1 < bcciath || w2 < bcciath) {
+          continue;
+        }
       }
 
-      if (update_xy_cell) {
-        double wx, wy;
-        mapToWorld(x, y, wx, wy);
-        update_cell(ox, oy, theta, range_message.range, wx, wy, clear_sensor_cone);
+      unsigned char & cost = costmap_[getIndex(x, y)];
+      if (clear_sensor_cone) {
+        cost = update_cell(0.0, cost);
+        continue;
       }
+
+      double wx, wy;
+      mapToWorld(x, y, wx, wy);
+      const double cell_dx = wx - ox, cell_dy = wy - oy;
+      const double sq_phi = cell_dx * cell_dx + cell_dy * cell_dy;
+      if (sq_phi >= sq_max_phi) {
+        continue;
+      }
+
+      // Cell in the frame of the sensor
+      const double u = cos_theta * cell_dx + sin_theta * cell_dy;
+      const double v = cos_theta * cell_dy - sin_theta * cell_dx;
+      if (narrow_cone && (u <= 0.0 || fabs(v) > u * tan_max_angle)) {
+        continue;
+      }
+      const double cell_theta = atan2(v, u);
+      if (fabs(cell_theta) > max_angle_) {
+        continue;
+      }
+
+      cost = update_cell(sensor_model(r, sqrt(sq_phi), cell_theta), cost);
     }
   }
 
@@ -390,30 +433,13 @@ void RangeSensorLayer::updateCostmap(
   last_reading_time_ = node_->now();
 }
 
-void RangeSensorLayer::update_cell(
-  double ox, double oy, double ot, double r,
-  double nx, double ny, bool clear)
+unsigned char RangeSensorLayer::update_cell(double sensor, unsigned char cost)
 {
-  unsigned int x, y;
-  if (worldToMap(nx, ny, x, y)) {
-    double dx = nx - ox, dy = ny - oy;
-    double theta = atan2(dy, dx) - ot;
-    theta = angles::normalize_angle(theta);
-    double phi = sqrt(dx * dx + dy * dy);
-    double sensor = 0.0;
-    if (!clear) {
-      sensor = sensor_model(r, phi, theta);
-    }
-    double prior = to_prob(getCost(x, y));
-    double prob_occ = sensor * prior;
-    double prob_not = (1 - sensor) * (1 - prior);
-    double new_prob = prob_occ / (prob_occ + prob_not);
-
-    RCLCPP_DEBUG(node_->get_logger(), "%f %f | %f %f = %f", dx, dy, theta, phi, sensor);
-    RCLCPP_DEBUG(node_->get_logger(), "%f | %f %f | %f", prior, prob_occ, prob_not, new_prob);
-    unsigned char c = to_cost(new_prob);
-    setCost(x, y, c);
-  }
+  double prior = to_prob(cost);
+  double prob_occ = sensor * prior;
+  double prob_not = (1 - sensor) * (1 - prior);
+  double new_prob = prob_occ / (prob_occ + prob_not);
+  return to_cost(new_prob);
 }
 
 void RangeSensorLayer::resetRange()
@@ -40,8 +40,10 @@
 #include "nav2_costmap_2d/static_layer.hpp"
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "nav2_costmap_2d/costmap_math.hpp"
 #include "pluginlib/class_list_macros.hpp"
@@ -111,6 +113,9 @@ StaticLayer::deactivate()
 void
 StaticLayer::reset()
 {
+  x_ = y_ = 0;
+  width_ = size_x_;
+  height_ = size_y_;
   has_updated_data_ = true;
 }
 
@@ -152,6 +157,11 @@ StaticLayer::getParameters()
   update_in_progress_.store(false);
 
   transform_tolerance_ = tf2::durationFromSec(temp_tf_tol);
+
+  // Map values are interpreted through a table, as there are only 256 of them
+  for (unsigned int value = 0; value < cost_lut_.size(); ++value) {
+    cost_lut_[value] = interpretValue(static_cast<unsigned char>(value));
+  }
 }
 
 void
@@ -168,6 +178,7 @@ StaticLayer::processMap(const nav_msgs::msg::OccupancyGrid & new_map)
     new_map.info.resolution);
 
   // resize costmap if size, resolution or origin do not match
+  bool resized = false;
   Costmap2D * master = layered_costmap_->getCostmap();
   if (!layered_costmap_->isRolling() && (master->getSizeInCellsX() != size_x ||
     master->getSizeInCellsY() != size_y ||
@@ -186,6 +197,7 @@ StaticLayer::processMap(const nav_msgs::msg::OccupancyGrid & new_map)
       new_map.info.origin.position.x,
       new_map.info.origin.position.y,
       true);
+    resized = true;
   } else if (size_x_ != size_x || size_y_ != size_y ||  // NOLINT
     resolution_ != new_map.info.resolution ||
     origin_x_ != new_map.info.origin.position.x ||
@@ -199,32 +211,77 @@ StaticLayer::processMap(const nav_msgs::msg::OccupancyGrid & new_map)
     resizeMap(
       size_x, size_y, new_map.info.resolution,
       new_map.info.origin.position.x, new_map.info.origin.position.y);
+    resized = true;
   }
 
-  unsigned int index = 0;
-
-  // we have a new map, update full size of map
   std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
 
-  // initialize the costmap with static data
-  for (unsigned int i = 0; i < size_y; ++i) {
-    for (unsigned int j = 0; j < size_x; ++j) {
-      unsigned char value = new_map.data[index];
-      costmap_[index] = interpretValue(value);
-      ++index;
+  // Convert the map row by row, keeping track of the cells which changed
+  unsigned int min_x = size_x, min_y = size_y, max_x = 0, max_y = 0;
+  std::vector<unsigned char> row(size_x);
+  for (unsigned int y = 0; y < size_y; ++y) {
+    const unsigned int index = y * size_x;
+    for (unsigned int x = 0; x < size_x; ++x) {
+      row[x] = cost_lut_[static_cast<unsigned char>(new_map.data[index + x])];
+    }
+
+    unsigned char * costmap_row = costmap_ + index;
+    if (std::memcmp(costmap_row, row.data(), size_x) == 0) {
+      continue;
+    }
+
+    unsigned int first = 0, last = size_x;
+    while (costmap_row[first] == row[first]) {
+      ++first;
+    }
+    while (costmap_row[last - 1] == row[last - 1]) {
+      --last;
     }
+    std::memcpy(costmap_row + first, row.data() + first, last - first);
+
+    min_x = std::min(min_x, first);
+    max_x = std::max(max_x, last);
+    min_y = std::min(min_y, y);
+    max_y = y + 1;
   }
 
-  map_frame_ = new_map.header.frame_id;
+  if (resized || layered_costmap_->isRolling() || map_frame_ != new_map.header.frame_id) {
+    // the whole map has to be updated, as for the first map
+    x_ = y_ = 0;
+    width_ = size_x_;
+    height_ = size_y_;
+    has_updated_data_ = true;
+  } else if (min_x < max_x) {
+    // only the part of the map which changed has to be updated
+    addUpdatedBounds(min_x, min_y, max_x - min_x, max_y - min_y);
+  }
 
-  x_ = y_ = 0;
-  width_ = size_x_;
-  height_ = size_y_;
-  has_updated_data_ = true;
+  map_frame_ = new_map.header.frame_id;
 
   current_ = true;
 }
 
+void
+StaticLayer::addUpdatedBounds(
+  unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+  // Grow the bounds not yet taken by updateBounds, if any
+  if (has_updated_data_) {
+    const unsigned int max_x = std::max(x_ + width_, x + width);
+    const unsigned int max_y = std::max(y_ + height_, y + height);
+    x_ = std::min(x_, x);
+    y_ = std::min(y_, y);
+    width_ = max_x - x_;
+    height_ = max_y - y_;
+  } else {
+    x_ = x;
+    y_ = y;
+    width_ = width;
+    height_ = height;
+  }
+  has_updated_data_ = true;
+}
+
 void
 StaticLayer::matchSize()
 {
@@ -304,15 +361,11 @@ StaticLayer::incomingUpdate(map_msgs::msg::OccupancyGridUpdate::ConstSharedPtr u
     unsigned int index_base = (update->y + y) * size_x_;
     for (unsigned int x = 0; x < update->width; x++) {
       unsigned int index = index_base + x + update->x;
-      costmap_[index] = interpretValue(update->data[di++]);
+      costmap_[index] = cost_lut_[static_cast<unsigned char>(update->data[di++])];
     }
   }
 
-  x_ = update->x;
-  y_ = update->y;
-  width_ = update->width;
-  height_ = update->height;
-  has_updated_data_ = true;
+  addUpdatedBounds(update->x, update->y, update->width, update->height);
 }
 
 
@@ -158,18 +158,21 @@ Costmap2D & Costmap2D::operator=(const Costmap2D & map)
     return *this;
   }
 
-  // clean up old data
-  deleteMaps();
+  // reuse our maps if they are of the same size, else clean up old data
+  if (costmap_ == NULL || size_x_ != map.size_x_ || size_y_ != map.size_y_) {
+    deleteMaps();
+
+    size_x_ = map.size_x_;
+    size_y_ = map.size_y_;
+
+    // initialize our various maps
+    initMaps(size_x_, size_y_);
+  }
 
-  size_x_ = map.size_x_;
-  size_y_ = map.size_y_;
   resolution_ = map.resolution_;
   origin_x_ = map.origin_x_;
   origin_y_ = map.origin_y_;
 
-  // initialize our various maps
-  initMaps(size_x_, size_y_);
-
   // copy the cost map
   memcpy(costmap_, map.costmap_, size_x_ * size_y_ * sizeof(unsigned char));
 
@@ -173,6 +173,13 @@ void Costmap2DPublisher::prepareCostmap()
   }
 }
 
+bool Costmap2DPublisher::hasSubscribers()
+{
+  return node_->count_subscribers(costmap_pub_->get_topic_name()) > 0 ||
+         node_->count_subscribers(costmap_update_pub_->get_topic_name()) > 0 ||
+         node_->count_subscribers(costmap_raw_pub_->get_topic_name()) > 0;
+}
+
 void Costmap2DPublisher::publishCostmap()
 {
   if (node_->count_subscribers(costmap_raw_pub_->get_topic_name()) > 0) {
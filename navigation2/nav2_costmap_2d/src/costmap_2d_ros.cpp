@@ -272,6 +272,10 @@ Costmap2DROS::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
 
   clear_costmap_service_.reset();
 
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  snapshot_.reset();
+  spare_snapshot_.reset();
+
   return nav2_util::CallbackReturn::SUCCESS;
 }
 
@@ -443,6 +447,17 @@ Costmap2DROS::updateMap()
       const double yaw = tf2::getYaw(pose.pose.orientation);
       layered_costmap_->updateMap(x, y, yaw);
 
+      // only publish snapshots once someone reads them
+      snapshot_version_++;
+      bool snapshots_requested;
+      {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshots_requested = snapshot_ != nullptr;
+      }
+      if (snapshots_requested) {
+        publishSnapshot(snapshot_version_);
+      }
+
       auto footprint = std::make_unique<geometry_msgs::msg::PolygonStamped>();
       footprint->header.frame_id = global_frame_;
       footprint->header.stamp = now();
@@ -455,6 +470,59 @@ Costmap2DROS::updateMap()
   }
 }
 
+std::shared_ptr<const CostmapSnapshot>
+Costmap2DROS::getCostmapSnapshot()
+{
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    if (snapshot_) {
+      return snapshot_;
+    }
+  }
+
+  publishSnapshot(snapshot_version_);
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  return snapshot_;
+}
+
+void
+Costmap2DROS::publishCostmapSnapshot()
+{
+  publishSnapshot(++snapshot_version_);
+}
+
+void
+Costmap2DROS::publishSnapshot(uint64_t version)
+{
+  // The spare snapshot cannot be handed out anymore, so if no reader holds it now it is
+  // ours to write. Otherwise a new one is copied into, leaving readers theirs
+  std::shared_ptr<CostmapSnapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    snapshot = std::move(spare_snapshot_);
+  }
+  if (!snapshot || snapshot.use_count() > 1) {
+    snapshot = std::make_shared<CostmapSnapshot>();
+  }
+
+  Costmap2D * master = layered_costmap_->getCostmap();
+  {
+    std::unique_lock<Costmap2D::mutex_t> lock(*(master->getMutex()));
+    snapshot->costmap = *master;
+  }
+  snapshot->version = version;
+  snapshot->stamp = now();
+
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  if (snapshot_ && snapshot_->version > version) {
+    // a newer snapshot was published meanwhile
+    spare_snapshot_ = std::move(snapshot);
+    return;
+  }
+  spare_snapshot_ = std::move(snapshot_);
+  snapshot_ = std::move(snapshot);
+}
+
 void
 Costmap2DROS::start()
 {
@@ -0,0 +1,244 @@
+// Copyright (c) 2020 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+class SnapshotCostmap2DROS : public nav2_costmap_2d::Costmap2DROS
+{
+public:
+  explicit SnapshotCostmap2DROS(const std::string & name)
+  : nav2_costmap_2d::Costmap2DROS(name) {}
+
+  void publishSnapshotWrapper(uint64_t version)
+  {
+    publishSnapshot(version);
+  }
+
+  // Set every cell of the master costmap to the cost, as a map update would
+  void fill(unsigned char cost)
+  {
+    auto master = getCostmap();
+    std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(master->getMutex()));
+    std::fill_n(
+      master->getCharMap(), master->getSizeInCellsX() * master->getSizeInCellsY(), cost);
+  }
+};
+
+// A configured costmap without layers, so the master costmap is only written by the tests
+std::shared_ptr<SnapshotCostmap2DROS> makeCostmap(const std::string & name)
+{
+  auto costmap = std::make_shared<SnapshotCostmap2DROS>(name);
+  costmap->set_parameter(rclcpp::Parameter("plugins", std::vector<std::string>()));
+  costmap->on_configure(rclcpp_lifecycle::State());
+  return costmap;
+}
+
+// Whether all cells of the costmap have the cost
+bool isFilledWith(const nav2_costmap_2d::Costmap2D & costmap, unsigned char cost)
+{
+  const unsigned char * data = costmap.getCharMap();
+  return std::all_of(
+    data, data + costmap.getSizeInCellsX() * costmap.getSizeInCellsY(),
+    [cost](unsigned char c) {return c == cost;});
+}
+
+TEST(CostmapCopy, reusesBuffersOfTheSameSize)
+{
+  nav2_costmap_2d::Costmap2D copy(10, 10, 0.1, 0.0, 0.0);
+  nav2_costmap_2d::Costmap2D same_size(10, 10, 0.05, 1.0, 2.0);
+  same_size.setCost(3, 4, 200);
+
+  // the same size: copied into the same buffer, with the new resolution and origin
+  const unsigned char * buffer = copy.getCharMap();
+  copy = same_size;
+  EXPECT_EQ(copy.getCharMap(), buffer);
+  EXPECT_EQ(copy.getCost(3, 4), 200);
+  EXPECT_EQ(copy.getResolution(), 0.05);
+  EXPECT_EQ(copy.getOriginX(), 1.0);
+  EXPECT_EQ(copy.getOriginY(), 2.0);
+
+  // another size: reallocated
+  nav2_costmap_2d::Costmap2D other_size(20, 15, 0.1, 0.0, 0.0);
+  other_size.setCost(19, 14, 100);
+  copy = other_size;
+  EXPECT_EQ(copy.getSizeInCellsX(), 20u);
+  EXPECT_EQ(copy.getSizeInCellsY(), 15u);
+  EXPECT_EQ(copy.getCost(19, 14), 100);
+  EXPECT_EQ(copy.getCost(3, 4), 0);
+
+  // and reused from then on
+  buffer = copy.getCharMap();
+  other_size.setCost(0, 0, 50);
+  copy = other_size;
+  EXPECT_EQ(copy.getCharMap(), buffer);
+  EXPECT_EQ(copy.getCost(0, 0), 50);
+  EXPECT_EQ(copy.getCost(19, 14), 100);
+
+  // an empty costmap gets buffers of its own
+  nav2_costmap_2d::Costmap2D empty;
+  empty = other_size;
+  EXPECT_NE(empty.getCharMap(), other_size.getCharMap());
+  EXPECT_EQ(empty.getCost(0, 0), 50);
+}
+
+TEST(CostmapSnapshot, versioning)
+{
+  auto costmap = makeCostmap("snapshot_versioning");
+
+  // the first request copies the master costmap as it is
+  costmap->fill(7);
+  auto first = costmap->getCostmapSnapshot();
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first->version, 0u);
+  EXPECT_TRUE(isFilledWith(first->costmap, 7));
+  EXPECT_EQ(costmap->getCostmapSnapshot(), first);
+
+  // a snapshot does not change with the master costmap
+  costmap->fill(8);
+  EXPECT_EQ(costmap->getCostmapSnapshot(), first);
+  EXPECT_TRUE(isFilledWith(first->costmap, 7));
+
+  // each new snapshot has a new version
+  costmap->publishCostmapSnapshot();
+  auto second = costmap->getCostmapSnapshot();
+  EXPECT_EQ(second->version, 1u);
+  EXPECT_TRUE(isFilledWith(second->costmap, 8));
+  EXPECT_TRUE(isFilledWith(first->costmap, 7));
+
+  costmap->publishCostmapSnapshot();
+  EXPECT_EQ(costmap->getCostmapSnapshot()->version, 2u);
+
+  costmap->on_cleanup(rclcpp_lifecycle::State());
+}
+
+TEST(CostmapSnapshot, newerVersionWins)
+{
+  auto costmap = makeCostmap("snapshot_race");
+
+  // an older snapshot published late does not replace a newer one
+  costmap->publishSnapshotWrapper(10);
+  costmap->publishSnapshotWrapper(5);
+  EXPECT_EQ(costmap->getCostmapSnapshot()->version, 10u);
+
+  // nor when publishing concurrently
+  const int threads = 4;
+  const int versions = 200;
+  std::vector<std::thread> publishers;
+  for (int t = 0; t != threads; t++) {
+    publishers.emplace_back(
+      [&costmap, t]() {
+        for (int version = versions - t; version > 10; version -= threads) {
+          costmap->publishSnapshotWrapper(version);
+        }
+      });
+  }
+  for (auto & publisher : publishers) {
+    publisher.join();
+  }
+  EXPECT_EQ(costmap->getCostmapSnapshot()->version, static_cast<uint64_t>(versions));
+
+  costmap->on_cleanup(rclcpp_lifecycle::State());
+}
+
+TEST(CostmapSnapshot, spareNotReusedWhileHeld)
+{
+  auto costmap = makeCostmap("snapshot_spare");
+
+  costmap->fill(1);
+  auto held = costmap->getCostmapSnapshot();
+  costmap->fill(2);
+  costmap->publishCostmapSnapshot();
+  const nav2_costmap_2d::CostmapSnapshot * released = costmap->getCostmapSnapshot().get();
+
+  // the held snapshot is the spare one now, so it is not written but replaced
+  costmap->fill(3);
+  costmap->publishCostmapSnapshot();
+  auto third = costmap->getCostmapSnapshot();
+  EXPECT_NE(third, held);
+  EXPECT_TRUE(isFilledWith(held->costmap, 1));
+  EXPECT_TRUE(isFilledWith(third->costmap, 3));
+
+  // the second one was released, so it is reused
+  costmap->fill(4);
+  costmap->publishCostmapSnapshot();
+  auto fourth = costmap->getCostmapSnapshot();
+  EXPECT_EQ(fourth.get(), released);
+  EXPECT_TRUE(isFilledWith(fourth->costmap, 4));
+  EXPECT_TRUE(isFilledWith(third->costmap, 3));
+  EXPECT_TRUE(isFilledWith(held->costmap, 1));
+
+  costmap->on_cleanup(rclcpp_lifecycle::State());
+}
+
+TEST(CostmapSnapshot, concurrentReaders)
+{
+  auto costmap = makeCostmap("snapshot_readers");
+  costmap->fill(0);
+  costmap->getCostmapSnapshot();
+
+  // every snapshot must hold the costs of its version for as long as it is read
+  const uint64_t versions = 300;
+  auto costs = [](uint64_t version) {return static_cast<unsigned char>(version % 250);};
+  std::atomic<bool> consistent{true};
+  std::vector<std::thread> readers;
+  for (int r = 0; r != 3; r++) {
+    readers.emplace_back(
+      [&]() {
+        uint64_t last_version = 0;
+        while (last_version != versions) {
+          auto snapshot = costmap->getCostmapSnapshot();
+          if (snapshot->version < last_version) {
+            consistent = false;
+          }
+          for (int i = 0; i != 2; i++) {
+            if (!isFilledWith(snapshot->costmap, costs(snapshot->version))) {
+              consistent = false;
+            }
+            std::this_thread::yield();
+          }
+          last_version = snapshot->version;
+        }
+      });
+  }
+
+  for (uint64_t version = 1; version <= versions; version++) {
+    costmap->fill(costs(version));
+    costmap->publishCostmapSnapshot();
+  }
+  for (auto & reader : readers) {
+    reader.join();
+  }
+  EXPECT_TRUE(consistent);
+
+  costmap->on_cleanup(rclcpp_lifecycle::State());
+}
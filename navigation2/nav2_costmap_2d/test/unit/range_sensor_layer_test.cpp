@@ -0,0 +1,284 @@
+// Copyright (c) 2020 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "angles/angles.h"
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/range_sensor_layer.hpp"
+#include "nav2_util/lifecycle_node.hpp"
+#include "sensor_msgs/msg/range.hpp"
+#include "tf2/LinearMath/Quaternion.h"
+#include "tf2_geometry_msgs/tf2_geometry_msgs.h"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+// The update of the layer as it was before it only evaluated the cells in the sonar cone,
+// applying the sensor model to every cell in the bounds of the cone and past the reading
+
+class ReferenceRangeModel
+{
+public:
+  ReferenceRangeModel(double phi_v, double inflate_cone)
+  : phi_v_(phi_v), inflate_cone_(inflate_cone) {}
+
+  void update(
+    nav2_costmap_2d::Costmap2D & map, const geometry_msgs::msg::TransformStamped & transform,
+    const sensor_msgs::msg::Range & range_message, bool clear_sensor_cone)
+  {
+    max_angle_ = range_message.field_of_view / 2;
+    resolution_ = map.getResolution();
+
+    geometry_msgs::msg::PointStamped in, out;
+    tf2::doTransform(in, out, transform);
+    double ox = out.point.x, oy = out.point.y;
+    in.point.x = range_message.range;
+    tf2::doTransform(in, out, transform);
+    double tx = out.point.x, ty = out.point.y;
+
+    double dx = tx - ox, dy = ty - oy, theta = atan2(dy, dx), d = sqrt(dx * dx + dy * dy);
+
+    int bx0, by0, bx1, by1;
+    int Ox, Oy, Ax, Ay, Bx, By;
+
+    map.worldToMapNoBounds(ox, oy, Ox, Oy);
+    bx1 = bx0 = Ox;
+    by1 = by0 = Oy;
+
+    unsigned int aa, ab;
+    if (map.worldToMap(tx, ty, aa, ab)) {
+      map.setCost(aa, ab, 233);
+    }
+
+    double mx, my;
+    mx = ox + cos(theta - max_angle_) * d * 1.2;
+    my = oy + sin(theta - max_angle_) * d * 1.2;
+    map.worldToMapNoBounds(mx, my, Ax, Ay);
+    bx0 = std::min(bx0, Ax);
+    bx1 = std::max(bx1, Ax);
+    by0 = std::min(by0, Ay);
+    by1 = std::max(by1, Ay);
+
+    mx = ox + cos(theta + max_angle_) * d * 1.2;
+    my = oy + sin(theta + max_angle_) * d * 1.2;
+    map.worldToMapNoBounds(mx, my, Bx, By);
+    bx0 = std::min(bx0, Bx);
+    bx1 = std::max(bx1, Bx);
+    by0 = std::min(by0, By);
+    by1 = std::max(by1, By);
+
+    bx0 = std::max(0, bx0);
+    by0 = std::max(0, by0);
+    bx1 = std::min(static_cast<int>(map.getSizeInCellsX()), bx1);
+    by1 = std::min(static_cast<int>(map.getSizeInCellsY()), by1);
+
+    for (unsigned int x = bx0; x <= (unsigned int)bx1; x++) {
+      for (unsigned int y = by0; y <= (unsigned int)by1; y++) {
+        bool update_xy_cell = true;
+        if (inflate_cone_ < 1.0) {
+          int w0 = orient2d(Ax, Ay, Bx, By, x, y);
+          int w1 = orient2d(Bx, By, Ox, Oy, x, y);
+          int w2 = orient2d(Ox, Oy, Ax, Ay, x, y);
+          float bcciath = -static_cast<float>(inflate_cone_) * area(Ax, Ay, Bx, By, Ox, Oy);
+          update_xy_cell = w0 >= bcciath && w1 >= bcciath && w2 >= bcciath;
+        }
+
+        if (update_xy_cell) {
+          double wx, wy;
+          map.mapToWorld(x, y, wx, wy);
+          update_cell(map, ox, oy, theta, range_message.range, wx, wy, clear_sensor_cone);
+        }
+      }
+    }
+  }
+
+private:
+  void update_cell(
+    nav2_costmap_2d::Costmap2D & map, double ox, double oy, double ot, double r,
+    double nx, double ny, bool clear)
+  {
+    unsigned int x, y;
+    if (map.worldToMap(nx, ny, x, y)) {
+      double dx = nx - ox, dy = ny - oy;
+      double theta = atan2(dy, dx) - ot;
+      theta = angles::normalize_angle(theta);
+      double phi = sqrt(dx * dx + dy * dy);
+      double sensor = 0.0;
+      if (!clear) {
+        sensor = sensor_model(r, phi, theta);
+      }
+      double prior = static_cast<double>(map.getCost(x, y)) / nav2_costmap_2d::LETHAL_OBSTACLE;
+      double prob_occ = sensor * prior;
+      double prob_not = (1 - sensor) * (1 - prior);
+      double new_prob = prob_occ / (prob_occ + prob_not);
+      map.setCost(
+        x, y, static_cast<unsigned char>(new_prob * nav2_costmap_2d::LETHAL_OBSTACLE));
+    }
+  }
+
+  double sensor_model(double r, double phi, double theta)
+  {
+    double gamma = fabs(theta) > max_angle_ ? 0.0 : 1 - pow(theta / max_angle_, 2);
+    double lbda = (1 - (1 + tanh(2 * (phi - phi_v_))) / 2) * gamma;
+
+    double delta = resolution_;
+
+    if (phi >= 0.0 && phi < r - 2 * delta * r) {
+      return (1 - lbda) * (0.5);
+    } else if (phi < r - delta * r) {
+      return lbda * 0.5 * pow((phi - (r - 2 * delta * r)) / (delta * r), 2) +
+             (1 - lbda) * .5;
+    } else if (phi < r + delta * r) {
+      double J = (r - phi) / (delta * r);
+      return lbda * ((1 - (0.5) * pow(J, 2)) - 0.5) + 0.5;
+    } else {
+      return 0.5;
+    }
+  }
+
+  float area(int x1, int y1, int x2, int y2, int x3, int y3)
+  {
+    return fabs((x1 * (y2 - y3) + x2 * (y3 - y1) + x3 * (y1 - y2)) / 2.0);
+  }
+
+  int orient2d(int Ax, int Ay, int Bx, int By, int Cx, int Cy)
+  {
+    return (Bx - Ax) * (Cy - Ay) - (By - Ay) * (Cx - Ax);
+  }
+
+  double phi_v_, inflate_cone_;
+  double max_angle_, resolution_;
+};
+
+class RangeSensorLayerTest : public ::testing::TestWithParam<double>
+{
+protected:
+  void SetUp() override
+  {
+    node_ = std::make_shared<nav2_util::LifecycleNode>("range_sensor_layer_test", "", false);
+    node_->declare_parameter("transform_tolerance", rclcpp::ParameterValue(0.3));
+    node_->declare_parameter(
+      "range.topics", rclcpp::ParameterValue(std::vector<std::string>{"/range/topic"}));
+    node_->declare_parameter("range.clear_on_max_reading", rclcpp::ParameterValue(true));
+    node_->declare_parameter("range.inflate_cone", rclcpp::ParameterValue(GetParam()));
+
+    tf_ = std::make_shared<tf2_ros::Buffer>(node_->get_clock());
+    layers_ = std::make_unique<nav2_costmap_2d::LayeredCostmap>("map", false, false);
+    layers_->resizeMap(60, 60, 0.05, 0.0, 0.0);
+    rlayer_ = std::make_shared<nav2_costmap_2d::RangeSensorLayer>();
+    layers_->addPlugin(rlayer_);
+    rlayer_->initialize(layers_.get(), "range", tf_.get(), node_, nullptr, nullptr);
+  }
+
+  void TearDown() override
+  {
+    rlayer_.reset();
+    layers_.reset();
+    tf_.reset();
+    node_.reset();
+  }
+
+  nav2_util::LifecycleNode::SharedPtr node_;
+  std::shared_ptr<tf2_ros::Buffer> tf_;
+  std::unique_ptr<nav2_costmap_2d::LayeredCostmap> layers_;
+  std::shared_ptr<nav2_costmap_2d::RangeSensorLayer> rlayer_;
+};
+
+// 3000 random maps of 10 random readings each, with wide and narrow cones, clearing ones,
+// and cones reaching past the edges of the map, must give the same costs as the reference
+TEST_P(RangeSensorLayerTest, matchesReferenceUpdate)
+{
+  ReferenceRangeModel reference_model(1.2, GetParam());
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> position(0.0, 6.0);
+  std::uniform_real_distribution<double> yaw(-3.5, 3.5);
+  std::uniform_real_distribution<double> range(0.1, 2.6);
+  std::uniform_real_distribution<double> narrow_fov(0.05, 1.05);
+  std::uniform_int_distribution<int> choice(0, 11);
+  // Certain costs would make the update divide 0 by 0 for a certain sensor probability
+  std::uniform_int_distribution<int> cost(1, nav2_costmap_2d::LETHAL_OBSTACLE - 1);
+
+  for (int map = 0; map != 3000; map++) {
+    layers_->resizeMap(60, 60, map % 2 ? 0.05 : 0.1, 0.0, 0.0);
+    for (unsigned int y = 0; y != 60; y++) {
+      for (unsigned int x = 0; x != 60; x++) {
+        rlayer_->setCost(x, y, choice(generator) < 3 ? cost(generator) : 127);
+      }
+    }
+    nav2_costmap_2d::Costmap2D reference(*rlayer_);
+
+    for (int reading = 0; reading != 10; reading++) {
+      geometry_msgs::msg::TransformStamped transform;
+      transform.header.frame_id = "map";
+      transform.header.stamp = node_->now();
+      transform.child_frame_id = "sonar";
+      transform.transform.translation.x = position(generator);
+      transform.transform.translation.y = position(generator);
+      tf2::Quaternion q;
+      q.setRPY(0.0, 0.0, yaw(generator));
+      transform.transform.rotation = tf2::toMsg(q);
+      tf_->setTransform(transform, "range_sensor_layer_test", true);
+
+      sensor_msgs::msg::Range msg;
+      msg.header.frame_id = "sonar";
+      msg.header.stamp = transform.header.stamp;
+      msg.radiation_type = msg.ULTRASOUND;
+      msg.field_of_view = choice(generator) < 3 ? 3.5 : narrow_fov(generator);
+      msg.min_range = 0.05;
+      msg.range = range(generator);
+      const bool clear = choice(generator) < 2;
+      msg.max_range = clear ? msg.range : 3.0;
+
+      rlayer_->bufferIncomingRangeMsg(std::make_shared<sensor_msgs::msg::Range>(msg));
+      double min_x = std::numeric_limits<double>::max();
+      double min_y = std::numeric_limits<double>::max();
+      double max_x = -std::numeric_limits<double>::max();
+      double max_y = -std::numeric_limits<double>::max();
+      rlayer_->updateBounds(0.0, 0.0, 0.0, &min_x, &min_y, &max_x, &max_y);
+
+      reference_model.update(
+        reference, tf_->lookupTransform("map", "sonar", tf2_ros::fromMsg(msg.header.stamp)),
+        msg, clear);
+    }
+
+    int mismatches = 0;
+    for (unsigned int y = 0; y != 60; y++) {
+      for (unsigned int x = 0; x != 60; x++) {
+        mismatches += rlayer_->getCost(x, y) != reference.getCost(x, y);
+      }
+    }
+    ASSERT_EQ(mismatches, 0) << "on map " << map;
+  }
+}
+
+// Without and with the barycentric cone test
+INSTANTIATE_TEST_CASE_P(
+  InflateCone, RangeSensorLayerTest,
+  ::testing::Values(1.0, 0.5));
@@ -0,0 +1,264 @@
+// Copyright (c) 2020 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/static_layer.hpp"
+#include "nav2_util/lifecycle_node.hpp"
+#include "nav_msgs/msg/occupancy_grid.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+class StaticLayerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    node_ = std::make_shared<nav2_util::LifecycleNode>("static_layer_test", "", false);
+    node_->declare_parameter("map_topic", rclcpp::ParameterValue(std::string("map")));
+    node_->declare_parameter("track_unknown_space", rclcpp::ParameterValue(false));
+    node_->declare_parameter("use_maximum", rclcpp::ParameterValue(false));
+    node_->declare_parameter("lethal_cost_threshold", rclcpp::ParameterValue(100));
+    node_->declare_parameter(
+      "unknown_cost_value",
+      rclcpp::ParameterValue(static_cast<unsigned char>(0xff)));
+    node_->declare_parameter("trinary_costmap", rclcpp::ParameterValue(true));
+    node_->declare_parameter("transform_tolerance", rclcpp::ParameterValue(0.3));
+
+    tf_ = std::make_shared<tf2_ros::Buffer>(node_->get_clock());
+    layers_ = std::make_unique<nav2_costmap_2d::LayeredCostmap>("map", false, false);
+    slayer_ = std::make_shared<nav2_costmap_2d::StaticLayer>();
+    layers_->addPlugin(slayer_);
+    slayer_->initialize(layers_.get(), "static", tf_.get(), node_, nullptr, nullptr);
+
+    // the maps are published like the map server does, and also received by a probe
+    // subscription of the node of the layer, to know when they arrived
+    const auto map_qos = rclcpp::QoS(1).transient_local().reliable();
+    pub_node_ = std::make_shared<rclcpp::Node>("static_layer_test_map_server");
+    map_pub_ = pub_node_->create_publisher<nav_msgs::msg::OccupancyGrid>("map", map_qos);
+    probe_sub_ = node_->create_subscription<nav_msgs::msg::OccupancyGrid>(
+      "map", map_qos,
+      [this](const nav_msgs::msg::OccupancyGrid::SharedPtr) {maps_received_++;});
+
+    // a free 10 x 10 map with 1m cells
+    map_.header.frame_id = "map";
+    map_.info.width = 10;
+    map_.info.height = 10;
+    map_.info.resolution = 1.0;
+    map_.data.assign(100, 0);
+  }
+
+  // Publish the map and wait until the node of the static layer has received it
+  void publishMap()
+  {
+    const unsigned int maps_received = maps_received_;
+    map_pub_->publish(map_);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (maps_received_ == maps_received &&
+      std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+      rclcpp::spin_some(node_->get_node_base_interface());
+    }
+    ASSERT_GT(maps_received_, maps_received);
+
+    // the layer's own subscription may be served right after the probe
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100)) {
+      rclcpp::spin_some(node_->get_node_base_interface());
+    }
+  }
+
+  void setOccupied(unsigned int x, unsigned int y)
+  {
+    map_.data[y * map_.info.width + x] = 100;
+  }
+
+  // Update the master costmap and check the area updated, in cells, empty if none
+  void expectUpdatedArea(unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
+  {
+    layers_->updateMap(0.0, 0.0, 0.0);
+    double min_x, min_y, max_x, max_y;
+    layers_->getUpdatedBounds(min_x, min_y, max_x, max_y);
+    if (x0 == xn || y0 == yn) {
+      EXPECT_EQ(min_x, std::numeric_limits<double>::max());
+      EXPECT_EQ(min_y, std::numeric_limits<double>::max());
+      EXPECT_EQ(max_x, std::numeric_limits<double>::lowest());
+      EXPECT_EQ(max_y, std::numeric_limits<double>::lowest());
+      return;
+    }
+    // the bounds go from the center of the first cell to the center of the one past the last
+    EXPECT_DOUBLE_EQ(min_x, x0 + 0.5);
+    EXPECT_DOUBLE_EQ(min_y, y0 + 0.5);
+    EXPECT_DOUBLE_EQ(max_x, xn + 0.5);
+    EXPECT_DOUBLE_EQ(max_y, yn + 0.5);
+  }
+
+  // Whether the master costmap has the cost of the map in every cell
+  void expectMasterMatchesMap()
+  {
+    auto master = layers_->getCostmap();
+    for (unsigned int y = 0; y != map_.info.height; y++) {
+      for (unsigned int x = 0; x != map_.info.width; x++) {
+        const unsigned char expected = map_.data[y * map_.info.width + x] == 100 ?
+          nav2_costmap_2d::LETHAL_OBSTACLE : nav2_costmap_2d::FREE_SPACE;
+        EXPECT_EQ(master->getCost(x, y), expected) << x << ", " << y;
+      }
+    }
+  }
+
+  nav2_util::LifecycleNode::SharedPtr node_;
+  std::shared_ptr<tf2_ros::Buffer> tf_;
+  std::unique_ptr<nav2_costmap_2d::LayeredCostmap> layers_;
+  std::shared_ptr<nav2_costmap_2d::StaticLayer> slayer_;
+  rclcpp::Node::SharedPtr pub_node_;
+  rclcpp::Publisher<nav_msgs::msg::OccupancyGrid>::SharedPtr map_pub_;
+  rclcpp::Subscription<nav_msgs::msg::OccupancyGrid>::SharedPtr probe_sub_;
+  unsigned int maps_received_{0};
+  nav_msgs::msg::OccupancyGrid map_;
+};
+
+TEST_F(StaticLayerTest, firstMapUpdatesEverything)
+{
+  setOccupied(4, 4);
+  publishMap();
+  EXPECT_EQ(layers_->getCostmap()->getSizeInCellsX(), 10u);
+  EXPECT_EQ(layers_->getCostmap()->getSizeInCellsY(), 10u);
+  expectUpdatedArea(0, 0, 10, 10);
+  expectMasterMatchesMap();
+}
+
+TEST_F(StaticLayerTest, unchangedMapUpdatesNothing)
+{
+  setOccupied(4, 4);
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+
+  publishMap();
+  expectUpdatedArea(0, 0, 0, 0);
+  expectMasterMatchesMap();
+}
+
+TEST_F(StaticLayerTest, changedRowsBounds)
+{
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+
+  // from the first to the last cell changed, in the rows which changed
+  setOccupied(3, 4);
+  setOccupied(6, 7);
+  publishMap();
+  expectUpdatedArea(3, 4, 7, 8);
+  expectMasterMatchesMap();
+
+  // a single cell, at the end of a row
+  setOccupied(9, 2);
+  publishMap();
+  expectUpdatedArea(9, 2, 10, 3);
+  expectMasterMatchesMap();
+
+  // cells freed again are changes as well
+  map_.data[4 * map_.info.width + 3] = 0;
+  publishMap();
+  expectUpdatedArea(3, 4, 4, 5);
+  expectMasterMatchesMap();
+}
+
+TEST_F(StaticLayerTest, changesAccumulateUntilUpdated)
+{
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+
+  // the bounds of maps received between two updates are merged
+  setOccupied(1, 1);
+  publishMap();
+  setOccupied(8, 5);
+  publishMap();
+  expectUpdatedArea(1, 1, 9, 6);
+  expectMasterMatchesMap();
+}
+
+TEST_F(StaticLayerTest, resetUpdatesEverything)
+{
+  setOccupied(4, 4);
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+  expectUpdatedArea(0, 0, 0, 0);
+
+  slayer_->reset();
+  expectUpdatedArea(0, 0, 10, 10);
+  expectMasterMatchesMap();
+
+  // and the next unchanged map does not
+  publishMap();
+  expectUpdatedArea(0, 0, 0, 0);
+}
+
+TEST_F(StaticLayerTest, otherFrameUpdatesEverything)
+{
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+
+  map_.header.frame_id = "other_map";
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+}
+
+TEST_F(StaticLayerTest, sameSizeMapUpdatesChangedRows)
+{
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+
+  // a map of the same size and origin takes the row by row comparison
+  setOccupied(2, 6);
+  setOccupied(5, 6);
+  publishMap();
+  expectUpdatedArea(2, 6, 6, 7);
+  expectMasterMatchesMap();
+}
+
+TEST_F(StaticLayerTest, grownMapUpdatesEverything)
+{
+  publishMap();
+  expectUpdatedArea(0, 0, 10, 10);
+
+  // a map growing, as SLAM maps do, resizes the costmap, so all of it is updated
+  map_.info.width = 12;
+  map_.data.assign(120, 0);
+  setOccupied(11, 3);
+  publishMap();
+  EXPECT_EQ(layers_->getCostmap()->getSizeInCellsX(), 12u);
+  expectUpdatedArea(0, 0, 12, 10);
+  expectMasterMatchesMap();
+
+  // and the next maps of the new size only update their changed rows again
+  setOccupied(1, 8);
+  publishMap();
+  expectUpdatedArea(1, 8, 2, 9);
+  expectMasterMatchesMap();
+}
@@ -71,6 +71,7 @@ void DWBLocalPlanner::configure(
   node_ = node;
   costmap_ros_ = costmap_ros;
   tf_ = tf;
+  transform_cache_ = std::make_unique<nav_2d_utils::TransformCache>(tf_);
   dwb_plugin_name_ = name;
   declare_parameter_if_not_declared(node_, dwb_plugin_name_ + ".critics");
   declare_parameter_if_not_declared(node_, dwb_plugin_name_ + ".default_critic_namespaces");
@@ -301,6 +302,9 @@ DWBLocalPlanner::prepareGlobalPlan(
   const nav_2d_msgs::msg::Pose2DStamped & pose, nav_2d_msgs::msg::Path2D & transformed_plan,
   nav_2d_msgs::msg::Pose2DStamped & goal_pose, bool publish_plan)
 {
+  // The transforms are looked up once per cycle
+  transform_cache_->clear();
+
   transformed_plan = transformGlobalPlan(pose);
   if (publish_plan) {
     pub_->publishTransformedPlan(transformed_plan);
@@ -308,8 +312,8 @@ DWBLocalPlanner::prepareGlobalPlan(
 
   goal_pose.header.frame_id = global_plan_.header.frame_id;
   goal_pose.pose = global_plan_.poses.back();
-  nav_2d_utils::transformPose(
-    tf_, costmap_ros_->getGlobalFrameID(), goal_pose,
+  transform_cache_->transformPose(
+    costmap_ros_->getGlobalFrameID(), goal_pose,
     goal_pose, transform_tolerance_);
 }
 
@@ -494,8 +498,8 @@ DWBLocalPlanner::transformGlobalPlan(
 
   // let's get the pose of the robot in the frame of the plan
   nav_2d_msgs::msg::Pose2DStamped robot_pose;
-  if (!nav_2d_utils::transformPose(
-      tf_, global_plan_.header.frame_id, pose,
+  if (!transform_cache_->transformPose(
+      global_plan_.header.frame_id, pose,
       robot_pose, transform_tolerance_))
   {
     throw dwb_core::
@@ -553,26 +557,20 @@ DWBLocalPlanner::transformGlobalPlan(
   transformed_plan.header.frame_id = costmap_ros_->getGlobalFrameID();
   transformed_plan.header.stamp = pose.header.stamp;
 
-  // Helper function for the transform below. Converts a pose2D from global
-  // frame to local
-  auto transformGlobalPoseToLocal = [&](const auto & global_plan_pose) {
-      nav_2d_msgs::msg::Pose2DStamped stamped_pose, transformed_pose;
-      stamped_pose.header.frame_id = global_plan_.header.frame_id;
-      stamped_pose.pose = global_plan_pose;
-      nav_2d_utils::transformPose(
-        tf_, transformed_plan.header.frame_id,
-        stamped_pose, transformed_pose, transform_tolerance_);
-      return transformed_pose.pose;
-    };
-
-  std::transform(
-    transformation_begin, transformation_end,
-    std::back_inserter(transformed_plan.poses),
-    transformGlobalPoseToLocal);
+  // All the poses are transformed from the global frame to local with the
+  // latest transform, looked up once
+  if (!transform_cache_->transformPoses(
+      transformed_plan.header.frame_id, global_plan_.header.frame_id,
+      builtin_interfaces::msg::Time(), transformation_begin, transformation_end,
+      transformed_plan.poses, transform_tolerance_))
+  {
+    throw dwb_core::
+          PlannerTFException("Unable to transform global plan into the costmap's frame");
+  }
 
   // Remove the portion of the global plan that we've already passed so we don't
   // process it on the next iteration.
-  if (prune_plan_) {
+  if (prune_plan_ && transformation_begin != begin(global_plan_.poses)) {
     global_plan_.poses.erase(begin(global_plan_.poses), transformation_begin);
     pub_->publishGlobalPlan(global_plan_);
   }
@@ -293,30 +293,30 @@ DWBPublisher::publishCostGrid(
 }
 
 void
-DWBPublisher::publishGlobalPlan(const nav_2d_msgs::msg::Path2D plan)
+DWBPublisher::publishGlobalPlan(const nav_2d_msgs::msg::Path2D & plan)
 {
   publishGenericPlan(plan, *global_pub_, publish_global_plan_);
 }
 
 void
-DWBPublisher::publishTransformedPlan(const nav_2d_msgs::msg::Path2D plan)
+DWBPublisher::publishTransformedPlan(const nav_2d_msgs::msg::Path2D & plan)
 {
   publishGenericPlan(plan, *transformed_pub_, publish_transformed_);
 }
 
 void
-DWBPublisher::publishLocalPlan(const nav_2d_msgs::msg::Path2D plan)
+DWBPublisher::publishLocalPlan(const nav_2d_msgs::msg::Path2D & plan)
 {
   publishGenericPlan(plan, *local_pub_, publish_local_plan_);
 }
 
 void
 DWBPublisher::publishGenericPlan(
-  const nav_2d_msgs::msg::Path2D plan,
+  const nav_2d_msgs::msg::Path2D & plan,
   rclcpp::Publisher<nav_msgs::msg::Path> & pub, bool flag)
 {
-  if (node_->count_subscribers(pub.get_topic_name()) < 1) {return;}
   if (!flag) {return;}
+  if (node_->count_subscribers(pub.get_topic_name()) < 1) {return;}
   auto path = std::make_unique<nav_msgs::msg::Path>(nav_2d_utils::pathToPath(plan));
   pub.publish(std::move(path));
 }
@@ -0,0 +1,250 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "dwb_core/dwb_local_planner.hpp"
+#include "dwb_core/exceptions.hpp"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav_msgs/msg/path.hpp"
+
+using namespace std::chrono_literals;
+
+class TransformPlanTester : public dwb_core::DWBLocalPlanner
+{
+public:
+  // Sets up what transformGlobalPlan uses, without the plugins loaded by configure
+  void setUp(
+    const rclcpp_lifecycle::LifecycleNode::SharedPtr & node,
+    const std::shared_ptr<tf2_ros::Buffer> & tf,
+    const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> & costmap_ros,
+    bool prune_plan)
+  {
+    node_ = node;
+    tf_ = tf;
+    transform_cache_ = std::make_unique<nav_2d_utils::TransformCache>(tf_);
+    costmap_ros_ = costmap_ros;
+    prune_plan_ = prune_plan;
+    prune_distance_ = 1.0;
+    shorten_transformed_plan_ = true;
+    transform_tolerance_ = rclcpp::Duration::from_seconds(0.1);
+    pub_ = std::make_unique<dwb_core::DWBPublisher>(node_, "dwb");
+    pub_->on_configure();
+    pub_->on_activate();
+  }
+
+  nav_2d_msgs::msg::Path2D transformGlobalPlanWrapper(
+    const nav_2d_msgs::msg::Pose2DStamped & pose)
+  {
+    // as prepareGlobalPlan does at each cycle
+    transform_cache_->clear();
+    return transformGlobalPlan(pose);
+  }
+
+  void setGlobalPlan(const nav_2d_msgs::msg::Path2D & plan)
+  {
+    global_plan_ = plan;
+  }
+
+  const nav_2d_msgs::msg::Path2D & getGlobalPlan()
+  {
+    return global_plan_;
+  }
+};
+
+class TransformPlanFixture : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    node_ = std::make_shared<rclcpp_lifecycle::LifecycleNode>("transform_plan_test");
+    tf_ = std::make_shared<tf2_ros::Buffer>(node_->get_clock());
+    // a 5m by 5m costmap in the map frame, without layers
+    costmap_ros_ = std::make_shared<nav2_costmap_2d::Costmap2DROS>("transform_plan_costmap");
+    costmap_ros_->set_parameter(rclcpp::Parameter("plugins", std::vector<std::string>()));
+    costmap_ros_->on_configure(rclcpp_lifecycle::State());
+
+    received_ = 0;
+    sub_ = node_->create_subscription<nav_msgs::msg::Path>(
+      "received_global_plan", 10,
+      [this](const nav_msgs::msg::Path::SharedPtr msg) {
+        received_++;
+        received_size_ = msg->poses.size();
+      });
+  }
+
+  void TearDown() override
+  {
+    costmap_ros_->on_cleanup(rclcpp_lifecycle::State());
+  }
+
+  // A straight plan along the x axis, from 0 to 4m every 10cm
+  nav_2d_msgs::msg::Path2D makePlan(const std::string & frame)
+  {
+    nav_2d_msgs::msg::Path2D plan;
+    plan.header.frame_id = frame;
+    for (int i = 0; i <= 40; i++) {
+      geometry_msgs::msg::Pose2D pose;
+      pose.x = 0.1 * i;
+      plan.poses.push_back(pose);
+    }
+    return plan;
+  }
+
+  nav_2d_msgs::msg::Pose2DStamped makeRobotPose(const std::string & frame, double x)
+  {
+    nav_2d_msgs::msg::Pose2DStamped pose;
+    pose.header.frame_id = frame;
+    pose.pose.x = x;
+    return pose;
+  }
+
+  // Spin until the global plan is received or the timeout
+  void spinFor(std::chrono::milliseconds timeout, bool until_received = false)
+  {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < end && !(until_received && received_ > 0)) {
+      rclcpp::spin_some(node_->get_node_base_interface());
+      std::this_thread::sleep_for(10ms);
+    }
+  }
+
+  void waitForSubscription()
+  {
+    auto end = std::chrono::steady_clock::now() + 2s;
+    while (node_->count_subscribers("received_global_plan") < 1 &&
+      std::chrono::steady_clock::now() < end)
+    {
+      std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_GE(node_->count_subscribers("received_global_plan"), 1u);
+  }
+
+  rclcpp_lifecycle::LifecycleNode::SharedPtr node_;
+  std::shared_ptr<tf2_ros::Buffer> tf_;
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros_;
+  rclcpp::Subscription<nav_msgs::msg::Path>::SharedPtr sub_;
+  int received_;
+  std::size_t received_size_;
+};
+
+TEST_F(TransformPlanFixture, ThrowsWithoutTransform)
+{
+  TransformPlanTester planner;
+  planner.setUp(node_, tf_, costmap_ros_, true);
+
+  // the robot pose cannot be transformed into the frame of the plan
+  planner.setGlobalPlan(makePlan("odom"));
+  EXPECT_THROW(
+    planner.transformGlobalPlanWrapper(makeRobotPose("map", 0.0)),
+    dwb_core::PlannerTFException);
+
+  // the plan cannot be transformed into the frame of the costmap
+  EXPECT_THROW(
+    planner.transformGlobalPlanWrapper(makeRobotPose("odom", 0.0)),
+    dwb_core::PlannerTFException);
+  EXPECT_EQ(planner.getGlobalPlan().poses.size(), 41u);
+
+  // which it is once the transform is available
+  geometry_msgs::msg::TransformStamped transform;
+  transform.header.frame_id = "map";
+  transform.child_frame_id = "odom";
+  transform.transform.translation.x = 1.0;
+  transform.transform.rotation.w = 1.0;
+  tf_->setTransform(transform, "test", true);
+  auto transformed = planner.transformGlobalPlanWrapper(makeRobotPose("odom", 0.05));
+  EXPECT_EQ(transformed.header.frame_id, "map");
+  ASSERT_EQ(transformed.poses.size(), 11u);
+  for (std::size_t i = 0; i != transformed.poses.size(); i++) {
+    EXPECT_NEAR(transformed.poses[i].x, 1.0 + 0.1 * i, 1e-6);
+  }
+}
+
+TEST_F(TransformPlanFixture, RepublishesOnlyPrunedPlan)
+{
+  TransformPlanTester planner;
+  planner.setUp(node_, tf_, costmap_ros_, true);
+  waitForSubscription();
+  planner.setGlobalPlan(makePlan("map"));
+
+  // nothing passed yet, so nothing is pruned nor published
+  auto transformed = planner.transformGlobalPlanWrapper(makeRobotPose("map", 0.05));
+  EXPECT_EQ(transformed.poses.size(), 11u);
+  EXPECT_EQ(planner.getGlobalPlan().poses.size(), 41u);
+  spinFor(200ms);
+  EXPECT_EQ(received_, 0);
+
+  // the poses further than the prune distance behind the robot are pruned and published
+  transformed = planner.transformGlobalPlanWrapper(makeRobotPose("map", 2.05));
+  EXPECT_EQ(transformed.poses.size(), 20u);
+  ASSERT_EQ(planner.getGlobalPlan().poses.size(), 30u);
+  EXPECT_NEAR(planner.getGlobalPlan().poses.front().x, 1.1, 1e-6);
+  spinFor(1s, true);
+  EXPECT_EQ(received_, 1);
+  EXPECT_EQ(received_size_, 30u);
+
+  // and not again from the same pose
+  planner.transformGlobalPlanWrapper(makeRobotPose("map", 2.05));
+  EXPECT_EQ(planner.getGlobalPlan().poses.size(), 30u);
+  spinFor(200ms);
+  EXPECT_EQ(received_, 1);
+}
+
+TEST_F(TransformPlanFixture, DoesNotPublishWithoutPruning)
+{
+  TransformPlanTester planner;
+  planner.setUp(node_, tf_, costmap_ros_, false);
+  waitForSubscription();
+  planner.setGlobalPlan(makePlan("map"));
+
+  planner.transformGlobalPlanWrapper(makeRobotPose("map", 2.05));
+  EXPECT_EQ(planner.getGlobalPlan().poses.size(), 41u);
+  spinFor(200ms);
+  EXPECT_EQ(received_, 0);
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  int ret = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return ret;
+}
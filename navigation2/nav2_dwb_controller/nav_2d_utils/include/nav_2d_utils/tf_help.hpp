@@ -35,11 +35,15 @@
 #ifndef NAV_2D_UTILS__TF_HELP_HPP_
 #define NAV_2D_UTILS__TF_HELP_HPP_
 
+#include <map>
 #include <string>
 #include <memory>
+#include <tuple>
+#include <vector>
 #include "tf2_ros/buffer.h"
 #include "nav_2d_utils/conversions.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav_2d_msgs/msg/path2_d.hpp"
 #include "nav_2d_msgs/msg/pose2_d_stamped.hpp"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.h"
 
@@ -81,6 +85,103 @@ bool transformPose(
   rclcpp::Duration & transform_tolerance
 );
 
+/**
+ * @class TransformCache
+ * @brief Looks up each transform from the tf buffer once, until cleared
+ *
+ * Transforms are kept by target frame, source frame and time, so all the poses of a
+ * control cycle which need the same transform share a single lookup. It is meant to
+ * be cleared at the start of each cycle.
+ */
+class TransformCache
+{
+public:
+  /**
+   * @brief Constructor
+   * @param tf Smart pointer to TFListener
+   */
+  explicit TransformCache(const std::shared_ptr<tf2_ros::Buffer> & tf);
+
+  /**
+   * @brief Forget all the transforms looked up
+   */
+  void clear();
+
+  /**
+   * @brief Get the transform between two frames, with the same fallback to the
+   * latest transform within the tolerance as transformPose
+   * @param target_frame Frame to transform into
+   * @param source_frame Frame to transform from
+   * @param stamp Time of the transform
+   * @param transform_tolerance Tolerance on the time of the latest transform
+   * @param transform Place to store the transform
+   * @return True if successful lookup
+   */
+  bool lookupTransform(
+    const std::string & target_frame,
+    const std::string & source_frame,
+    const builtin_interfaces::msg::Time & stamp,
+    const rclcpp::Duration & transform_tolerance,
+    geometry_msgs::msg::TransformStamped & transform);
+
+  /**
+   * @brief Transform a Pose2DStamped from one frame to another while catching exceptions
+   *
+   * Also returns immediately if the frames are equal.
+   * @param frame Frame to transform the pose into
+   * @param in_pose Pose to transform
+   * @param out_pose Place to store the resulting transformed pose
+   * @param transform_tolerance Tolerance on the time of the latest transform
+   * @return True if successful transform
+   */
+  bool transformPose(
+    const std::string & frame,
+    const nav_2d_msgs::msg::Pose2DStamped & in_pose,
+    nav_2d_msgs::msg::Pose2DStamped & out_pose,
+    const rclcpp::Duration & transform_tolerance);
+
+  /**
+   * @brief Transform a range of poses, all in the same frame and at the same time,
+   * with a single transform
+   * @param frame Frame to transform the poses into
+   * @param source_frame Frame of the poses
+   * @param stamp Time of the poses
+   * @param begin First pose to transform
+   * @param end Past the last pose to transform
+   * @param out_poses Poses to append the resulting transformed poses to
+   * @param transform_tolerance Tolerance on the time of the latest transform
+   * @return True if successful transform
+   */
+  bool transformPoses(
+    const std::string & frame,
+    const std::string & source_frame,
+    const builtin_interfaces::msg::Time & stamp,
+    std::vector<geometry_msgs::msg::Pose2D>::const_iterator begin,
+    std::vector<geometry_msgs::msg::Pose2D>::const_iterator end,
+    std::vector<geometry_msgs::msg::Pose2D> & out_poses,
+    const rclcpp::Duration & transform_tolerance);
+
+  /**
+   * @brief Transform a Path2D from one frame to another
+   * @param frame Frame to transform the path into
+   * @param in_path Path to transform
+   * @param out_path Place to store the resulting transformed path
+   * @param transform_tolerance Tolerance on the time of the latest transform
+   * @return True if successful transform
+   */
+  bool transformPath(
+    const std::string & frame,
+    const nav_2d_msgs::msg::Path2D & in_path,
+    nav_2d_msgs::msg::Path2D & out_path,
+    const rclcpp::Duration & transform_tolerance);
+
+protected:
+  typedef std::tuple<std::string, std::string, int32_t, uint32_t> TransformKey;
+
+  std::shared_ptr<tf2_ros::Buffer> tf_;
+  std::map<TransformKey, geometry_msgs::msg::TransformStamped> transforms_;
+};
+
 }  // namespace nav_2d_utils
 
 #endif  // NAV_2D_UTILS__TF_HELP_HPP_
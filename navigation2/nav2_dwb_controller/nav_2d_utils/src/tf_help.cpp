@@ -32,9 +32,13 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cmath>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include "nav_2d_utils/tf_help.hpp"
+#include "tf2/utils.h"
 
 namespace nav_2d_utils
 {
@@ -112,4 +116,165 @@ bool transformPose(
   }
   return ret;
 }
+
+TransformCache::TransformCache(const std::shared_ptr<tf2_ros::Buffer> & tf)
+: tf_(tf)
+{
+}
+
+void TransformCache::clear()
+{
+  transforms_.clear();
+}
+
+bool TransformCache::lookupTransform(
+  const std::string & target_frame,
+  const std::string & source_frame,
+  const builtin_interfaces::msg::Time & stamp,
+  const rclcpp::Duration & transform_tolerance,
+  geometry_msgs::msg::TransformStamped & transform)
+{
+  const TransformKey key(target_frame, source_frame, stamp.sec, stamp.nanosec);
+  auto it = transforms_.find(key);
+  if (it != transforms_.end()) {
+    transform = it->second;
+    return true;
+  }
+
+  try {
+    try {
+      transform = tf_->lookupTransform(target_frame, source_frame, tf2_ros::fromMsg(stamp));
+    } catch (tf2::ExtrapolationException & ex) {
+      transform = tf_->lookupTransform(target_frame, source_frame, tf2::TimePointZero);
+      if (
+        (rclcpp::Time(stamp) - rclcpp::Time(transform.header.stamp)) >
+        transform_tolerance)
+      {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("tf_help"),
+          "Transform data too old when converting from %s to %s",
+          source_frame.c_str(),
+          target_frame.c_str()
+        );
+        RCLCPP_ERROR(
+          rclcpp::get_logger("tf_help"),
+          "Data time: %ds %uns, Transform time: %ds %uns",
+          stamp.sec,
+          stamp.nanosec,
+          transform.header.stamp.sec,
+          transform.header.stamp.nanosec
+        );
+        return false;
+      }
+    }
+  } catch (tf2::TransformException & ex) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("tf_help"),
+      "Exception in lookupTransform: %s",
+      ex.what()
+    );
+    return false;
+  }
+
+  transforms_.emplace(key, transform);
+  return true;
+}
+
+bool TransformCache::transformPose(
+  const std::string & frame,
+  const nav_2d_msgs::msg::Pose2DStamped & in_pose,
+  nav_2d_msgs::msg::Pose2DStamped & out_pose,
+  const rclcpp::Duration & transform_tolerance)
+{
+  std::vector<geometry_msgs::msg::Pose2D> out_poses;
+  out_poses.reserve(1);
+  const std::vector<geometry_msgs::msg::Pose2D> in_poses(1, in_pose.pose);
+  if (!transformPoses(
+      frame, in_pose.header.frame_id, in_pose.header.stamp,
+      in_poses.begin(), in_poses.end(), out_poses, transform_tolerance))
+  {
+    return false;
+  }
+
+  out_pose.header.frame_id = frame;
+  out_pose.header.stamp = in_pose.header.stamp;
+  out_pose.pose = out_poses.front();
+  return true;
+}
+
+bool TransformCache::transformPoses(
+  const std::string & frame,
+  const std::string & source_frame,
+  const builtin_interfaces::msg::Time & stamp,
+  std::vector<geometry_msgs::msg::Pose2D>::const_iterator begin,
+  std::vector<geometry_msgs::msg::Pose2D>::const_iterator end,
+  std::vector<geometry_msgs::msg::Pose2D> & out_poses,
+  const rclcpp::Duration & transform_tolerance)
+{
+  if (source_frame == frame) {
+    out_poses.insert(out_poses.end(), begin, end);
+    return true;
+  }
+
+  geometry_msgs::msg::TransformStamped transform;
+  if (!lookupTransform(frame, source_frame, stamp, transform_tolerance, transform)) {
+    return false;
+  }
+
+  const auto & q = transform.transform.rotation;
+  const std::size_t offset = out_poses.size();
+  out_poses.resize(offset + std::distance(begin, end));
+  auto out = out_poses.begin() + offset;
+
+  // A transform between frames of the same plane is a rotation about the z axis,
+  // applied to all the poses as a 2D rotation and translation
+  if (std::abs(q.x) < 1e-9 && std::abs(q.y) < 1e-9) {
+    const double yaw = 2.0 * std::atan2(q.z, q.w);
+    const double cos_yaw = std::cos(yaw);
+    const double sin_yaw = std::sin(yaw);
+    const double tx = transform.transform.translation.x;
+    const double ty = transform.transform.translation.y;
+    for (auto it = begin; it != end; ++it, ++out) {
+      out->x = cos_yaw * it->x - sin_yaw * it->y + tx;
+      out->y = sin_yaw * it->x + cos_yaw * it->y + ty;
+      out->theta = std::remainder(it->theta + yaw, 2.0 * M_PI);
+    }
+    return true;
+  }
+
+  tf2::Transform tf2_transform;
+  tf2::fromMsg(transform.transform, tf2_transform);
+  tf2::Quaternion rotation;
+  for (auto it = begin; it != end; ++it, ++out) {
+    rotation.setRPY(0.0, 0.0, it->theta);
+    const tf2::Transform pose =
+      tf2_transform * tf2::Transform(rotation, tf2::Vector3(it->x, it->y, 0.0));
+    out->x = pose.getOrigin().x();
+    out->y = pose.getOrigin().y();
+    out->theta = tf2::getYaw(pose.getRotation());
+  }
+  return true;
+}
+
+bool TransformCache::transformPath(
+  const std::string & frame,
+  const nav_2d_msgs::msg::Path2D & in_path,
+  nav_2d_msgs::msg::Path2D & out_path,
+  const rclcpp::Duration & transform_tolerance)
+{
+  nav_2d_msgs::msg::Path2D path;
+  path.header.frame_id = frame;
+  path.header.stamp = in_path.header.stamp;
+  path.poses.reserve(in_path.poses.size());
+  if (!transformPoses(
+      frame, in_path.header.frame_id, in_path.header.stamp,
+      in_path.poses.begin(), in_path.poses.end(), path.poses, transform_tolerance))
+  {
+    return false;
+  }
+
+  out_path = std::move(path);
+  return true;
+}
+
 }  // namespace nav_2d_utils
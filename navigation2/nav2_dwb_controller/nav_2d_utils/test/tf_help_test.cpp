@@ -0,0 +1,218 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav_2d_utils/tf_help.hpp"
+#include "tf2/LinearMath/Quaternion.h"
+
+using nav_2d_utils::TransformCache;
+
+class TransformCacheWrapper : public TransformCache
+{
+public:
+  explicit TransformCacheWrapper(const std::shared_ptr<tf2_ros::Buffer> & tf)
+  : TransformCache(tf) {}
+
+  std::size_t size() const
+  {
+    return transforms_.size();
+  }
+};
+
+builtin_interfaces::msg::Time makeStamp(double seconds)
+{
+  return rclcpp::Time(std::llround(seconds * 1e9), RCL_ROS_TIME);
+}
+
+// A buffer with a single transform from odom to map, so lookups at any other time extrapolate
+std::shared_ptr<tf2_ros::Buffer> makeBuffer(
+  double x, double y, double roll, double pitch, double yaw, double seconds = 10.0)
+{
+  auto tf = std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>());
+  geometry_msgs::msg::TransformStamped transform;
+  transform.header.frame_id = "map";
+  transform.header.stamp = makeStamp(seconds);
+  transform.child_frame_id = "odom";
+  transform.transform.translation.x = x;
+  transform.transform.translation.y = y;
+  tf2::Quaternion q;
+  q.setRPY(roll, pitch, yaw);
+  transform.transform.rotation = tf2::toMsg(q);
+  tf->setTransform(transform, "test", false);
+  return tf;
+}
+
+nav_2d_msgs::msg::Pose2DStamped makePose(double x, double y, double theta, double seconds = 10.0)
+{
+  nav_2d_msgs::msg::Pose2DStamped pose;
+  pose.header.frame_id = "odom";
+  pose.header.stamp = makeStamp(seconds);
+  pose.pose.x = x;
+  pose.pose.y = y;
+  pose.pose.theta = theta;
+  return pose;
+}
+
+// Check the cached transform of the poses against the transform of each pose by the buffer
+void expectMatchesBuffer(const std::shared_ptr<tf2_ros::Buffer> & tf)
+{
+  TransformCache cache(tf);
+  rclcpp::Duration tolerance = rclcpp::Duration::from_seconds(0.1);
+  for (double x = -2.0; x <= 2.0; x += 0.5) {
+    for (double theta = -3.0; theta <= 3.0; theta += 0.75) {
+      const auto pose = makePose(x, 0.5 * x + 1.0, theta);
+      nav_2d_msgs::msg::Pose2DStamped expected, actual;
+      ASSERT_TRUE(nav_2d_utils::transformPose(tf, "map", pose, expected, tolerance));
+      ASSERT_TRUE(cache.transformPose("map", pose, actual, tolerance));
+      EXPECT_EQ(actual.header.frame_id, "map");
+      EXPECT_NEAR(actual.pose.x, expected.pose.x, 1e-6);
+      EXPECT_NEAR(actual.pose.y, expected.pose.y, 1e-6);
+      EXPECT_NEAR(std::remainder(actual.pose.theta - expected.pose.theta, 2.0 * M_PI), 0.0, 1e-6);
+      EXPECT_LE(std::abs(actual.pose.theta), M_PI);
+    }
+  }
+}
+
+TEST(TransformCache, HitAndMiss)
+{
+  auto tf = makeBuffer(1.0, 2.0, 0.0, 0.0, 0.5);
+  TransformCacheWrapper cache(tf);
+  const rclcpp::Duration tolerance = rclcpp::Duration::from_seconds(0.1);
+  geometry_msgs::msg::TransformStamped first, second;
+  ASSERT_TRUE(cache.lookupTransform("map", "odom", makeStamp(10.0), tolerance, first));
+  EXPECT_EQ(cache.size(), 1u);
+
+  // a hit does not look up the buffer again
+  tf->clear();
+  ASSERT_TRUE(cache.lookupTransform("map", "odom", makeStamp(10.0), tolerance, second));
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_EQ(second.transform.translation.x, first.transform.translation.x);
+  EXPECT_EQ(second.transform.rotation.z, first.transform.rotation.z);
+
+  // another time or pair of frames is a miss
+  EXPECT_FALSE(cache.lookupTransform("map", "odom", makeStamp(10.05), tolerance, second));
+  EXPECT_FALSE(cache.lookupTransform("odom", "map", makeStamp(10.0), tolerance, second));
+
+  // as is everything once cleared
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_FALSE(cache.lookupTransform("map", "odom", makeStamp(10.0), tolerance, second));
+}
+
+TEST(TransformCache, StampTolerance)
+{
+  auto tf = makeBuffer(1.0, 2.0, 0.0, 0.0, 0.5);
+  TransformCacheWrapper cache(tf);
+  rclcpp::Duration tolerance = rclcpp::Duration::from_seconds(0.1);
+  geometry_msgs::msg::TransformStamped transform;
+
+  // after the latest transform, within the tolerance of it
+  EXPECT_TRUE(cache.lookupTransform("map", "odom", makeStamp(10.05), tolerance, transform));
+  EXPECT_EQ(transform.header.stamp, makeStamp(10.0));
+  // too long after it
+  EXPECT_FALSE(cache.lookupTransform("map", "odom", makeStamp(10.5), tolerance, transform));
+  // before it, which falls back to the latest transform as well
+  EXPECT_TRUE(cache.lookupTransform("map", "odom", makeStamp(9.5), tolerance, transform));
+  // each stamp has its own entry, failures are not cached
+  EXPECT_EQ(cache.size(), 2u);
+
+  // the same as transforming a single pose with the buffer
+  for (double seconds : {9.5, 10.0, 10.05, 10.5}) {
+    nav_2d_msgs::msg::Pose2DStamped expected, actual;
+    const auto pose = makePose(1.0, 1.0, 0.0, seconds);
+    EXPECT_EQ(
+      nav_2d_utils::transformPose(tf, "map", pose, expected, tolerance),
+      cache.transformPose("map", pose, actual, tolerance)) << seconds << "s";
+  }
+}
+
+TEST(TransformCache, PlanarTransform)
+{
+  expectMatchesBuffer(makeBuffer(1.0, -2.0, 0.0, 0.0, 0.7));
+  expectMatchesBuffer(makeBuffer(-3.0, 0.5, 0.0, 0.0, -2.9));
+}
+
+TEST(TransformCache, FullTransform)
+{
+  expectMatchesBuffer(makeBuffer(1.0, -2.0, 0.3, 0.0, 0.7));
+  expectMatchesBuffer(makeBuffer(-3.0, 0.5, -0.2, 0.25, -2.9));
+}
+
+TEST(TransformCache, TransformPath)
+{
+  auto tf = makeBuffer(1.0, 2.0, 0.0, 0.0, 0.5);
+  TransformCache cache(tf);
+  const rclcpp::Duration tolerance = rclcpp::Duration::from_seconds(0.1);
+  nav_2d_msgs::msg::Path2D path, transformed;
+  path.header.frame_id = "odom";
+  path.header.stamp = makeStamp(10.0);
+  for (int i = 0; i != 10; i++) {
+    path.poses.push_back(makePose(0.1 * i, 0.05 * i, 0.1 * i).pose);
+  }
+
+  ASSERT_TRUE(cache.transformPath("map", path, transformed, tolerance));
+  EXPECT_EQ(transformed.header.frame_id, "map");
+  ASSERT_EQ(transformed.poses.size(), path.poses.size());
+  for (std::size_t i = 0; i != path.poses.size(); i++) {
+    nav_2d_msgs::msg::Pose2DStamped pose, expected;
+    pose.header = path.header;
+    pose.pose = path.poses[i];
+    ASSERT_TRUE(cache.transformPose("map", pose, expected, tolerance));
+    EXPECT_DOUBLE_EQ(transformed.poses[i].x, expected.pose.x);
+    EXPECT_DOUBLE_EQ(transformed.poses[i].y, expected.pose.y);
+    EXPECT_DOUBLE_EQ(transformed.poses[i].theta, expected.pose.theta);
+  }
+
+  // a path in the same frame is copied, without any transform
+  tf->clear();
+  path.header.frame_id = "map";
+  ASSERT_TRUE(cache.transformPath("map", path, transformed, tolerance));
+  ASSERT_EQ(transformed.poses.size(), path.poses.size());
+  for (std::size_t i = 0; i != path.poses.size(); i++) {
+    EXPECT_EQ(transformed.poses[i], path.poses[i]);
+  }
+
+  // and a failed transform leaves the output as it was
+  path.header.frame_id = "odom";
+  path.header.stamp = makeStamp(11.0);
+  transformed.poses.clear();
+  EXPECT_FALSE(cache.transformPath("map", path, transformed, tolerance));
+  EXPECT_TRUE(transformed.poses.empty());
+}
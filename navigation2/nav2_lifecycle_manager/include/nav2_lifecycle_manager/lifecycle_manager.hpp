@@ -131,6 +131,24 @@ protected:
    */
   bool changeStateForAllNodes(std::uint8_t transition);
 
+  /**
+   * @brief Transition the nodes one at a time, in the order of node_names, or reverse
+   * order when shutting down
+   */
+  bool changeStateForAllNodesInOrder(std::uint8_t transition);
+
+  /**
+   * @brief Transition the nodes concurrently, each one once the nodes it depends on
+   * have transitioned, or the nodes depending on it when shutting down
+   */
+  bool changeStateForAllNodesInParallel(std::uint8_t transition);
+
+  /**
+   * @brief Get the dependencies of each node and order the nodes by them
+   * @return false if the dependencies have a cycle
+   */
+  bool sortNodesByDependencies();
+
   // Convenience function to highlight the output on the console
   /**
    * @brief Helper function to highlight the output on the console
@@ -151,6 +169,16 @@ protected:
   // Whether to automatically start up the system
   bool autostart_;
 
+  // Whether to transition the nodes concurrently, only following their dependencies
+  bool parallel_transitions_;
+
+  // The nodes each node depends on, and the nodes depending on each node
+  std::map<std::string, std::vector<std::string>> node_dependencies_;
+  std::map<std::string, std::vector<std::string>> node_dependents_;
+
+  // The names of the nodes, ordered so that each node comes after its dependencies
+  std::vector<std::string> sorted_node_names_;
+
   bool system_active_{false};
 };
 
@@ -14,9 +14,14 @@
 
 #include "nav2_lifecycle_manager/lifecycle_manager.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <future>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rclcpp/rclcpp.hpp"
@@ -40,9 +45,18 @@ LifecycleManager::LifecycleManager()
   // of nodes
   declare_parameter("node_names");
   declare_parameter("autostart", rclcpp::ParameterValue(false));
+  declare_parameter("parallel_transitions", rclcpp::ParameterValue(false));
 
   node_names_ = get_parameter("node_names").as_string_array();
   get_parameter("autostart", autostart_);
+  get_parameter("parallel_transitions", parallel_transitions_);
+
+  if (parallel_transitions_ && !sortNodesByDependencies()) {
+    RCLCPP_ERROR(
+      get_logger(), "The node dependencies have a cycle, "
+      "transitioning the nodes one at a time in the order of node_names instead");
+    parallel_transitions_ = false;
+  }
 
   manager_srv_ = create_service<ManageLifecycleNodes>(
     get_name() + std::string("/manage_nodes"),
@@ -121,8 +135,13 @@ LifecycleManager::createLifecycleServiceClients()
 {
   message("Creating and initializing lifecycle service clients");
   for (auto & node_name : node_names_) {
-    node_map_[node_name] =
-      std::make_shared<LifecycleServiceClient>(node_name, service_client_node_);
+    if (parallel_transitions_) {
+      // The clients are spun concurrently, so each one needs a node of its own
+      node_map_[node_name] = std::make_shared<LifecycleServiceClient>(node_name);
+    } else {
+      node_map_[node_name] =
+        std::make_shared<LifecycleServiceClient>(node_name, service_client_node_);
+    }
   }
 }
 
@@ -135,22 +154,138 @@ LifecycleManager::destroyLifecycleServiceClients()
   }
 }
 
+bool
+LifecycleManager::sortNodesByDependencies()
+{
+  for (auto & node_name : node_names_) {
+    const std::string param_name = "dependencies." + node_name;
+    declare_parameter(param_name, rclcpp::ParameterValue(std::vector<std::string>()));
+    for (auto & dependency : get_parameter(param_name).as_string_array()) {
+      if (std::find(node_names_.begin(), node_names_.end(), dependency) == node_names_.end()) {
+        RCLCPP_WARN(
+          get_logger(), "Ignoring dependency of %s on %s, which is not a managed node",
+          node_name.c_str(), dependency.c_str());
+        continue;
+      }
+      node_dependencies_[node_name].push_back(dependency);
+      node_dependents_[dependency].push_back(node_name);
+    }
+  }
+
+  // Order the nodes so that each one comes after its dependencies, keeping the order
+  // of node_names otherwise
+  sorted_node_names_.clear();
+  std::set<std::string> sorted;
+  while (sorted_node_names_.size() != node_names_.size()) {
+    bool progress = false;
+    for (auto & node_name : node_names_) {
+      if (sorted.count(node_name)) {
+        continue;
+      }
+      const auto & dependencies = node_dependencies_[node_name];
+      if (std::all_of(
+          dependencies.begin(), dependencies.end(),
+          [&sorted](const std::string & dependency) {return sorted.count(dependency) > 0;}))
+      {
+        sorted_node_names_.push_back(node_name);
+        sorted.insert(node_name);
+        progress = true;
+      }
+    }
+    if (!progress) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool
 LifecycleManager::changeStateForNode(const std::string & node_name, std::uint8_t transition)
 {
-  message(transition_label_map_[transition] + node_name);
-  if (!node_map_[node_name]->change_state(transition) ||
-    !(node_map_[node_name]->get_state() == transition_state_map_[transition]))
+  message(transition_label_map_.at(transition) + node_name);
+  const auto start_time = std::chrono::steady_clock::now();
+  auto & client = node_map_.at(node_name);
+  if (!client->change_state(transition) ||
+    !(client->get_state() == transition_state_map_.at(transition)))
   {
     RCLCPP_ERROR(get_logger(), "Failed to change state for node: %s", node_name.c_str());
     return false;
   }
 
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+  RCLCPP_INFO(
+    get_logger(), "%s%s took %.3f s", transition_label_map_.at(transition).c_str(),
+    node_name.c_str(), elapsed.count());
   return true;
 }
 
+bool
+LifecycleManager::changeStateForAllNodesInParallel(std::uint8_t transition)
+{
+  const bool forward = transition == Transition::TRANSITION_CONFIGURE ||
+    transition == Transition::TRANSITION_ACTIVATE;
+
+  // Each node waits for the nodes it depends on to transition, or for the nodes
+  // depending on it when going down
+  using Prerequisite = std::pair<std::string, std::shared_future<bool>>;
+  std::map<std::string, std::shared_future<bool>> results;
+  auto transition_node = [this, transition](
+    const std::string & node_name, std::vector<Prerequisite> prerequisites) {
+      for (auto & prerequisite : prerequisites) {
+        if (!prerequisite.second.get()) {
+          RCLCPP_ERROR(
+            get_logger(), "Skipping the transition of %s, since %s failed to transition",
+            node_name.c_str(), prerequisite.first.c_str());
+          return false;
+        }
+      }
+      return changeStateForNode(node_name, transition);
+    };
+
+  auto launch_node = [&](const std::string & node_name) {
+      const auto & prerequisite_names =
+        forward ? node_dependencies_[node_name] : node_dependents_[node_name];
+      std::vector<Prerequisite> prerequisites;
+      for (auto & prerequisite_name : prerequisite_names) {
+        prerequisites.emplace_back(prerequisite_name, results.at(prerequisite_name));
+      }
+      results[node_name] =
+        std::async(std::launch::async, transition_node, node_name, prerequisites).share();
+    };
+
+  if (forward) {
+    std::for_each(sorted_node_names_.begin(), sorted_node_names_.end(), launch_node);
+  } else {
+    std::for_each(sorted_node_names_.rbegin(), sorted_node_names_.rend(), launch_node);
+  }
+
+  bool success = true;
+  for (auto & result : results) {
+    success = result.second.get() && success;
+  }
+  return success;
+}
+
 bool
 LifecycleManager::changeStateForAllNodes(std::uint8_t transition)
+{
+  const auto start_time = std::chrono::steady_clock::now();
+  const bool success = parallel_transitions_ ?
+    changeStateForAllNodesInParallel(transition) :
+    changeStateForAllNodesInOrder(transition);
+
+  if (success) {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    RCLCPP_INFO(
+      get_logger(), "%sall nodes took %.3f s", transition_label_map_.at(transition).c_str(),
+      elapsed.count());
+  }
+  return success;
+}
+
+bool
+LifecycleManager::changeStateForAllNodesInOrder(std::uint8_t transition)
 {
   if (transition == Transition::TRANSITION_CONFIGURE ||
     transition == Transition::TRANSITION_ACTIVATE)
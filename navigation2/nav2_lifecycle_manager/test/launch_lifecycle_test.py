@@ -33,6 +33,42 @@ def generate_launch_description():
             parameters=[{'use_sim_time': False},
                         {'autostart': False},
                         {'node_names': ['lifecycle_node_test']}]),
+        Node(
+            package='nav2_lifecycle_manager',
+            executable='lifecycle_manager',
+            name='lifecycle_manager_parallel_test',
+            output='screen',
+            parameters=[{'use_sim_time': False},
+                        {'autostart': False},
+                        {'parallel_transitions': True},
+                        {'node_names': ['lifecycle_node_dependent', 'lifecycle_node_base',
+                                        'lifecycle_node_independent']},
+                        {'dependencies': {
+                            'lifecycle_node_dependent': ['lifecycle_node_base']}}]),
+        Node(
+            package='nav2_lifecycle_manager',
+            executable='lifecycle_manager',
+            name='lifecycle_manager_failure_test',
+            output='screen',
+            parameters=[{'use_sim_time': False},
+                        {'autostart': False},
+                        {'parallel_transitions': True},
+                        {'node_names': ['lifecycle_node_failing',
+                                        'lifecycle_node_after_failing']},
+                        {'dependencies': {
+                            'lifecycle_node_after_failing': ['lifecycle_node_failing']}}]),
+        Node(
+            package='nav2_lifecycle_manager',
+            executable='lifecycle_manager',
+            name='lifecycle_manager_cycle_test',
+            output='screen',
+            parameters=[{'use_sim_time': False},
+                        {'autostart': False},
+                        {'parallel_transitions': True},
+                        {'node_names': ['lifecycle_node_cycle_a', 'lifecycle_node_cycle_b']},
+                        {'dependencies': {
+                            'lifecycle_node_cycle_a': ['lifecycle_node_cycle_b'],
+                            'lifecycle_node_cycle_b': ['lifecycle_node_cycle_a']}}]),
     ])
 
 
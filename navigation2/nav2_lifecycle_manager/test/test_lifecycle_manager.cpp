@@ -13,8 +13,13 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
 #include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "nav2_util/node_thread.hpp"
@@ -22,38 +27,75 @@
 
 using CallbackReturn = rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn;
 
+// The transitions of all test nodes, as "<node name> <transition>", in the order they happened
+std::mutex g_transitions_mutex;
+std::vector<std::string> g_transitions;
+
+void recordTransition(const std::string & node_name, const std::string & transition)
+{
+  std::lock_guard<std::mutex> lock(g_transitions_mutex);
+  g_transitions.push_back(node_name + " " + transition);
+}
+
+// Position of a transition in g_transitions, or its size if it did not happen
+size_t transitionIndex(const std::string & node_name, const std::string & transition)
+{
+  std::lock_guard<std::mutex> lock(g_transitions_mutex);
+  return std::find(
+    g_transitions.begin(), g_transitions.end(),
+    node_name + " " + transition) - g_transitions.begin();
+}
+
+bool hasTransitioned(const std::string & node_name, const std::string & transition)
+{
+  std::lock_guard<std::mutex> lock(g_transitions_mutex);
+  return std::find(
+    g_transitions.begin(), g_transitions.end(),
+    node_name + " " + transition) != g_transitions.end();
+}
+
 class LifecycleNodeTest : public rclcpp_lifecycle::LifecycleNode
 {
 public:
-  LifecycleNodeTest()
-  : rclcpp_lifecycle::LifecycleNode("lifecycle_node_test") {}
+  explicit LifecycleNodeTest(
+    const std::string & node_name = "lifecycle_node_test", bool fail_configure = false)
+  : rclcpp_lifecycle::LifecycleNode(node_name), fail_configure_(fail_configure) {}
 
   CallbackReturn on_configure(const rclcpp_lifecycle::State & /*state*/) override
   {
+    onTransition("configure");
+    if (fail_configure_) {
+      RCLCPP_INFO(get_logger(), "Lifecycle Test node failed to configure!");
+      return CallbackReturn::FAILURE;
+    }
     RCLCPP_INFO(get_logger(), "Lifecycle Test node is Configured!");
     return CallbackReturn::SUCCESS;
   }
 
   CallbackReturn on_activate(const rclcpp_lifecycle::State & /*state*/) override
   {
+    onTransition("activate");
     RCLCPP_INFO(get_logger(), "Lifecycle Test node is Activated!");
     return CallbackReturn::SUCCESS;
   }
 
   CallbackReturn on_deactivate(const rclcpp_lifecycle::State & /*state*/) override
   {
+    onTransition("deactivate");
     RCLCPP_INFO(get_logger(), "Lifecycle Test node is Deactivated!");
     return CallbackReturn::SUCCESS;
   }
 
   CallbackReturn on_cleanup(const rclcpp_lifecycle::State & /*state*/) override
   {
+    onTransition("cleanup");
     RCLCPP_INFO(get_logger(), "Lifecycle Test node is Cleanup!");
     return CallbackReturn::SUCCESS;
   }
 
   CallbackReturn on_shutdown(const rclcpp_lifecycle::State & /*state*/) override
   {
+    onTransition("shutdown");
     RCLCPP_INFO(get_logger(), "Lifecycle Test node is Shutdown!");
     return CallbackReturn::SUCCESS;
   }
@@ -63,6 +105,16 @@ public:
     RCLCPP_INFO(get_logger(), "Lifecycle Test node is encountered an error!");
     return CallbackReturn::SUCCESS;
   }
+
+protected:
+  // Take a while for each transition, so that nodes transitioned concurrently overlap
+  void onTransition(const std::string & transition)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    recordTransition(get_name(), transition);
+  }
+
+  bool fail_configure_;
 };
 
 class LifecycleClientTestFixture
@@ -79,6 +131,23 @@ private:
   std::unique_ptr<nav2_util::NodeThread> lf_thread_;
 };
 
+// Test nodes spun on their own threads, as the lifecycle managers transition them concurrently
+class LifecycleNodesTestFixture
+{
+public:
+  explicit LifecycleNodesTestFixture(const std::vector<std::shared_ptr<LifecycleNodeTest>> & nodes)
+  : nodes_(nodes)
+  {
+    for (auto & node : nodes_) {
+      threads_.push_back(std::make_unique<nav2_util::NodeThread>(node->get_node_base_interface()));
+    }
+  }
+
+private:
+  std::vector<std::shared_ptr<LifecycleNodeTest>> nodes_;
+  std::vector<std::unique_ptr<nav2_util::NodeThread>> threads_;
+};
+
 TEST(LifecycleClientTest, BasicTest)
 {
   LifecycleClientTestFixture fix;
@@ -110,6 +179,78 @@ TEST(LifecycleClientTest, WithoutFixture)
     client.is_active(std::chrono::nanoseconds(1000)));
 }
 
+TEST(LifecycleClientTest, ParallelTransitions)
+{
+  LifecycleNodesTestFixture fix({
+      std::make_shared<LifecycleNodeTest>("lifecycle_node_dependent"),
+      std::make_shared<LifecycleNodeTest>("lifecycle_node_base"),
+      std::make_shared<LifecycleNodeTest>("lifecycle_node_independent")});
+  nav2_lifecycle_manager::LifecycleManagerClient client("lifecycle_manager_parallel_test");
+
+  // the dependent node comes up after the node it depends on, though listed before it
+  EXPECT_TRUE(client.startup());
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_base", "configure"),
+    transitionIndex("lifecycle_node_dependent", "configure"));
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_base", "activate"),
+    transitionIndex("lifecycle_node_dependent", "activate"));
+  EXPECT_TRUE(hasTransitioned("lifecycle_node_independent", "activate"));
+
+  // and goes down before it
+  EXPECT_TRUE(client.shutdown());
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_dependent", "deactivate"),
+    transitionIndex("lifecycle_node_base", "deactivate"));
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_dependent", "cleanup"),
+    transitionIndex("lifecycle_node_base", "cleanup"));
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_dependent", "shutdown"),
+    transitionIndex("lifecycle_node_base", "shutdown"));
+}
+
+TEST(LifecycleClientTest, ParallelTransitionsFailure)
+{
+  LifecycleNodesTestFixture fix({
+      std::make_shared<LifecycleNodeTest>("lifecycle_node_failing", true),
+      std::make_shared<LifecycleNodeTest>("lifecycle_node_after_failing")});
+  nav2_lifecycle_manager::LifecycleManagerClient client("lifecycle_manager_failure_test");
+
+  // the node depending on the failed one is not transitioned at all
+  EXPECT_FALSE(client.startup());
+  EXPECT_TRUE(hasTransitioned("lifecycle_node_failing", "configure"));
+  EXPECT_FALSE(hasTransitioned("lifecycle_node_after_failing", "configure"));
+}
+
+TEST(LifecycleClientTest, ParallelTransitionsCycle)
+{
+  LifecycleNodesTestFixture fix({
+      std::make_shared<LifecycleNodeTest>("lifecycle_node_cycle_a"),
+      std::make_shared<LifecycleNodeTest>("lifecycle_node_cycle_b")});
+  nav2_lifecycle_manager::LifecycleManagerClient client("lifecycle_manager_cycle_test");
+
+  // the nodes are transitioned one at a time in the order of node_names instead
+  EXPECT_TRUE(client.startup());
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_cycle_a", "configure"),
+    transitionIndex("lifecycle_node_cycle_b", "configure"));
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_cycle_b", "configure"),
+    transitionIndex("lifecycle_node_cycle_a", "activate"));
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_cycle_a", "activate"),
+    transitionIndex("lifecycle_node_cycle_b", "activate"));
+
+  EXPECT_TRUE(client.shutdown());
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_cycle_b", "deactivate"),
+    transitionIndex("lifecycle_node_cycle_a", "deactivate"));
+  EXPECT_LT(
+    transitionIndex("lifecycle_node_cycle_a", "deactivate"),
+    transitionIndex("lifecycle_node_cycle_b", "cleanup"));
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -85,7 +85,30 @@ public:
     const geometry_msgs::msg::PoseStamped & start,
     const geometry_msgs::msg::PoseStamped & goal) override;
 
+  /**
+   * @brief Creating plans from a start pose to many goal poses, all extracted
+   * from a single potential propagated from the start
+   * @param start Start pose
+   * @param goals Goal poses
+   * @return nav_msgs::Path of the generated path to each goal, empty if it failed
+   */
+  std::vector<nav_msgs::msg::Path> createPlans(
+    const geometry_msgs::msg::PoseStamped & start,
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals) override;
+
+  /**
+   * @brief NavFn plans on its own copy of a costmap snapshot, so its instances can
+   * plan concurrently
+   * @return true
+   */
+  bool isReentrant() const override {return true;}
+
 protected:
+  /**
+   * @brief Take the last snapshot of the costmap to plan on
+   */
+  void updateCostmapSnapshot();
+
   /**
    * @brief Compute a plan given start and goal poses, provided in global world frame.
    * @param start Start pose
@@ -106,6 +129,18 @@ protected:
    */
   bool computePotential(const geometry_msgs::msg::Point & world_point);
 
+  /**
+   * @brief Compute a plan to a goal, or to the reachable pose closest to it within
+   * the tolerance, from a potential - must call computePotential first
+   * @param goal Goal pose
+   * @param tolerance Relaxation constraint in x and y
+   * @param plan Path to be computed
+   * @return true if can compute a plan path
+   */
+  bool getPlanToGoal(
+    const geometry_msgs::msg::Pose & goal, double tolerance,
+    nav_msgs::msg::Path & plan);
+
   /**
    * @brief Compute a plan to a goal from a potential - must call computePotential first
    * @param goal Goal pose
@@ -174,7 +209,8 @@ protected:
   void mapToWorld(double mx, double my, double & wx, double & wy);
 
   /**
-   * @brief Set the corresponding cell cost to be free space
+   * @brief Set the corresponding cell cost to be free space in the NavFn cost array,
+   * must call setCostmap on the planner first
    * @param mx int of map X coordinate
    * @param my int of map Y coordinate
    */
@@ -196,7 +232,11 @@ protected:
   nav2_util::LifecycleNode::SharedPtr node_;
 
   // Global Costmap
-  nav2_costmap_2d::Costmap2D * costmap_;
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros_;
+
+  // Snapshot of the global costmap planned on, and its costmap
+  std::shared_ptr<const nav2_costmap_2d::CostmapSnapshot> snapshot_;
+  const nav2_costmap_2d::Costmap2D * costmap_;
 
   // The global frame of the costmap
   std::string global_frame_, name_;
@@ -67,6 +67,7 @@ NavfnPlanner::configure(
   node_ = parent;
   tf_ = tf;
   name_ = name;
+  costmap_ros_ = costmap_ros;
   costmap_ = costmap_ros->getCostmap();
   global_frame_ = costmap_ros->getGlobalFrameID();
 
@@ -124,6 +125,41 @@ NavfnPlanner::cleanup()
   planner_.reset();
 }
 
+std::vector<nav_msgs::msg::Path> NavfnPlanner::createPlans(
+  const geometry_msgs::msg::PoseStamped & start,
+  const std::vector<geometry_msgs::msg::PoseStamped> & goals)
+{
+  updateCostmapSnapshot();
+
+  // Update planner based on the new costmap size
+  if (isPlannerOutOfDate()) {
+    planner_->setNavArr(
+      costmap_->getSizeInCellsX(),
+      costmap_->getSizeInCellsY());
+  }
+
+  std::vector<nav_msgs::msg::Path> paths(goals.size());
+  for (auto & path : paths) {
+    path.header.stamp = node_->now();
+    path.header.frame_id = global_frame_;
+  }
+
+  // A single expansion from the start serves all of the goals
+  if (!computePotential(start.pose.position)) {
+    return paths;
+  }
+
+  for (unsigned int i = 0; i != goals.size(); i++) {
+    if (!getPlanToGoal(goals[i].pose, tolerance_, paths[i])) {
+      RCLCPP_WARN(
+        node_->get_logger(), "%s: failed to create plan to goal %u with "
+        "tolerance %.2f.", name_.c_str(), i, tolerance_);
+    }
+  }
+
+  return paths;
+}
+
 nav_msgs::msg::Path NavfnPlanner::createPlan(
   const geometry_msgs::msg::PoseStamped & start,
   const geometry_msgs::msg::PoseStamped & goal)
@@ -132,6 +168,8 @@ nav_msgs::msg::Path NavfnPlanner::createPlan(
   steady_clock::time_point a = steady_clock::now();
 #endif
 
+  updateCostmapSnapshot();
+
   // Update planner based on the new costmap size
   if (isPlannerOutOfDate()) {
     planner_->setNavArr(
@@ -157,6 +195,13 @@ nav_msgs::msg::Path NavfnPlanner::createPlan(
   return path;
 }
 
+void
+NavfnPlanner::updateCostmapSnapshot()
+{
+  snapshot_ = costmap_ros_->getCostmapSnapshot();
+  costmap_ = &snapshot_->costmap;
+}
+
 bool
 NavfnPlanner::isPlannerOutOfDate()
 {
@@ -200,11 +245,6 @@ NavfnPlanner::makePlan(
     return false;
   }
 
-  // clear the starting cell within the costmap because we know it can't be an obstacle
-  clearRobotCell(mx, my);
-
-  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
-
   // make sure to resize the underlying array that Navfn uses
   planner_->setNavArr(
     costmap_->getSizeInCellsX(),
@@ -212,7 +252,8 @@ NavfnPlanner::makePlan(
 
   planner_->setCostmap(costmap_->getCharMap(), true, allow_unknown_);
 
-  lock.unlock();
+  // clear the starting cell within the costmap because we know it can't be an obstacle
+  clearRobotCell(mx, my);
 
   int map_start[2];
   map_start[0] = mx;
@@ -244,6 +285,49 @@ NavfnPlanner::makePlan(
     planner_->calcNavFnDijkstra(true);
   }
 
+  return getPlanToGoal(goal, tolerance, plan);
+}
+
+bool
+NavfnPlanner::computePotential(const geometry_msgs::msg::Point & world_point)
+{
+  unsigned int mx, my;
+  if (!worldToMap(world_point.x, world_point.y, mx, my)) {
+    RCLCPP_WARN(
+      node_->get_logger(),
+      "Cannot compute the potential: the start position is off the global costmap.");
+    return false;
+  }
+
+  // make sure to resize the underlying array that Navfn uses
+  planner_->setNavArr(
+    costmap_->getSizeInCellsX(),
+    costmap_->getSizeInCellsY());
+
+  planner_->setCostmap(costmap_->getCharMap(), true, allow_unknown_);
+
+  // clear the starting cell within the costmap because we know it can't be an obstacle
+  clearRobotCell(mx, my);
+
+  int map_start[2];
+  map_start[0] = mx;
+  map_start[1] = my;
+
+  // the potential is propagated from the start over the whole costmap, so that the
+  // plans to any goal can be extracted from it. A* has no single goal to head to
+  planner_->setStart(map_start);
+  planner_->setGoal(map_start);
+  // as for a single goal, the goals are checked against the potential even if the
+  // propagation ran out of cycles
+  planner_->calcNavFnDijkstra(false);
+  return true;
+}
+
+bool
+NavfnPlanner::getPlanToGoal(
+  const geometry_msgs::msg::Pose & goal, double tolerance,
+  nav_msgs::msg::Path & plan)
+{
   double resolution = costmap_->getResolution();
   geometry_msgs::msg::Pose p, best_pose;
 
@@ -460,9 +544,8 @@ NavfnPlanner::mapToWorld(double mx, double my, double & wx, double & wy)
 void
 NavfnPlanner::clearRobotCell(unsigned int mx, unsigned int my)
 {
-  // TODO(orduno): check usage of this function, might instead be a request to
-  //               world_model / map server
-  costmap_->setCost(mx, my, nav2_costmap_2d::FREE_SPACE);
+  // only in our copy of the costmap, which other planners do not read
+  planner_->costarr[my * planner_->nx + mx] = COST_NEUTRAL;
 }
 
 void
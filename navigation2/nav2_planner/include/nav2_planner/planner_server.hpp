@@ -18,6 +18,7 @@
 #include <chrono>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 
@@ -26,6 +27,7 @@
 #include "nav_msgs/msg/path.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_msgs/action/compute_path_to_pose.hpp"
+#include "nav2_msgs/action/compute_paths_to_poses.hpp"
 #include "nav2_msgs/msg/costmap.hpp"
 #include "nav2_util/robot_utils.hpp"
 #include "nav2_util/simple_action_server.hpp"
@@ -57,9 +59,12 @@ public:
   ~PlannerServer();
 
   using PlannerMap = std::unordered_map<std::string, nav2_core::GlobalPlanner::Ptr>;
+  using BatchPlannerMap =
+    std::unordered_map<std::string, std::vector<nav2_core::GlobalPlanner::Ptr>>;
 
   /**
-   * @brief Method to get plan from the desired plugin
+   * @brief Method to get plan from the desired plugin. If the plugin is not reentrant,
+   * the plan waits for the batch plans running on such plugins to finish
    * @param start starting pose
    * @param goal goal request
    * @return Path
@@ -69,6 +74,19 @@ public:
     const geometry_msgs::msg::PoseStamped & goal,
     const std::string & planner_id);
 
+  /**
+   * @brief Method to get plans to many goals from the desired plugin. If the plugin is
+   * reentrant, the goals are split between its batch instances, which plan concurrently,
+   * else they are planned in turn on the instance serving getPlan
+   * @param start starting pose
+   * @param goals goal requests
+   * @return Path to each goal, empty if it failed
+   */
+  std::vector<nav_msgs::msg::Path> getPlans(
+    const geometry_msgs::msg::PoseStamped & start,
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+    const std::string & planner_id);
+
 protected:
   /**
    * @brief Configure member variables and initializes planner
@@ -107,11 +125,30 @@ protected:
   // Our action server implements the ComputePathToPose action
   std::unique_ptr<ActionServer> action_server_;
 
+  using BatchActionT = nav2_msgs::action::ComputePathsToPoses;
+  using BatchActionServer = nav2_util::SimpleActionServer<BatchActionT>;
+
+  // Our batch action server implements the ComputePathsToPoses action
+  std::unique_ptr<BatchActionServer> batch_action_server_;
+
   /**
    * @brief The action server callback which calls planner to get the path
    */
   void computePlan();
 
+  /**
+   * @brief The batch action server callback which calls planners to get the paths
+   */
+  void computePlans();
+
+  /**
+   * @brief Get the batch instances of a reentrant planner, creating them on first use
+   * @param planner_id Name of the planner
+   * @return The instances of the planner, one per batch planner thread
+   */
+  const std::vector<nav2_core::GlobalPlanner::Ptr> & getBatchPlanners(
+    const std::string & planner_id);
+
   /**
    * @brief Publish a path for visualization purposes
    * @param path Reference to Global Path
@@ -128,6 +165,13 @@ protected:
   double max_planner_duration_;
   std::string planner_ids_concat_;
 
+  // Instances of each reentrant planner serving the batch action, one per worker thread
+  BatchPlannerMap batch_planners_;
+  int batch_planner_threads_;
+
+  // Serializes the plans of the planners which are not reentrant, across both actions
+  std::mutex non_reentrant_mutex_;
+
   // Clock
   rclcpp::Clock steady_clock_{RCL_STEADY_TIME};
 
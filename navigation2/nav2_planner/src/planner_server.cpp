@@ -13,12 +13,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <utility>
@@ -47,6 +50,7 @@ PlannerServer::PlannerServer()
   // Declare this node's parameters
   declare_parameter("planner_plugins", default_ids_);
   declare_parameter("expected_planner_frequency", 1.0);
+  declare_parameter("batch_planner_threads", 1);
 
   // Setup the global costmap
   costmap_ros_ = std::make_shared<nav2_costmap_2d::Costmap2DROS>(
@@ -60,6 +64,7 @@ PlannerServer::~PlannerServer()
 {
   RCLCPP_INFO(get_logger(), "Destroying");
   planners_.clear();
+  batch_planners_.clear();
   costmap_thread_.reset();
 }
 
@@ -85,6 +90,14 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
   }
   planner_types_.resize(planner_ids_.size());
 
+  get_parameter("batch_planner_threads", batch_planner_threads_);
+  if (batch_planner_threads_ < 1) {
+    RCLCPP_WARN(
+      get_logger(), "The batch planner threads parameter is %d, using a single thread.",
+      batch_planner_threads_);
+    batch_planner_threads_ = 1;
+  }
+
   auto node = shared_from_this();
 
   for (size_t i = 0; i != planner_ids_.size(); i++) {
@@ -135,6 +148,12 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
     "compute_path_to_pose",
     std::bind(&PlannerServer::computePlan, this));
 
+  // Create the action server that we implement with our computePlans method
+  batch_action_server_ = std::make_unique<BatchActionServer>(
+    rclcpp_node_,
+    "compute_paths_to_poses",
+    std::bind(&PlannerServer::computePlans, this));
+
   return nav2_util::CallbackReturn::SUCCESS;
 }
 
@@ -145,12 +164,18 @@ PlannerServer::on_activate(const rclcpp_lifecycle::State & /*state*/)
 
   plan_publisher_->on_activate();
   action_server_->activate();
+  batch_action_server_->activate();
   costmap_ros_->activate();
 
   PlannerMap::iterator it;
   for (it = planners_.begin(); it != planners_.end(); ++it) {
     it->second->activate();
   }
+  for (auto & batch_planners : batch_planners_) {
+    for (auto & planner : batch_planners.second) {
+      planner->activate();
+    }
+  }
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -161,6 +186,7 @@ PlannerServer::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
   RCLCPP_INFO(get_logger(), "Deactivating");
 
   action_server_->deactivate();
+  batch_action_server_->deactivate();
   plan_publisher_->on_deactivate();
   costmap_ros_->deactivate();
 
@@ -168,6 +194,11 @@ PlannerServer::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
   for (it = planners_.begin(); it != planners_.end(); ++it) {
     it->second->deactivate();
   }
+  for (auto & batch_planners : batch_planners_) {
+    for (auto & planner : batch_planners.second) {
+      planner->deactivate();
+    }
+  }
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -178,6 +209,7 @@ PlannerServer::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
   RCLCPP_INFO(get_logger(), "Cleaning up");
 
   action_server_.reset();
+  batch_action_server_.reset();
   plan_publisher_.reset();
   tf_.reset();
   costmap_ros_->cleanup();
@@ -187,6 +219,12 @@ PlannerServer::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
     it->second->cleanup();
   }
   planners_.clear();
+  for (auto & batch_planners : batch_planners_) {
+    for (auto & planner : batch_planners.second) {
+      planner->cleanup();
+    }
+  }
+  batch_planners_.clear();
   costmap_ = nullptr;
 
   return nav2_util::CallbackReturn::SUCCESS;
@@ -272,6 +310,67 @@ PlannerServer::computePlan()
   }
 }
 
+void
+PlannerServer::computePlans()
+{
+  auto start_time = steady_clock_.now();
+
+  // Initialize the ComputePathsToPoses goal and result
+  auto goal = batch_action_server_->get_current_goal();
+  auto result = std::make_shared<BatchActionT::Result>();
+
+  try {
+    if (batch_action_server_ == nullptr || !batch_action_server_->is_server_active()) {
+      RCLCPP_DEBUG(get_logger(), "Batch action server unavailable or inactive. Stopping.");
+      return;
+    }
+
+    if (batch_action_server_->is_cancel_requested()) {
+      RCLCPP_INFO(get_logger(), "Goal was canceled. Canceling batch planning action.");
+      batch_action_server_->terminate_all();
+      return;
+    }
+
+    geometry_msgs::msg::PoseStamped start;
+    if (!costmap_ros_->getRobotPose(start)) {
+      batch_action_server_->terminate_current();
+      return;
+    }
+
+    if (batch_action_server_->is_preempt_requested()) {
+      goal = batch_action_server_->accept_pending_goal();
+    }
+
+    result->paths = getPlans(start, goal->goals, goal->planner_id);
+
+    // Goals that cannot be reached keep an empty path, the action only fails if none can
+    if (std::all_of(
+        result->paths.begin(), result->paths.end(),
+        [](const nav_msgs::msg::Path & path) {return path.poses.empty();}))
+    {
+      RCLCPP_WARN(
+        get_logger(), "Planning algorithm %s failed to generate a valid"
+        " path to any of the %zu goals", goal->planner_id.c_str(), goal->goals.size());
+      batch_action_server_->terminate_current();
+      return;
+    }
+
+    auto cycle_duration = steady_clock_.now() - start_time;
+    result->planning_time = cycle_duration;
+
+    RCLCPP_DEBUG(
+      get_logger(), "Found paths to %zu goals in %.4f s",
+      goal->goals.size(), cycle_duration.seconds());
+
+    batch_action_server_->succeeded_current(result);
+  } catch (std::exception & ex) {
+    RCLCPP_WARN(
+      get_logger(), "%s plugin failed to plan calculation to %zu goals: \"%s\"",
+      goal->planner_id.c_str(), goal->goals.size(), ex.what());
+    batch_action_server_->terminate_current();
+  }
+}
+
 nav_msgs::msg::Path
 PlannerServer::getPlan(
   const geometry_msgs::msg::PoseStamped & start,
@@ -283,24 +382,118 @@ PlannerServer::getPlan(
     "(%.2f, %.2f).", start.pose.position.x, start.pose.position.y,
     goal.pose.position.x, goal.pose.position.y);
 
-  if (planners_.find(planner_id) != planners_.end()) {
-    return planners_[planner_id]->createPlan(start, goal);
-  } else {
-    if (planners_.size() == 1 && planner_id.empty()) {
+  std::string id = planner_id;
+  if (planners_.find(id) == planners_.end()) {
+    if (planners_.size() == 1 && id.empty()) {
       RCLCPP_WARN_ONCE(
         get_logger(), "No planners specified in action call. "
         "Server will use only plugin %s in server."
         " This warning will appear once.", planner_ids_concat_.c_str());
-      return planners_[planners_.begin()->first]->createPlan(start, goal);
+      id = planners_.begin()->first;
     } else {
       RCLCPP_ERROR(
         get_logger(), "planner %s is not a valid planner. "
         "Planner names are: %s", planner_id.c_str(),
         planner_ids_concat_.c_str());
+      return nav_msgs::msg::Path();
     }
   }
 
-  return nav_msgs::msg::Path();
+  // A planner which is not reentrant may share state with the batch planners
+  const auto & planner = planners_[id];
+  std::unique_lock<std::mutex> lock(non_reentrant_mutex_, std::defer_lock);
+  if (!planner->isReentrant()) {
+    lock.lock();
+  }
+  return planner->createPlan(start, goal);
+}
+
+std::vector<nav_msgs::msg::Path>
+PlannerServer::getPlans(
+  const geometry_msgs::msg::PoseStamped & start,
+  const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+  const std::string & planner_id)
+{
+  RCLCPP_DEBUG(
+    get_logger(), "Attempting to a find paths from (%.2f, %.2f) to %zu goals.",
+    start.pose.position.x, start.pose.position.y, goals.size());
+
+  std::string id = planner_id;
+  if (planners_.find(id) == planners_.end()) {
+    if (planners_.size() == 1 && id.empty()) {
+      id = planners_.begin()->first;
+    } else {
+      RCLCPP_ERROR(
+        get_logger(), "planner %s is not a valid planner. "
+        "Planner names are: %s", planner_id.c_str(),
+        planner_ids_concat_.c_str());
+      return std::vector<nav_msgs::msg::Path>(goals.size());
+    }
+  }
+
+  // A planner which is not reentrant plans the batch on the instance of the other action
+  const auto & planner = planners_[id];
+  if (!planner->isReentrant()) {
+    std::lock_guard<std::mutex> lock(non_reentrant_mutex_);
+    return planner->createPlans(start, goals);
+  }
+
+  const auto & planners = getBatchPlanners(id);
+
+  // Split the goals in contiguous chunks, one per instance of the planner
+  const size_t workers = std::min(planners.size(), goals.size());
+  if (workers <= 1) {
+    return planners.front()->createPlans(start, goals);
+  }
+
+  std::vector<std::future<std::vector<nav_msgs::msg::Path>>> futures;
+  for (size_t i = 0; i != workers; i++) {
+    const std::vector<geometry_msgs::msg::PoseStamped> chunk(
+      goals.begin() + goals.size() * i / workers,
+      goals.begin() + goals.size() * (i + 1) / workers);
+    futures.push_back(
+      std::async(
+        std::launch::async, [&start, planner = planners[i], chunk]() {
+          return planner->createPlans(start, chunk);
+        }));
+  }
+
+  std::vector<nav_msgs::msg::Path> paths;
+  paths.reserve(goals.size());
+  for (auto & future : futures) {
+    auto chunk_paths = future.get();
+    paths.insert(paths.end(), chunk_paths.begin(), chunk_paths.end());
+  }
+
+  return paths;
+}
+
+const std::vector<nav2_core::GlobalPlanner::Ptr> &
+PlannerServer::getBatchPlanners(const std::string & planner_id)
+{
+  auto & planners = batch_planners_[planner_id];
+  if (!planners.empty()) {
+    return planners;
+  }
+
+  // The instances are only created once the batch action is used with the planner
+  auto node = shared_from_this();
+  const auto id_it = std::find(planner_ids_.begin(), planner_ids_.end(), planner_id);
+  const std::string & type = planner_types_[id_it - planner_ids_.begin()];
+  std::vector<nav2_core::GlobalPlanner::Ptr> instances;
+  for (int i = 0; i != batch_planner_threads_; i++) {
+    nav2_core::GlobalPlanner::Ptr planner = gp_loader_.createUniqueInstance(type);
+    planner->configure(node, planner_id, tf_, costmap_ros_);
+    planner->activate();
+    instances.push_back(planner);
+  }
+
+  RCLCPP_INFO(
+    get_logger(), "Created %d batch instances of global planner plugin %s of type %s",
+    batch_planner_threads_, planner_id.c_str(), type.c_str());
+
+  planners = std::move(instances);
+  return planners;
 }
 
 void
@@ -0,0 +1,213 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+#include "geometry_msgs/msg/transform_stamped.hpp"
+#include "nav2_msgs/action/compute_paths_to_poses.hpp"
+#include "nav2_planner/planner_server.hpp"
+
+using BatchAction = nav2_msgs::action::ComputePathsToPoses;
+using ClientGoalHandle = rclcpp_action::ClientGoalHandle<BatchAction>;
+
+using namespace std::chrono_literals;
+
+// A planner failing to plan to the goals behind the start, else planning straight to them
+
+class DummyPlanner : public nav2_core::GlobalPlanner
+{
+public:
+  void configure(
+    rclcpp_lifecycle::LifecycleNode::SharedPtr, std::string,
+    std::shared_ptr<tf2_ros::Buffer>, std::shared_ptr<nav2_costmap_2d::Costmap2DROS>) override
+  {}
+
+  void cleanup() override {}
+
+  void activate() override {}
+
+  void deactivate() override {}
+
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal) override
+  {
+    nav_msgs::msg::Path path;
+    if (goal.pose.position.x >= start.pose.position.x) {
+      path.poses.push_back(start);
+      path.poses.push_back(goal);
+    }
+    return path;
+  }
+
+  bool isReentrant() const override
+  {
+    return true;
+  }
+};
+
+class PlannerServerWrapper : public nav2_planner::PlannerServer
+{
+public:
+  void setCostmapParameter(const rclcpp::Parameter & parameter)
+  {
+    costmap_ros_->set_parameter(parameter);
+  }
+
+  void setRobotPose()
+  {
+    geometry_msgs::msg::TransformStamped transform;
+    transform.header.frame_id = "map";
+    transform.header.stamp = now();
+    transform.child_frame_id = "base_link";
+    transform.transform.rotation.w = 1.0;
+    tf_->setTransform(transform, "test_planner_server", true);
+  }
+
+  void addDummyPlanner(const std::string & planner_id, int batch_instances)
+  {
+    planners_[planner_id] = std::make_shared<DummyPlanner>();
+    for (int i = 0; i != batch_instances; i++) {
+      batch_planners_[planner_id].push_back(std::make_shared<DummyPlanner>());
+    }
+    planner_ids_concat_ += planner_id + std::string(" ");
+  }
+};
+
+// Define a test class to hold the context for the tests
+
+class PlannerServerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    planner_server_ = std::make_shared<PlannerServerWrapper>();
+    planner_server_->set_parameter(
+      rclcpp::Parameter("planner_plugins", std::vector<std::string>()));
+    planner_server_->setCostmapParameter(
+      rclcpp::Parameter("plugins", std::vector<std::string>()));
+    planner_server_->configure();
+    planner_server_->setRobotPose();
+    planner_server_->addDummyPlanner("Dummy", 3);
+    planner_server_->activate();
+
+    client_node_ = std::make_shared<rclcpp::Node>("test_planner_server_client");
+    client_ = rclcpp_action::create_client<BatchAction>(client_node_, "compute_paths_to_poses");
+  }
+
+  void TearDown() override
+  {
+    client_.reset();
+    client_node_.reset();
+    planner_server_->deactivate();
+    planner_server_->cleanup();
+    planner_server_.reset();
+  }
+
+  ClientGoalHandle::WrappedResult computePlans(
+    const std::vector<double> & goals_x, const std::string & planner_id)
+  {
+    EXPECT_TRUE(client_->wait_for_action_server(4s));
+
+    BatchAction::Goal goal;
+    goal.planner_id = planner_id;
+    for (const double x : goals_x) {
+      geometry_msgs::msg::PoseStamped pose;
+      pose.header.frame_id = "map";
+      pose.pose.position.x = x;
+      pose.pose.orientation.w = 1.0;
+      goal.goals.push_back(pose);
+    }
+
+    auto future_goal = client_->async_send_goal(goal);
+    EXPECT_EQ(
+      rclcpp::spin_until_future_complete(client_node_, future_goal, 4s),
+      rclcpp::FutureReturnCode::SUCCESS);
+    auto goal_handle = future_goal.get();
+    EXPECT_TRUE(goal_handle);
+
+    auto future_result = client_->async_get_result(goal_handle);
+    EXPECT_EQ(
+      rclcpp::spin_until_future_complete(client_node_, future_result, 4s),
+      rclcpp::FutureReturnCode::SUCCESS);
+    return future_result.get();
+  }
+
+  std::shared_ptr<PlannerServerWrapper> planner_server_;
+  rclcpp::Node::SharedPtr client_node_;
+  rclcpp_action::Client<BatchAction>::SharedPtr client_;
+};
+
+// Define the tests
+
+TEST_F(PlannerServerTest, testingMixedGoalsKeepTheirOrder)
+{
+  // Spread over the 3 batch instances in chunks of 2 or 3 goals
+  const std::vector<double> goals_x{1.0, -1.0, 2.0, 3.0, -2.0, 4.0, -3.0, 5.0};
+  auto result = computePlans(goals_x, "Dummy");
+  ASSERT_EQ(result.code, rclcpp_action::ResultCode::SUCCEEDED);
+
+  const auto & paths = result.result->paths;
+  ASSERT_EQ(paths.size(), goals_x.size());
+  for (size_t i = 0; i != goals_x.size(); i++) {
+    if (goals_x[i] < 0.0) {
+      EXPECT_TRUE(paths[i].poses.empty());
+    } else {
+      ASSERT_EQ(paths[i].poses.size(), 2u);
+      EXPECT_DOUBLE_EQ(paths[i].poses.back().pose.position.x, goals_x[i]);
+    }
+  }
+}
+
+TEST_F(PlannerServerTest, testingDefaultPlannerId)
+{
+  auto result = computePlans({-1.0, 2.0}, "");
+  ASSERT_EQ(result.code, rclcpp_action::ResultCode::SUCCEEDED);
+  ASSERT_EQ(result.result->paths.size(), 2u);
+  EXPECT_TRUE(result.result->paths[0].poses.empty());
+  EXPECT_EQ(result.result->paths[1].poses.size(), 2u);
+}
+
+TEST_F(PlannerServerTest, testingFailureOnAllGoals)
+{
+  auto result = computePlans({-1.0, -2.0, -3.0, -4.0}, "Dummy");
+  EXPECT_EQ(result.code, rclcpp_action::ResultCode::ABORTED);
+}
+
+TEST_F(PlannerServerTest, testingFailureOnInvalidPlanner)
+{
+  auto result = computePlans({1.0, 2.0}, "NotAPlanner");
+  EXPECT_EQ(result.code, rclcpp_action::ResultCode::ABORTED);
+}
+
+int main(int argc, char ** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  // initialize ROS
+  rclcpp::init(argc, argv);
+
+  bool all_successful = RUN_ALL_TESTS();
+
+  // shutdown ROS
+  rclcpp::shutdown();
+
+  return all_successful;
+}
@@ -26,6 +26,7 @@
 #include "pluginlib/class_loader.hpp"
 #include "pluginlib/class_list_macros.hpp"
 #include "nav2_util/odometry_utils.hpp"
+#include "nav2_costmap_2d/inflation_layer.hpp"
 #include "geometry_msgs/msg/pose2_d.hpp"
 
 namespace nav2_regulated_pure_pursuit_controller
@@ -99,7 +100,7 @@ public:
 
 protected:
   /**
-   * @brief Transforms global plan into same frame as pose, clips far away poses and possibly prunes passed poses
+   * @brief Transforms global plan into same frame as pose, clips far away poses and prunes passed poses
    * @param pose pose to transform
    * @return Path in new frame
    */
@@ -178,6 +179,14 @@ protected:
    */
   bool inCollision(const double & x, const double & y);
 
+  /**
+   * @brief Lower bound on the distance from a pose to any pose in collision,
+   * from the cost inflated around obstacles at the pose
+   * @param cost Cost at the pose
+   * @return Distance, 0 if unknown
+   */
+  double getDistanceToCollision(const unsigned char & cost);
+
   /**
    * @brief Cost at a point
    * @param x Pose of pose x
@@ -239,9 +248,11 @@ protected:
   double goal_dist_tol_;
 
   nav_msgs::msg::Path global_plan_;
+  size_t closest_pose_index_{0};
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::Path>> global_path_pub_;
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::PointStamped>> carrot_pub_;
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::Path>> carrot_arc_pub_;
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> inflation_layer_;
 };
 
 }  // namespace nav2_regulated_pure_pursuit_controller
@@ -14,6 +14,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <limits>
 #include <string>
 #include <memory>
 
@@ -169,6 +170,7 @@ void RegulatedPurePursuitController::cleanup()
   global_path_pub_.reset();
   carrot_pub_.reset();
   carrot_arc_pub_.reset();
+  inflation_layer_.reset();
 }
 
 void RegulatedPurePursuitController::activate()
@@ -181,6 +183,16 @@ void RegulatedPurePursuitController::activate()
   global_path_pub_->on_activate();
   carrot_pub_->on_activate();
   carrot_arc_pub_->on_activate();
+
+  // The inflation layer of the costmap tells the distance to collisions, as long
+  // as no layer after it marks obstacles which are not inflated
+  inflation_layer_.reset();
+  if (costmap_ros_->getLayeredCostmap() &&
+    !costmap_ros_->getLayeredCostmap()->getPlugins()->empty())
+  {
+    inflation_layer_ = std::dynamic_pointer_cast<nav2_costmap_2d::InflationLayer>(
+      costmap_ros_->getLayeredCostmap()->getPlugins()->back());
+  }
 }
 
 void RegulatedPurePursuitController::deactivate()
@@ -338,53 +350,117 @@ bool RegulatedPurePursuitController::isCollisionImminent(
     return true;
   }
 
-  // visualization messages
+  // visualization messages, only built if anyone is listening
+  const bool publish_arc = carrot_arc_pub_->get_subscription_count() > 0;
   nav_msgs::msg::Path arc_pts_msg;
   arc_pts_msg.header.frame_id = costmap_ros_->getGlobalFrameID();
   arc_pts_msg.header.stamp = robot_pose.header.stamp;
   geometry_msgs::msg::PoseStamped pose_msg;
   pose_msg.header.frame_id = arc_pts_msg.header.frame_id;
   pose_msg.header.stamp = arc_pts_msg.header.stamp;
+  pose_msg.pose.position.z = 0.01;
 
   const double projection_time = costmap_->getResolution() / fabs(linear_vel);
+  const unsigned char * char_map = costmap_->getCharMap();
+  const bool tracking_unknown = costmap_ros_->getLayeredCostmap()->isTrackingUnknown();
 
-  geometry_msgs::msg::Pose2D curr_pose;
-  curr_pose.x = robot_pose.pose.position.x;
-  curr_pose.y = robot_pose.pose.position.y;
-  curr_pose.theta = tf2::getYaw(robot_pose.pose.orientation);
+  // The velocities are constant, so the poses are taken on the exact arc rather
+  // than integrated step by step
+  const double x0 = robot_pose.pose.position.x;
+  const double y0 = robot_pose.pose.position.y;
+  const double theta0 = tf2::getYaw(robot_pose.pose.orientation);
+  const bool straight = fabs(angular_vel) < 1e-6;
 
+  unsigned int last_index = std::numeric_limits<unsigned int>::max();
   int i = 1;
   while (true) {
     // only forward simulate within time requested
     if (i * projection_time > max_allowed_time_to_collision_) {
       break;
     }
-    
-    i++;
 
-    // apply velocity at curr_pose over distance
-    curr_pose.x += projection_time * (linear_vel * cos(curr_pose.theta));
-    curr_pose.y += projection_time * (linear_vel * sin(curr_pose.theta));
-    curr_pose.theta += projection_time * angular_vel;
+    const double t = i * projection_time;
+    double x, y;
+    if (straight) {
+      x = x0 + linear_vel * t * cos(theta0);
+      y = y0 + linear_vel * t * sin(theta0);
+    } else {
+      const double theta = theta0 + angular_vel * t;
+      const double radius = linear_vel / angular_vel;
+      x = x0 + radius * (sin(theta) - sin(theta0));
+      y = y0 - radius * (cos(theta) - cos(theta0));
+    }
 
     // store it for visualization
-    pose_msg.pose.position.x = curr_pose.x;
-    pose_msg.pose.position.y = curr_pose.y;
-    pose_msg.pose.position.z = 0.01;
-    arc_pts_msg.poses.push_back(pose_msg);
-
-    // check for collision at this point
-    if (inCollision(curr_pose.x, curr_pose.y)) {
-      carrot_arc_pub_->publish(arc_pts_msg);
-      return true;
+    if (publish_arc) {
+      pose_msg.pose.position.x = x;
+      pose_msg.pose.position.y = y;
+      arc_pts_msg.poses.push_back(pose_msg);
+    }
+
+    unsigned int mx, my;
+    if (!costmap_->worldToMap(x, y, mx, my)) {
+      // nothing is known beyond the costmap
+      i++;
+      continue;
     }
+
+    // check for collision at this point, once per cell
+    const unsigned int index = costmap_->getIndex(mx, my);
+    const unsigned char cost = char_map[index];
+    if (index != last_index) {
+      last_index = index;
+      if (cost >= INSCRIBED_INFLATED_OBSTACLE && !(tracking_unknown && cost == NO_INFORMATION)) {
+        if (publish_arc) {
+          carrot_arc_pub_->publish(arc_pts_msg);
+        }
+        return true;
+      }
+    }
+
+    // a chord is no longer than its arc, so the poses along the arc within the
+    // distance known to be free of collisions are skipped
+    i += std::max(1, static_cast<int>(getDistanceToCollision(cost) / costmap_->getResolution()));
   }
 
-  carrot_arc_pub_->publish(arc_pts_msg);
+  if (publish_arc) {
+    carrot_arc_pub_->publish(arc_pts_msg);
+  }
 
   return false;
 }
 
+double RegulatedPurePursuitController::getDistanceToCollision(const unsigned char & cost)
+{
+  // The costs inflated around obstacles fall off with the distance to them, so
+  // they tell how far a pose is at least from one in collision
+  if (!inflation_layer_ || !inflation_layer_->isEnabled() ||
+    cost >= INSCRIBED_INFLATED_OBSTACLE - 1)
+  {
+    return 0.0;
+  }
+
+  const double cost_scaling_factor = inflation_layer_->getCostScalingFactor();
+  if (cost_scaling_factor <= 0.0) {
+    return 0.0;
+  }
+
+  // costs are rounded down, so the distance is taken for the next cost up
+  const double max_inflated_cost = INSCRIBED_INFLATED_OBSTACLE - 1;
+  double distance;
+  if (cost == FREE_SPACE) {
+    distance = std::min(
+      inflation_layer_->getInflationRadius() -
+      costmap_ros_->getLayeredCostmap()->getInscribedRadius(),
+      log(max_inflated_cost) / cost_scaling_factor);
+  } else {
+    distance = -log((cost + 1.0) / max_inflated_cost) / cost_scaling_factor;
+  }
+
+  // both poses are only known to a cell
+  return std::max(0.0, distance - 2.0 * costmap_->getResolution());
+}
+
 bool RegulatedPurePursuitController::inCollision(const double & x, const double & y)
 {
   unsigned int mx, my;
@@ -464,6 +540,7 @@ void RegulatedPurePursuitController::applyConstraints(
 void RegulatedPurePursuitController::setPlan(const nav_msgs::msg::Path & path)
 {
   global_plan_ = path;
+  closest_pose_index_ = 0;
 }
 
 nav_msgs::msg::Path RegulatedPurePursuitController::transformGlobalPlan(
@@ -485,10 +562,23 @@ nav_msgs::msg::Path RegulatedPurePursuitController::transformGlobalPlan(
   const double max_costmap_dim = std::max(costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
   const double max_transform_dist =  max_costmap_dim * costmap->getResolution() / 2.0;
 
-  // First find the closest pose on the path to the robot
+  // First find the closest pose on the path to the robot. The poses before the last
+  // closest one were passed, and the robot cannot have gone farther along the path
+  // than it can see, so only the poses in between are searched
+  auto closest_pose_lower_bound = global_plan_.poses.begin() + closest_pose_index_;
+  auto closest_pose_upper_bound = closest_pose_lower_bound + 1;
+  double integrated_dist = 0.0;
+  while (closest_pose_upper_bound != global_plan_.poses.end() &&
+    integrated_dist <= max_transform_dist)
+  {
+    integrated_dist += euclidean_distance(
+      *(closest_pose_upper_bound - 1), *closest_pose_upper_bound);
+    ++closest_pose_upper_bound;
+  }
+
   auto transformation_begin =
     min_by(
-    global_plan_.poses.begin(), global_plan_.poses.end(),
+    closest_pose_lower_bound, closest_pose_upper_bound,
     [&robot_pose](const geometry_msgs::msg::PoseStamped & ps) {
       return euclidean_distance(robot_pose, ps);
     });
@@ -500,29 +590,57 @@ nav_msgs::msg::Path RegulatedPurePursuitController::transformGlobalPlan(
       return euclidean_distance(robot_pose, global_plan_pose) > max_transform_dist;
     });
 
-  // Lambda to transform a PoseStamped from global frame to local
-  auto transformGlobalPoseToLocal = [&](const auto & global_plan_pose) {
-      geometry_msgs::msg::PoseStamped stamped_pose, transformed_pose;
-      stamped_pose.header.frame_id = global_plan_.header.frame_id;
-      stamped_pose.header.stamp = robot_pose.header.stamp;
-      stamped_pose.pose = global_plan_pose.pose;
-      transformPose(costmap_ros_->getBaseFrameID(), stamped_pose, transformed_pose);
-      return transformed_pose;
-    };
+  // Look up the transform from the global plan to the robot's frame of reference once,
+  // rather than for each pose
+  tf2::Transform plan_to_base;
+  plan_to_base.setIdentity();
+  if (global_plan_.header.frame_id != costmap_ros_->getBaseFrameID()) {
+    try {
+      const auto transform = tf_->lookupTransform(
+        costmap_ros_->getBaseFrameID(), global_plan_.header.frame_id,
+        tf2_ros::fromMsg(robot_pose.header.stamp), transform_tolerance_).transform;
+      plan_to_base = tf2::Transform(
+        tf2::Quaternion(
+          transform.rotation.x, transform.rotation.y,
+          transform.rotation.z, transform.rotation.w),
+        tf2::Vector3(transform.translation.x, transform.translation.y, transform.translation.z));
+    } catch (tf2::TransformException & ex) {
+      throw nav2_core::PlannerException(
+              std::string("Unable to transform global plan into robot's frame: ") + ex.what());
+    }
+  }
 
   // Transform the near part of the global plan into the robot's frame of reference.
   nav_msgs::msg::Path transformed_plan;
-  std::transform(
-    transformation_begin, transformation_end,
-    std::back_inserter(transformed_plan.poses),
-    transformGlobalPoseToLocal);
   transformed_plan.header.frame_id = costmap_ros_->getBaseFrameID();
   transformed_plan.header.stamp = robot_pose.header.stamp;
+  transformed_plan.poses.resize(std::distance(transformation_begin, transformation_end));
+  auto transformed_pose = transformed_plan.poses.begin();
+  for (auto it = transformation_begin; it != transformation_end; ++it, ++transformed_pose) {
+    const auto & position = it->pose.position;
+    const auto & orientation = it->pose.orientation;
+    const tf2::Transform global_plan_pose(
+      tf2::Quaternion(orientation.x, orientation.y, orientation.z, orientation.w),
+      tf2::Vector3(position.x, position.y, position.z));
+    const tf2::Transform local_pose = plan_to_base * global_plan_pose;
+    const tf2::Vector3 & origin = local_pose.getOrigin();
+    const tf2::Quaternion rotation = local_pose.getRotation();
+    transformed_pose->header = transformed_plan.header;
+    transformed_pose->pose.position.x = origin.x();
+    transformed_pose->pose.position.y = origin.y();
+    transformed_pose->pose.position.z = origin.z();
+    transformed_pose->pose.orientation.x = rotation.x();
+    transformed_pose->pose.orientation.y = rotation.y();
+    transformed_pose->pose.orientation.z = rotation.z();
+    transformed_pose->pose.orientation.w = rotation.w();
+  }
 
-  // Remove the portion of the global plan that we've already passed so we don't
+  // Remember the portion of the global plan that we've already passed so we don't
   // process it on the next iteration (this is called path pruning)
-  global_plan_.poses.erase(begin(global_plan_.poses), transformation_begin);
-  global_path_pub_->publish(transformed_plan);
+  closest_pose_index_ = std::distance(global_plan_.poses.begin(), transformation_begin);
+  if (global_path_pub_->get_subscription_count() > 0) {
+    global_path_pub_->publish(transformed_plan);
+  }
 
   if (transformed_plan.poses.empty()) {
     throw nav2_core::PlannerException("Resulting plan has 0 poses in it.");
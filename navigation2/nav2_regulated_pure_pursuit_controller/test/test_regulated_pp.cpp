@@ -13,14 +13,19 @@
 // limitations under the License.
 
 #include <math.h>
+#include <limits>
 #include <memory>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_util/geometry_utils.hpp"
 #include "nav2_util/lifecycle_node.hpp"
+#include "tf2/utils.h"
 #include "nav2_regulated_pure_pursuit_controller/regulated_pure_pursuit_controller.hpp"
 
 class RclCppFixture
@@ -87,8 +92,116 @@ public:
     return applyConstraints(dist_error, lookahead_dist, curvature, curr_speed, pose_cost, linear_vel);
   }
 
+  nav_msgs::msg::Path transformGlobalPlanWrapper(const geometry_msgs::msg::PoseStamped & pose)
+  {
+    return transformGlobalPlan(pose);
+  }
+
+  bool isCollisionImminentWrapper(
+    const geometry_msgs::msg::PoseStamped & robot_pose,
+    const double & linear_vel, const double & angular_vel)
+  {
+    return isCollisionImminent(robot_pose, linear_vel, angular_vel);
+  }
+
+  double getDistanceToCollisionWrapper(const unsigned char & cost)
+  {
+    return getDistanceToCollision(cost);
+  }
 };
 
+// A 5m x 5m costmap with only an inflation layer, or none, to write the costs to directly
+std::shared_ptr<nav2_costmap_2d::Costmap2DROS> makeCollisionCostmap(
+  const std::string & name, bool use_inflation, bool inflation_enabled)
+{
+  auto costmap = std::make_shared<nav2_costmap_2d::Costmap2DROS>(name);
+  std::vector<std::string> plugins;
+  if (use_inflation) {
+    plugins.push_back("inflation_layer");
+    costmap->declare_parameter(
+      "inflation_layer.plugin",
+      rclcpp::ParameterValue(std::string("nav2_costmap_2d::InflationLayer")));
+    costmap->declare_parameter(
+      "inflation_layer.enabled", rclcpp::ParameterValue(inflation_enabled));
+  }
+  costmap->set_parameter(rclcpp::Parameter("plugins", plugins));
+  costmap->on_configure(rclcpp_lifecycle::State());
+  return costmap;
+}
+
+// A controller checking for collisions up to 5s ahead
+std::shared_ptr<BasicAPIRPP> makeCollisionController(
+  const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> & costmap)
+{
+  auto ctrl = std::make_shared<BasicAPIRPP>();
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("testRPP");
+  std::string name = "PathFollower";
+  node->declare_parameter(
+    name + ".max_allowed_time_to_collision", rclcpp::ParameterValue(5.0));
+  auto tf = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+  ctrl->configure(node, name, tf, costmap);
+  ctrl->activate();
+  return ctrl;
+}
+
+// Inflate the lethal obstacles of the costmap, if it has an inflation layer
+void inflate(const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> & costmap)
+{
+  auto plugins = costmap->getLayeredCostmap()->getPlugins();
+  if (!plugins->empty()) {
+    auto master = costmap->getCostmap();
+    plugins->back()->updateCosts(
+      *master, 0, 0, master->getSizeInCellsX(), master->getSizeInCellsY());
+  }
+}
+
+geometry_msgs::msg::PoseStamped makePose(double x, double y, double yaw)
+{
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation = nav2_util::geometry_utils::orientationAroundZAxis(yaw);
+  return pose;
+}
+
+// The previous collision check, which tested every pose a cell apart along the arc
+bool sampledCollisionCheck(
+  nav2_costmap_2d::Costmap2D * costmap, const geometry_msgs::msg::PoseStamped & robot_pose,
+  double linear_vel, double angular_vel, double max_time)
+{
+  auto in_collision = [costmap](double x, double y) {
+      unsigned int mx, my;
+      return costmap->worldToMap(x, y, mx, my) &&
+             costmap->getCost(mx, my) >= nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+    };
+
+  const double x0 = robot_pose.pose.position.x;
+  const double y0 = robot_pose.pose.position.y;
+  const double theta0 = tf2::getYaw(robot_pose.pose.orientation);
+  if (in_collision(x0, y0)) {
+    return true;
+  }
+
+  const double projection_time = costmap->getResolution() / fabs(linear_vel);
+  for (int i = 1; i * projection_time <= max_time; i++) {
+    const double t = i * projection_time;
+    double x, y;
+    if (fabs(angular_vel) < 1e-6) {
+      x = x0 + linear_vel * t * cos(theta0);
+      y = y0 + linear_vel * t * sin(theta0);
+    } else {
+      const double radius = linear_vel / angular_vel;
+      x = x0 + radius * (sin(theta0 + angular_vel * t) - sin(theta0));
+      y = y0 - radius * (cos(theta0 + angular_vel * t) - cos(theta0));
+    }
+    if (in_collision(x, y)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 TEST(RegulatedPurePursuitTest, basicAPI)
 {
   auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("testRPP");
@@ -322,3 +435,203 @@ TEST(RegulatedPurePursuitTest, applyConstraints)
   // ctrl->applyConstraintsWrapper(dist_error, lookahead_dist, curvature, curr_speed, pose_cost, linear_vel);
   // EXPECT_NEAR(linear_vel, 0.5, 0.01);
 }
+
+TEST(RegulatedPurePursuitTest, transformGlobalPlan)
+{
+  auto ctrl = std::make_shared<BasicAPIRPP>();
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("testRPP");
+  std::string name = "PathFollower";
+  auto tf = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+  tf->setUsingDedicatedThread(true);
+  auto costmap = std::make_shared<nav2_costmap_2d::Costmap2DROS>("fake_costmap");
+  costmap->on_configure(rclcpp_lifecycle::State());
+  ctrl->configure(node, name, tf, costmap);
+
+  // a long straight plan in the map frame
+  nav_msgs::msg::Path path;
+  path.header.frame_id = "map";
+  path.poses.resize(3000);
+  for (unsigned int i = 0; i != path.poses.size(); i++) {
+    path.poses[i].header.frame_id = "map";
+    path.poses[i].pose.position.x = 0.05 * i;
+    path.poses[i].pose.orientation.w = 1.0;
+  }
+  ctrl->setPlan(path);
+
+  geometry_msgs::msg::TransformStamped transform;
+  transform.header.frame_id = "map";
+  transform.child_frame_id = costmap->getBaseFrameID();
+  transform.transform.rotation.w = 1.0;
+  geometry_msgs::msg::PoseStamped robot_pose;
+  robot_pose.header.frame_id = "map";
+  robot_pose.pose.orientation.w = 1.0;
+
+  // the plan starts at the robot and is clipped to the costmap
+  const double max_transform_dist = std::max(
+    costmap->getCostmap()->getSizeInCellsX(), costmap->getCostmap()->getSizeInCellsY()) *
+    costmap->getCostmap()->getResolution() / 2.0;
+  for (double x : {1.0, 2.0, 3.0}) {
+    transform.transform.translation.x = x;
+    tf->setTransform(transform, "test", true);
+    robot_pose.pose.position.x = x;
+    auto transformed_plan = ctrl->transformGlobalPlanWrapper(robot_pose);
+    ASSERT_FALSE(transformed_plan.poses.empty());
+    EXPECT_EQ(transformed_plan.header.frame_id, costmap->getBaseFrameID());
+    EXPECT_NEAR(transformed_plan.poses.front().pose.position.x, 0.0, 1e-6);
+    EXPECT_NEAR(transformed_plan.poses.back().pose.position.x, max_transform_dist, 0.05);
+  }
+
+  // the passed part of the plan is not searched again
+  transform.transform.translation.x = 2.0;
+  tf->setTransform(transform, "test", true);
+  robot_pose.pose.position.x = 2.0;
+  auto transformed_plan = ctrl->transformGlobalPlanWrapper(robot_pose);
+  EXPECT_NEAR(transformed_plan.poses.front().pose.position.x, 1.0, 1e-6);
+
+  // a new plan is searched from its start
+  ctrl->setPlan(path);
+  transformed_plan = ctrl->transformGlobalPlanWrapper(robot_pose);
+  EXPECT_NEAR(transformed_plan.poses.front().pose.position.x, 0.0, 1e-6);
+
+  costmap->on_cleanup(rclcpp_lifecycle::State());
+}
+
+TEST(RegulatedPurePursuitTest, collisionChecking)
+{
+  // with the inflation layer, without it and with it disabled
+  const std::vector<std::pair<bool, bool>> setups = {{true, true}, {false, false}, {true, false}};
+  for (unsigned int s = 0; s != setups.size(); s++) {
+    SCOPED_TRACE("setup " + std::to_string(s));
+    auto costmap = makeCollisionCostmap(
+      "collision_costmap_" + std::to_string(s), setups[s].first, setups[s].second);
+    auto ctrl = makeCollisionController(costmap);
+
+    // a block from (3.0, 2.0) to (3.2, 3.0)
+    auto master = costmap->getCostmap();
+    for (unsigned int my = 20; my != 30; my++) {
+      for (unsigned int mx = 30; mx != 32; mx++) {
+        master->setCost(mx, my, nav2_costmap_2d::LETHAL_OBSTACLE);
+      }
+    }
+    inflate(costmap);
+
+    auto expectCollision = [&](
+      const geometry_msgs::msg::PoseStamped & pose, double linear_vel, double angular_vel,
+      bool expected)
+      {
+        EXPECT_EQ(ctrl->isCollisionImminentWrapper(pose, linear_vel, angular_vel), expected)
+          << linear_vel << " m/s, " << angular_vel << " rad/s";
+        EXPECT_EQ(
+          sampledCollisionCheck(master, pose, linear_vel, angular_vel, 5.0), expected);
+      };
+
+    // straight at the block, beside it, away from it and too slowly to reach it in time
+    expectCollision(makePose(1.05, 2.55, 0.0), 0.5, 0.0, true);
+    expectCollision(makePose(1.05, 1.05, 0.0), 0.5, 0.0, false);
+    expectCollision(makePose(1.05, 2.55, M_PI), 0.5, 0.0, false);
+    expectCollision(makePose(1.05, 2.55, 0.0), 0.2, 0.0, false);
+
+    // curving into the block and away from it, off the costmap
+    expectCollision(makePose(1.05, 1.05, 0.0), 1.0, 0.5, true);
+    expectCollision(makePose(1.05, 1.05, 0.0), 1.0, -0.5, false);
+
+    // rotating in place only checks the current pose
+    expectCollision(makePose(1.05, 1.05, 0.0), 0.0, 1.0, false);
+    expectCollision(makePose(3.05, 2.55, 0.0), 0.0, 1.0, true);
+
+    ctrl->deactivate();
+    ctrl->cleanup();
+    costmap->on_cleanup(rclcpp_lifecycle::State());
+  }
+}
+
+TEST(RegulatedPurePursuitTest, distanceToCollision)
+{
+  auto costmap = makeCollisionCostmap("distance_costmap", true, true);
+  auto ctrl = makeCollisionController(costmap);
+  auto master = costmap->getCostmap();
+  master->setCost(20, 20, nav2_costmap_2d::LETHAL_OBSTACLE);
+  master->setCost(25, 31, nav2_costmap_2d::LETHAL_OBSTACLE);
+  inflate(costmap);
+
+  // no distance in collision, and more the lower the cost
+  EXPECT_EQ(ctrl->getDistanceToCollisionWrapper(nav2_costmap_2d::LETHAL_OBSTACLE), 0.0);
+  EXPECT_EQ(
+    ctrl->getDistanceToCollisionWrapper(nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 0.0);
+  EXPECT_GT(ctrl->getDistanceToCollisionWrapper(nav2_costmap_2d::FREE_SPACE), 0.0);
+  for (unsigned int cost = 1; cost < nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE; cost++) {
+    EXPECT_LE(
+      ctrl->getDistanceToCollisionWrapper(cost), ctrl->getDistanceToCollisionWrapper(cost - 1));
+  }
+
+  // a lower bound of the distance from every cell to those in collision
+  const double resolution = master->getResolution();
+  for (unsigned int y = 0; y != master->getSizeInCellsY(); y++) {
+    for (unsigned int x = 0; x != master->getSizeInCellsX(); x++) {
+      double distance = std::numeric_limits<double>::max();
+      for (unsigned int cy = 0; cy != master->getSizeInCellsY(); cy++) {
+        for (unsigned int cx = 0; cx != master->getSizeInCellsX(); cx++) {
+          if (master->getCost(cx, cy) >= nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE) {
+            distance = std::min(
+              distance,
+              resolution * hypot(static_cast<double>(cx) - x, static_cast<double>(cy) - y));
+          }
+        }
+      }
+      EXPECT_LE(ctrl->getDistanceToCollisionWrapper(master->getCost(x, y)), distance)
+        << "cell " << x << ", " << y;
+    }
+  }
+
+  ctrl->deactivate();
+  ctrl->cleanup();
+  costmap->on_cleanup(rclcpp_lifecycle::State());
+}
+
+TEST(RegulatedPurePursuitTest, collisionCheckingMatchesSampling)
+{
+  // without the inflation layer, and with it disabled, no poses may be skipped
+  for (bool use_inflation : {false, true}) {
+    SCOPED_TRACE(use_inflation ? "inflation disabled" : "no inflation");
+    auto costmap = makeCollisionCostmap(
+      std::string("sampling_costmap_") + (use_inflation ? "disabled" : "absent"),
+      use_inflation, false);
+    auto ctrl = makeCollisionController(costmap);
+    auto master = costmap->getCostmap();
+
+    // scattered single cell obstacles over costs which are not from inflation
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> cost_dist(0, 99);
+    for (unsigned int y = 0; y != master->getSizeInCellsY(); y++) {
+      for (unsigned int x = 0; x != master->getSizeInCellsX(); x++) {
+        const int c = cost_dist(gen);
+        master->setCost(
+          x, y, c < 3 ? nav2_costmap_2d::LETHAL_OBSTACLE : static_cast<unsigned char>(2 * c));
+      }
+    }
+    inflate(costmap);
+
+    std::uniform_real_distribution<double> position_dist(0.0, 5.0);
+    std::uniform_real_distribution<double> yaw_dist(-M_PI, M_PI);
+    std::uniform_real_distribution<double> linear_dist(0.05, 1.0);
+    std::uniform_real_distribution<double> angular_dist(-1.5, 1.5);
+    unsigned int collisions = 0;
+    for (int i = 0; i != 500; i++) {
+      auto pose = makePose(position_dist(gen), position_dist(gen), yaw_dist(gen));
+      const double linear_vel = linear_dist(gen);
+      const double angular_vel = i % 5 == 0 ? 0.0 : angular_dist(gen);
+      const bool expected = sampledCollisionCheck(master, pose, linear_vel, angular_vel, 5.0);
+      EXPECT_EQ(ctrl->isCollisionImminentWrapper(pose, linear_vel, angular_vel), expected)
+        << pose.pose.position.x << ", " << pose.pose.position.y << ", " << linear_vel <<
+        " m/s, " << angular_vel << " rad/s";
+      collisions += expected;
+    }
+    // both outcomes are covered
+    EXPECT_GT(collisions, 0u);
+    EXPECT_LT(collisions, 500u);
+
+    ctrl->deactivate();
+    ctrl->cleanup();
+    costmap->on_cleanup(rclcpp_lifecycle::State());
+  }
+}
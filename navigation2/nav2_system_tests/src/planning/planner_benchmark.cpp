@@ -0,0 +1,331 @@
+// Copyright (c) 2020 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark of the global planner plugins, run offline to catch performance regressions.
+// Every plugin plans between random free poses of random maps of increasing sizes, for
+// each seed. The latency percentiles, memory high-water mark, path length and turning
+// of each plugin on each map size are printed and written to a CSV file.
+//
+//   ros2 run nav2_system_tests planner_benchmark --ros-args
+//     -p plugins:="['nav2_navfn_planner/NavfnPlanner']" -p output_file:=results.csv
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_util/lifecycle_node.hpp"
+#include "pluginlib/class_loader.hpp"
+#include "nav2_core/global_planner.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav_msgs/msg/path.hpp"
+#include "tf2_ros/buffer.h"
+
+using namespace std::chrono;  // NOLINT
+
+namespace nav2_system_tests
+{
+
+// The results of a plugin on the maps of a size, for all seeds
+struct BenchmarkResult
+{
+  std::string plugin;
+  unsigned int map_size{0};
+  unsigned int plans{0};
+  unsigned int successes{0};
+  std::vector<double> latencies_ms;
+  long memory_hwm_kb{-1};  // NOLINT
+  double path_length{0.0};
+  double length_ratio{0.0};
+  double turning{0.0};
+};
+
+// Random map with rectangular obstacles covering about the given ratio of its cells,
+// inside a lethal border
+void generateMap(
+  nav2_costmap_2d::Costmap2D * costmap, const unsigned int size,
+  const double obstacle_ratio, std::mt19937 & generator)
+{
+  costmap->resizeMap(size, size, 0.05, 0.0, 0.0);
+  costmap->resetMap(0, 0, size, size);
+
+  for (unsigned int i = 0; i != size; i++) {
+    costmap->setCost(i, 0, nav2_costmap_2d::LETHAL_OBSTACLE);
+    costmap->setCost(i, size - 1, nav2_costmap_2d::LETHAL_OBSTACLE);
+    costmap->setCost(0, i, nav2_costmap_2d::LETHAL_OBSTACLE);
+    costmap->setCost(size - 1, i, nav2_costmap_2d::LETHAL_OBSTACLE);
+  }
+
+  const unsigned int max_side = std::max(2u, size / 10);
+  std::uniform_int_distribution<unsigned int> position(1, size - 2);
+  std::uniform_int_distribution<unsigned int> side(1, max_side);
+  const double mean_area = (max_side + 1) * (max_side + 1) / 4.0;
+  const unsigned int num_obstacles = obstacle_ratio * size * size / mean_area;
+  for (unsigned int n = 0; n != num_obstacles; n++) {
+    const unsigned int x0 = position(generator);
+    const unsigned int y0 = position(generator);
+    const unsigned int x1 = std::min(x0 + side(generator), size - 1);
+    const unsigned int y1 = std::min(y0 + side(generator), size - 1);
+    for (unsigned int y = y0; y != y1; y++) {
+      for (unsigned int x = x0; x != x1; x++) {
+        costmap->setCost(x, y, nav2_costmap_2d::LETHAL_OBSTACLE);
+      }
+    }
+  }
+}
+
+geometry_msgs::msg::PoseStamped randomFreePose(
+  const nav2_costmap_2d::Costmap2D * costmap, const std::string & frame,
+  std::mt19937 & generator)
+{
+  std::uniform_int_distribution<unsigned int> position(1, costmap->getSizeInCellsX() - 2);
+  std::uniform_real_distribution<double> yaw(-M_PI, M_PI);
+  unsigned int mx, my;
+  do {
+    mx = position(generator);
+    my = position(generator);
+  } while (costmap->getCost(mx, my) != nav2_costmap_2d::FREE_SPACE);
+
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header.frame_id = frame;
+  costmap->mapToWorld(mx, my, pose.pose.position.x, pose.pose.position.y);
+  const double theta = yaw(generator);
+  pose.pose.orientation.z = std::sin(theta / 2.0);
+  pose.pose.orientation.w = std::cos(theta / 2.0);
+  return pose;
+}
+
+// Resident memory high-water mark of the process in kB, reset by resetMemoryHwm
+long readMemoryHwm()  // NOLINT
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::stol(line.substr(6));
+    }
+  }
+  return -1;
+}
+
+void resetMemoryHwm()
+{
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
+
+// Length of the path and sum of the absolute heading changes along it
+void measurePath(const nav_msgs::msg::Path & path, double & length, double & turning)
+{
+  length = 0.0;
+  turning = 0.0;
+  double last_heading = 0.0;
+  bool has_heading = false;
+  for (unsigned int i = 1; i < path.poses.size(); i++) {
+    const double dx = path.poses[i].pose.position.x - path.poses[i - 1].pose.position.x;
+    const double dy = path.poses[i].pose.position.y - path.poses[i - 1].pose.position.y;
+    const double segment = std::hypot(dx, dy);
+    if (segment < 1e-6) {
+      continue;
+    }
+    length += segment;
+    const double heading = std::atan2(dy, dx);
+    if (has_heading) {
+      turning += std::fabs(std::remainder(heading - last_heading, 2.0 * M_PI));
+    }
+    last_heading = heading;
+    has_heading = true;
+  }
+}
+
+double percentile(std::vector<double> values, const double ratio)
+{
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  const size_t rank = std::ceil(ratio * values.size());
+  return values[std::max(rank, static_cast<size_t>(1)) - 1];
+}
+
+void writeResults(const std::vector<BenchmarkResult> & results, std::ostream & out)
+{
+  out << "plugin,map_size,plans,successes,latency_p50_ms,latency_p90_ms,latency_p99_ms," <<
+    "latency_max_ms,memory_hwm_kb,mean_path_length,mean_length_ratio,mean_turning_rad\n";
+  out << std::fixed << std::setprecision(4);
+  for (const auto & result : results) {
+    const double successes = std::max(result.successes, 1u);
+    out << result.plugin << "," << result.map_size << "," << result.plans << "," <<
+      result.successes << "," <<
+      percentile(result.latencies_ms, 0.5) << "," <<
+      percentile(result.latencies_ms, 0.9) << "," <<
+      percentile(result.latencies_ms, 0.99) << "," <<
+      percentile(result.latencies_ms, 1.0) << "," <<
+      result.memory_hwm_kb << "," <<
+      result.path_length / successes << "," <<
+      result.length_ratio / successes << "," <<
+      result.turning / successes << "\n";
+  }
+}
+
+BenchmarkResult benchmarkPlugin(
+  const nav2_util::LifecycleNode::SharedPtr & node,
+  pluginlib::ClassLoader<nav2_core::GlobalPlanner> & loader,
+  const std::string & plugin,
+  const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> & costmap_ros,
+  const std::shared_ptr<tf2_ros::Buffer> & tf,
+  const unsigned int map_size,
+  const std::vector<int64_t> & seeds,
+  const unsigned int plans_per_map,
+  const double obstacle_ratio)
+{
+  BenchmarkResult result;
+  result.plugin = plugin;
+  result.map_size = map_size;
+
+  // Each plugin gets its own parameter namespace
+  std::string name = plugin;
+  std::replace(name.begin(), name.end(), '/', '_');
+  std::replace(name.begin(), name.end(), ':', '_');
+
+  resetMemoryHwm();
+
+  auto planner = loader.createSharedInstance(plugin);
+  nav2_costmap_2d::Costmap2D * costmap = costmap_ros->getCostmap();
+  planner->configure(node, name, tf, costmap_ros);
+  planner->activate();
+
+  for (const auto seed : seeds) {
+    std::mt19937 generator(seed);
+    generateMap(costmap, map_size, obstacle_ratio, generator);
+    // There are no map updates, so the planners planning on snapshots need a new one
+    costmap_ros->publishCostmapSnapshot();
+
+    for (unsigned int i = 0; i != plans_per_map; i++) {
+      const auto start = randomFreePose(costmap, costmap_ros->getGlobalFrameID(), generator);
+      const auto goal = randomFreePose(costmap, costmap_ros->getGlobalFrameID(), generator);
+
+      nav_msgs::msg::Path path;
+      const auto start_time = steady_clock::now();
+      try {
+        path = planner->createPlan(start, goal);
+      } catch (const std::exception & e) {
+        RCLCPP_DEBUG(node->get_logger(), "%s failed to plan: %s", plugin.c_str(), e.what());
+      }
+      const duration<double, std::milli> latency = steady_clock::now() - start_time;
+
+      result.plans++;
+      result.latencies_ms.push_back(latency.count());
+      if (path.poses.empty()) {
+        continue;
+      }
+
+      double length, turning;
+      measurePath(path, length, turning);
+      const double straight_line = std::hypot(
+        goal.pose.position.x - start.pose.position.x,
+        goal.pose.position.y - start.pose.position.y);
+      result.successes++;
+      result.path_length += length;
+      result.length_ratio += straight_line > 0.0 ? length / straight_line : 1.0;
+      result.turning += turning;
+    }
+  }
+
+  planner->deactivate();
+  planner->cleanup();
+  planner.reset();
+
+  result.memory_hwm_kb = readMemoryHwm();
+  return result;
+}
+
+}  // namespace nav2_system_tests
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  auto node = std::make_shared<nav2_util::LifecycleNode>("planner_benchmark");
+  node->declare_parameter("plugins", rclcpp::ParameterValue(std::vector<std::string>()));
+  node->declare_parameter(
+    "map_sizes", rclcpp::ParameterValue(std::vector<int64_t>{100, 200, 400, 800}));
+  node->declare_parameter("seeds", rclcpp::ParameterValue(std::vector<int64_t>{1, 2, 3}));
+  node->declare_parameter("plans_per_map", rclcpp::ParameterValue(20));
+  node->declare_parameter("obstacle_ratio", rclcpp::ParameterValue(0.15));
+  node->declare_parameter("output_file", rclcpp::ParameterValue("planner_benchmark.csv"));
+
+  auto plugins = node->get_parameter("plugins").as_string_array();
+  const auto map_sizes = node->get_parameter("map_sizes").as_integer_array();
+  const auto seeds = node->get_parameter("seeds").as_integer_array();
+  const int plans_per_map = node->get_parameter("plans_per_map").as_int();
+  const double obstacle_ratio = node->get_parameter("obstacle_ratio").as_double();
+  const std::string output_file = node->get_parameter("output_file").as_string();
+
+  pluginlib::ClassLoader<nav2_core::GlobalPlanner> loader(
+    "nav2_core", "nav2_core::GlobalPlanner");
+  if (plugins.empty()) {
+    plugins = loader.getDeclaredClasses();
+  }
+
+  // The planners only read the costmap, which is filled with each map, so it has no layers
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("benchmark_costmap");
+  costmap_ros->set_parameter(rclcpp::Parameter("plugins", std::vector<std::string>()));
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+  auto tf = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+
+  std::vector<nav2_system_tests::BenchmarkResult> results;
+  for (const auto & plugin : plugins) {
+    for (const auto map_size : map_sizes) {
+      RCLCPP_INFO(
+        node->get_logger(), "Benchmarking %s on %ldx%ld maps", plugin.c_str(), map_size,
+        map_size);
+      try {
+        results.push_back(
+          nav2_system_tests::benchmarkPlugin(
+            node, loader, plugin, costmap_ros, tf, map_size, seeds, plans_per_map,
+            obstacle_ratio));
+      } catch (const std::exception & e) {
+        RCLCPP_ERROR(node->get_logger(), "Failed to benchmark %s: %s", plugin.c_str(), e.what());
+        break;
+      }
+    }
+  }
+
+  nav2_system_tests::writeResults(results, std::cout);
+  std::ofstream output(output_file);
+  if (output) {
+    nav2_system_tests::writeResults(results, output);
+    RCLCPP_INFO(node->get_logger(), "Results written to %s", output_file.c_str());
+  } else {
+    RCLCPP_ERROR(node->get_logger(), "Could not write results to %s", output_file.c_str());
+  }
+
+  costmap_ros->on_cleanup(rclcpp_lifecycle::State());
+  costmap_ros.reset();
+  node.reset();
+  rclcpp::shutdown();
+
+  return 0;
+}
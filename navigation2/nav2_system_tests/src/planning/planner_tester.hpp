@@ -72,6 +72,13 @@ public:
     delete[] costmap_ptr;
     costmap_ptr = new unsigned char[prop.size_x * prop.size_y];
     std::copy(cm.data.begin(), cm.data.end(), costmap_ptr);
+    // The planners plan on costmap snapshots
+    costmap_ros_->publishCostmapSnapshot();
+  }
+
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> getCostmapROS()
+  {
+    return costmap_ros_;
   }
 
   bool createPath(
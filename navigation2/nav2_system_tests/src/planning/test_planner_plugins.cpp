@@ -13,6 +13,7 @@
 // limitations under the License. Reserved.
 
 #include <gtest/gtest.h>
+#include <future>
 #include <memory>
 #include <vector>
 #include <string>
@@ -20,6 +21,7 @@
 #include "rclcpp/rclcpp.hpp"
 #include "planner_tester.hpp"
 #include "nav2_util/lifecycle_utils.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
 
 using namespace std::chrono_literals;
 
@@ -55,6 +57,82 @@ TEST(testPluginMap, Failures)
   obj->onCleanup(state);
 }
 
+void expectSamePaths(
+  const std::vector<nav_msgs::msg::Path> & paths,
+  const std::vector<nav_msgs::msg::Path> & expected)
+{
+  ASSERT_EQ(paths.size(), expected.size());
+  for (unsigned int i = 0; i != paths.size(); i++) {
+    ASSERT_EQ(paths[i].poses.size(), expected[i].poses.size());
+    for (unsigned int j = 0; j != paths[i].poses.size(); j++) {
+      EXPECT_EQ(paths[i].poses[j].pose.position.x, expected[i].poses[j].pose.position.x);
+      EXPECT_EQ(paths[i].poses[j].pose.position.y, expected[i].poses[j].pose.position.y);
+    }
+  }
+}
+
+TEST(testPluginMap, ConcurrentBatchPlans)
+{
+  auto obj = std::make_shared<nav2_system_tests::NavFnPlannerTester>();
+  rclcpp_lifecycle::State state;
+  obj->set_parameter(rclcpp::Parameter("expected_planner_frequency", 100000.0));
+  obj->set_parameter(rclcpp::Parameter("batch_planner_threads", 4));
+  obj->onConfigure(state);
+
+  // 10x10 m with a wall in the middle, open at its top
+  auto costmap_ros = obj->getCostmapROS();
+  nav2_costmap_2d::Costmap2D * costmap = costmap_ros->getCostmap();
+  costmap->resizeMap(100, 100, 0.1, 0.0, 0.0);
+  for (unsigned int y = 0; y != 80; y++) {
+    costmap->setCost(50, y, nav2_costmap_2d::LETHAL_OBSTACLE);
+  }
+  costmap_ros->publishCostmapSnapshot();
+
+  geometry_msgs::msg::PoseStamped start;
+  start.header.frame_id = "map";
+  start.pose.position.x = 1.0;
+  start.pose.position.y = 1.0;
+  start.pose.orientation.w = 1.0;
+  std::vector<geometry_msgs::msg::PoseStamped> goals;
+  for (unsigned int i = 0; i != 16; i++) {
+    geometry_msgs::msg::PoseStamped goal = start;
+    goal.pose.position.x = 8.0;
+    goal.pose.position.y = 0.5 + 0.5 * i;
+    goals.push_back(goal);
+  }
+
+  // The plans made one at a time
+  const auto expected_batch = obj->getPlans(start, goals, "GridBased");
+  std::vector<nav_msgs::msg::Path> expected_single;
+  for (const auto & goal : goals) {
+    expected_single.push_back(obj->getPlan(start, goal, "GridBased"));
+  }
+  for (unsigned int i = 0; i != goals.size(); i++) {
+    EXPECT_FALSE(expected_batch[i].poses.empty());
+    EXPECT_FALSE(expected_single[i].poses.empty());
+  }
+
+  // The same plans, while the batch planners and the single goal one plan concurrently
+  for (unsigned int n = 0; n != 10; n++) {
+    auto batch = std::async(
+      std::launch::async, [&]() {
+        return obj->getPlans(start, goals, "GridBased");
+      });
+    std::vector<nav_msgs::msg::Path> single;
+    for (const auto & goal : goals) {
+      single.push_back(obj->getPlan(start, goal, "GridBased"));
+    }
+    expectSamePaths(batch.get(), expected_batch);
+    expectSamePaths(single, expected_single);
+  }
+
+  // Planning did not write to the costmap
+  EXPECT_EQ(costmap->getCost(10, 10), nav2_costmap_2d::FREE_SPACE);
+  EXPECT_EQ(costmap->getCost(50, 10), nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  obj->onCleanup(state);
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
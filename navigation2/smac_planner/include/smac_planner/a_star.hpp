@@ -144,6 +144,31 @@ public:
     const unsigned int & my,
     const unsigned int & dim_3);
 
+  /**
+   * @brief Confine the search to a region of the grid. Must be set before the goal,
+   * since the heuristics of the goal are confined to the region as well
+   * @param region Mask of the X-Y cells that can be expanded, nonzero if expandable,
+   * or nullptr to search the whole grid. It must outlive the search
+   */
+  void setSearchRegion(const std::vector<unsigned char> * region);
+
+  /**
+   * @brief Set the anytime search, in the style of ARA*. A first path is found quickly
+   * with an inflated heuristic, then improved lowering the weight of the heuristic and
+   * reusing the search state, until the path is optimal or the time is over
+   * @param initial_heuristic_weight Weight of the heuristic for the first path,
+   * 1 to disable the anytime search
+   * @param heuristic_weight_step Amount to lower the weight after each path,
+   * 0 or less to go straight to the optimal path
+   * @param max_search_time Maximum wall-clock time of a search in seconds, after which
+   * the best path so far is returned, 0 or less to disable. Used without the anytime
+   * search as well, failing if no path is found in time
+   */
+  void setAnytimeSearch(
+    const float & initial_heuristic_weight,
+    const float & heuristic_weight_step,
+    const double & max_search_time);
+
   /**
    * @brief Set the footprint
    * @param footprint footprint of robot
@@ -272,6 +297,18 @@ protected:
    */
   inline bool areInputsValid();
 
+  /**
+   * @brief Check if the anytime search is enabled
+   * @return If the heuristic is inflated at the start of a search
+   */
+  inline bool isAnytime();
+
+  /**
+   * @brief Lower the weight of the heuristic and prepare the search to improve the path
+   * @return If the weight was lowered, false if the search was already optimal
+   */
+  bool lowerHeuristicWeight();
+
   /**
    * @brief Clear hueristic queue of nodes to search
    */
@@ -314,6 +351,13 @@ protected:
   nav2_costmap_2d::Footprint _footprint;
   bool _is_radius_footprint;
   nav2_costmap_2d::Costmap2D * _costmap;
+  const std::vector<unsigned char> * _search_region;
+
+  float _initial_heuristic_weight;
+  float _heuristic_weight_step;
+  float _heuristic_weight;
+  double _max_search_time;
+  NodeVector _inconsistent_nodes;
 };
 
 }  // namespace smac_planner
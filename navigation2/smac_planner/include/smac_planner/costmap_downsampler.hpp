@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
 #include "smac_planner/constants.hpp"
@@ -27,7 +28,9 @@ namespace smac_planner
 
 /**
  * @class smac_planner::CostmapDownsampler
- * @brief A costmap downsampler for more efficient path planning
+ * @brief A costmap downsampler for more efficient path planning.
+ * It keeps a max-pooled pyramid of the costmap (2x, 4x, 8x, ...) that is only
+ * recomputed in the regions of the costmap that changed since the last update
  */
 class CostmapDownsampler
 {
@@ -73,12 +76,38 @@ public:
   void on_cleanup();
 
   /**
-   * @brief Downsample the given costmap by the downsampling factor, and publish the downsampled costmap
+   * @brief Downsample the given costmap by the downsampling factor, and publish the downsampled
+   * costmap of the configured factor if it is subscribed to
    * @param downsampling_factor Multiplier for the costmap resolution
    * @return A ptr to the downsampled costmap
    */
   nav2_costmap_2d::Costmap2D * downsample(const unsigned int & downsampling_factor);
 
+  /**
+   * @brief Bring the pyramid up to date with the changes in the costmap
+   */
+  void update();
+
+  /**
+   * @brief Get a level of the pyramid, as of the last update
+   * @param downsampling_factor Multiplier for the costmap resolution, a power of 2
+   * @return A ptr to the downsampled costmap, the costmap itself for a factor of 1,
+   * or nullptr if the factor is not a level of the pyramid
+   */
+  nav2_costmap_2d::Costmap2D * getLevel(const unsigned int & downsampling_factor);
+
+  /**
+   * @brief Add levels to the pyramid until reaching a downsampling factor
+   * @param downsampling_factor Multiplier for the costmap resolution of the coarsest level
+   */
+  void addLevels(const unsigned int & downsampling_factor);
+
+  /**
+   * @brief Get the largest downsampling factor in the pyramid
+   * @return The downsampling factor of the coarsest level
+   */
+  unsigned int getMaxLevelFactor() const;
+
   /**
    * @brief Resize the downsampled costmap. Used in case the costmap changes and we need to update the downsampled version
    */
@@ -91,13 +120,42 @@ protected:
   void updateCostmapSize();
 
   /**
-   * @brief Explore all subcells of the original costmap and assign the max cost to the new (downsampled) cell
-   * @param new_mx The X-coordinate of the cell in the new costmap
-   * @param new_my The Y-coordinate of the cell in the new costmap
+   * @brief Recompute the downsampled cells covering a window of the costmap
+   * @param min_x The lower X-coordinate of the window in the costmap
+   * @param min_y The lower Y-coordinate of the window in the costmap
+   * @param max_x The upper X-coordinate of the window in the costmap, exclusive
+   * @param max_y The upper Y-coordinate of the window in the costmap, exclusive
+   */
+  void updateWindow(
+    const unsigned int & min_x, const unsigned int & min_y,
+    const unsigned int & max_x, const unsigned int & max_y);
+
+  /**
+   * @brief Check if the published costmap has the costs of the configured downsampling factor
+   * @return True if the published costmap is up to date with the last update
+   */
+  bool isPublishedCostmapCurrent() const;
+
+  /**
+   * @brief Assign to a window of cells of a downsampled costmap the max cost of their subcells
+   * @param src Costs of the source costmap, row-major
+   * @param src_size_x The size X of the source costmap
+   * @param src_size_y The size Y of the source costmap
+   * @param factor Multiplier from the source to the downsampled resolution
+   * @param dst The downsampled costmap
+   * @param min_x The lower X-coordinate of the window in the downsampled costmap
+   * @param min_y The lower Y-coordinate of the window in the downsampled costmap
+   * @param max_x The upper X-coordinate of the window in the downsampled costmap, exclusive
+   * @param max_y The upper Y-coordinate of the window in the downsampled costmap, exclusive
    */
-  void setCostOfCell(
-    const unsigned int & new_mx,
-    const unsigned int & new_my);
+  void maxPool(
+    const unsigned char * src,
+    const unsigned int & src_size_x,
+    const unsigned int & src_size_y,
+    const unsigned int & factor,
+    nav2_costmap_2d::Costmap2D * dst,
+    const unsigned int & min_x, const unsigned int & min_y,
+    const unsigned int & max_x, const unsigned int & max_y);
 
   unsigned int _size_x;
   unsigned int _size_y;
@@ -106,7 +164,16 @@ protected:
   unsigned int _downsampling_factor;
   float _downsampled_resolution;
   nav2_costmap_2d::Costmap2D * _costmap;
+  // Only used for factors that are not a level of the pyramid
   std::unique_ptr<nav2_costmap_2d::Costmap2D> _downsampled_costmap;
+  // Level i has a downsampling factor of 2^(i+1)
+  std::vector<std::unique_ptr<nav2_costmap_2d::Costmap2D>> _pyramid;
+  // Costs of the costmap in the last update, to find the changed regions
+  std::vector<unsigned char> _costs;
+  std::vector<unsigned char> _row_buffer;
+  // Only the level of the downsampling factor given on configuration is published
+  unsigned int _published_factor;
+  nav2_costmap_2d::Costmap2D * _published_costmap;
   std::unique_ptr<nav2_costmap_2d::Costmap2DPublisher> _downsampled_costmap_pub;
 };
 
@@ -0,0 +1,188 @@
+// Copyright (c) 2020, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef SMAC_PLANNER__D_STAR_LITE_HPP_
+#define SMAC_PLANNER__D_STAR_LITE_HPP_
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+#include "smac_planner/node_2d.hpp"
+#include "smac_planner/constants.hpp"
+
+namespace smac_planner
+{
+
+/**
+ * @class smac_planner::DStarLite
+ * @brief An incremental D* Lite search on the 8-connected grid of a costmap. The search
+ * runs from the goal to the start and is kept between plans to the same goal, so that
+ * a new plan only repairs it around the cells whose cost changed and for the new start.
+ */
+class DStarLite
+{
+public:
+  typedef Node2D::Coordinates Coordinates;
+  typedef Node2D::CoordinateVector CoordinateVector;
+  typedef std::pair<float, float> Key;
+  typedef std::pair<Key, unsigned int> QueueElement;
+  typedef std::priority_queue<QueueElement, std::vector<QueueElement>,
+      std::greater<QueueElement>> NodeQueue;
+
+  /**
+   * @brief A constructor for smac_planner::DStarLite
+   */
+  DStarLite();
+
+  /**
+   * @brief Initialization of the planner with defaults
+   * @param allow_unknown Allow search in unknown space, good for navigation while mapping
+   * @param max_iterations Maximum number of iterations to use in a plan. The search
+   * is kept if exceeded, so a later plan goes on from where it stopped
+   */
+  void initialize(const bool & allow_unknown, const int & max_iterations);
+
+  /**
+   * @brief Set the goal for planning. Planning to a new goal searches from scratch
+   * @param mx The node X index of the goal
+   * @param my The node Y index of the goal
+   */
+  void setGoal(const unsigned int & mx, const unsigned int & my);
+
+  /**
+   * @brief Set the start for planning, which can move between plans
+   * @param mx The node X index of the start
+   * @param my The node Y index of the start
+   */
+  void setStart(const unsigned int & mx, const unsigned int & my);
+
+  /**
+   * @brief Update the costs to the costmap. The search is repaired around the
+   * changed cells, or done from scratch if the size of the costmap changed
+   * @param costmap Costmap to search, of the same frame and origin as the last one
+   * @return Number of cells whose cost changed
+   */
+  unsigned int updateCosts(const nav2_costmap_2d::Costmap2D * costmap);
+
+  /**
+   * @brief Search from scratch in the next plan
+   */
+  void reset();
+
+  /**
+   * @brief Creating path from the costs, start and goal set
+   * @param path Reference to a vector of coordinates of the path, from start to goal
+   * @param iterations Reference to number of iterations to create plan
+   * @return if plan was successful
+   */
+  bool createPath(CoordinateVector & path, int & iterations);
+
+  /**
+   * @brief Get the cost of the path from a cell to the goal found by the last search
+   * @param mx The node X index of the cell
+   * @param my The node Y index of the cell
+   * @return Cost to go, infinity if the cell cannot reach the goal
+   */
+  float getCostToGo(const unsigned int & mx, const unsigned int & my);
+
+  /**
+   * @brief Get maximum number of iterations to plan
+   * @return Reference to Maximum iterations parameter
+   */
+  int & getMaxIterations();
+
+protected:
+  /**
+   * @brief Get the key of a node in the queue
+   * @param index Index of the node
+   * @return Key, lowest first
+   */
+  inline Key calculateKey(const unsigned int & index);
+
+  /**
+   * @brief Get the heuristic cost between two nodes, a lower bound on any path
+   * @param a Index of the first node
+   * @param b Index of the second node
+   * @return Octile distance scaled by the neutral cost
+   */
+  inline float getHeuristicCost(const unsigned int & a, const unsigned int & b);
+
+  /**
+   * @brief Get the cost to enter a node from one of its neighbors
+   * @param index Index of the node
+   * @param diagonal Whether the move is diagonal
+   * @return Cost of the move, infinity if the node is not traversable
+   */
+  inline float getTraversalCost(const unsigned int & index, const bool & diagonal);
+
+  /**
+   * @brief Get the lowest cost to go of a node through its neighbors
+   * @param index Index of the node
+   * @return Lowest cost to go
+   */
+  float getLookaheadCost(const unsigned int & index);
+
+  /**
+   * @brief Put or remove a node from the queue after a change of its costs
+   * @param index Index of the node
+   */
+  void updateNode(const unsigned int & index);
+
+  /**
+   * @brief Expand the queue until the cost to go of the start is known
+   * @param iterations Reference to number of iterations done
+   * @return if the search is done, false if it exceeded the maximum iterations
+   */
+  bool computeShortestPath(int & iterations);
+
+  /**
+   * @brief Initialize the search to the goal
+   */
+  void initializeSearch();
+
+  /**
+   * @brief Call a function on the neighbors of a node in the grid
+   * @param index Index of the node
+   * @param fn Function taking the index of the neighbor and if it is diagonal
+   */
+  template<typename FunctionT>
+  inline void forEachNeighbor(const unsigned int & index, FunctionT fn);
+
+  bool _traverse_unknown;
+  int _max_iterations;
+  unsigned int _x_size;
+  unsigned int _y_size;
+  unsigned int _start_x, _start_y;
+  unsigned int _goal_x, _goal_y;
+  unsigned int _last_start;
+  float _key_modifier;
+  bool _initialized;
+
+  std::vector<unsigned char> _costs;
+  std::vector<float> _cost_to_go;
+  std::vector<float> _lookahead_cost;
+  std::vector<Key> _keys;
+  std::vector<unsigned char> _queued;
+  std::vector<unsigned char> _changed;
+  std::vector<unsigned int> _changed_nodes;
+  NodeQueue _queue;
+};
+
+}  // namespace smac_planner
+
+#endif  // SMAC_PLANNER__D_STAR_LITE_HPP_
@@ -384,11 +384,13 @@ public:
    * @param start_y Coordinate of Start Y
    * @param goal_x Coordinate of Goal X
    * @param goal_y Coordinate of Goal Y
+   * @param region Mask of the cells to expand the wavefront through, or nullptr for all
    */
   static void computeWavefrontHeuristic(
     nav2_costmap_2d::Costmap2D * & costmap,
     const unsigned int & start_x, const unsigned int & start_y,
-    const unsigned int & goal_x, const unsigned int & goal_y);
+    const unsigned int & goal_x, const unsigned int & goal_y,
+    const std::vector<unsigned char> * region = nullptr);
 
   /**
    * @brief Retrieve all valid neighbors of a node.
@@ -60,6 +60,15 @@ struct SmootherParams
     nav2_util::declare_parameter_if_not_declared(
       node, local_name + "cost_scaling_factor", rclcpp::ParameterValue(10.0));
     node->get_parameter(local_name + "cost_scaling_factor", costmap_factor);
+    nav2_util::declare_parameter_if_not_declared(
+      node, local_name + "segment_size", rclcpp::ParameterValue(0));
+    node->get_parameter(local_name + "segment_size", segment_size);
+    nav2_util::declare_parameter_if_not_declared(
+      node, local_name + "segment_overlap", rclcpp::ParameterValue(10));
+    node->get_parameter(local_name + "segment_overlap", segment_overlap);
+    nav2_util::declare_parameter_if_not_declared(
+      node, local_name + "max_threads", rclcpp::ParameterValue(1));
+    node->get_parameter(local_name + "max_threads", max_threads);
   }
 
   double smooth_weight{0.0};
@@ -69,6 +78,9 @@ struct SmootherParams
   double max_curvature{0.0};
   double costmap_factor{0.0};
   double max_time;
+  int segment_size{0};
+  int segment_overlap{10};
+  int max_threads{1};
 };
 
 /**
@@ -109,6 +109,21 @@ public:
   void removeHook(std::vector<Eigen::Vector2d> & path);
 
 protected:
+  /**
+   * @brief Search a 2D path in the coarse costmap, and mark the cells around it as the
+   * region to confine the SE2 search to
+   * @param costmap Costmap of the SE2 search
+   * @param start_x Start X, in cells of the costmap
+   * @param start_y Start Y, in cells of the costmap
+   * @param goal_x Goal X, in cells of the costmap
+   * @param goal_y Goal Y, in cells of the costmap
+   * @return whether a coarse path was found
+   */
+  bool computeCorridor(
+    nav2_costmap_2d::Costmap2D * costmap,
+    const unsigned int & start_x, const unsigned int & start_y,
+    const unsigned int & goal_x, const unsigned int & goal_y);
+
   std::unique_ptr<AStarAlgorithm<NodeSE2>> _a_star;
   std::unique_ptr<Smoother> _smoother;
   rclcpp::Clock::SharedPtr _clock;
@@ -125,6 +140,12 @@ protected:
   SmootherParams _smoother_params;
   OptimizerParams _optimizer_params;
   double _max_planning_time;
+  std::unique_ptr<AStarAlgorithm<Node2D>> _coarse_a_star;
+  std::vector<unsigned char> _coarse_corridor;
+  std::vector<unsigned char> _corridor;
+  int _hierarchical_downsampling_factor;
+  unsigned int _coarse_downsampling_factor;
+  double _hierarchical_corridor_width;
 };
 
 }  // namespace smac_planner
@@ -0,0 +1,97 @@
+// Copyright (c) 2020, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef SMAC_PLANNER__SMAC_PLANNER_D_STAR_LITE_HPP_
+#define SMAC_PLANNER__SMAC_PLANNER_D_STAR_LITE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "smac_planner/d_star_lite.hpp"
+#include "nav2_core/global_planner.hpp"
+#include "nav_msgs/msg/path.hpp"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav2_util/lifecycle_node.hpp"
+#include "nav2_util/node_utils.hpp"
+
+namespace smac_planner
+{
+
+class SmacPlannerDStarLite : public nav2_core::GlobalPlanner
+{
+public:
+  /**
+   * @brief constructor
+   */
+  SmacPlannerDStarLite();
+
+  /**
+   * @brief destructor
+   */
+  ~SmacPlannerDStarLite();
+
+  /**
+   * @brief Configuring plugin
+   * @param parent Lifecycle node pointer
+   * @param name Name of plugin map
+   * @param tf Shared ptr of TF2 buffer
+   * @param costmap_ros Costmap2DROS object
+   */
+  void configure(
+    rclcpp_lifecycle::LifecycleNode::SharedPtr parent,
+    std::string name, std::shared_ptr<tf2_ros::Buffer> tf,
+    std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros) override;
+
+  /**
+   * @brief Cleanup lifecycle node
+   */
+  void cleanup() override;
+
+  /**
+   * @brief Activate lifecycle node
+   */
+  void activate() override;
+
+  /**
+   * @brief Deactivate lifecycle node
+   */
+  void deactivate() override;
+
+  /**
+   * @brief Creating a plan from start and goal poses. Plans to the same goal
+   * repair the last search instead of searching again
+   * @param start Start pose
+   * @param goal Goal pose
+   * @return nav2_msgs::Path of the generated path
+   */
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal) override;
+
+protected:
+  std::unique_ptr<DStarLite> _d_star_lite;
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> _costmap_ros;
+  uint64_t _last_costmap_version;
+  rclcpp::Clock::SharedPtr _clock;
+  rclcpp::Logger _logger{rclcpp::get_logger("SmacPlannerDStarLite")};
+  std::string _global_frame, _name;
+  double _last_origin_x, _last_origin_y, _last_resolution;
+};
+
+}  // namespace smac_planner
+
+#endif  // SMAC_PLANNER__SMAC_PLANNER_D_STAR_LITE_HPP_
@@ -15,11 +15,14 @@
 #ifndef SMAC_PLANNER__SMOOTHER_HPP_
 #define SMAC_PLANNER__SMOOTHER_HPP_
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <vector>
 #include <iostream>
 #include <memory>
 #include <queue>
+#include <thread>
 #include <utility>
 
 #include "smac_planner/types.hpp"
@@ -105,20 +108,98 @@ public:
   {
     _options.max_solver_time_in_seconds = params.max_time;
 
-#ifdef _MSC_VER
-    std::vector<double> parameters_vec(path.size() * 2);
-    double * parameters = parameters_vec.data();
-#else
-    double parameters[path.size() * 2];  // NOLINT
-#endif
+    const int path_size = static_cast<int>(path.size());
+    if (params.segment_size < 4 || path_size <= params.segment_size) {
+      return smoothSegment(path, costmap, params, _options);
+    }
+
+    // Split the path into overlapping segments, each long enough to be smoothed
+    const int overlap = std::min(std::max(params.segment_overlap, 3), params.segment_size - 1);
+    const int stride = params.segment_size - overlap;
+    std::vector<std::pair<int, int>> segments;
+    for (int begin = 0; ; begin += stride) {
+      const int end = std::min(begin + params.segment_size, path_size);
+      segments.emplace_back(begin, end);
+      if (end == path_size) {
+        break;
+      }
+    }
+
+    // Smooth the segments on up to max_threads threads, sharing the time available
+    // between the segments each thread smooths
+    const size_t num_threads = std::min(
+      segments.size(), static_cast<size_t>(std::max(params.max_threads, 1)));
+    ceres::GradientProblemSolver::Options options = _options;
+    options.max_solver_time_in_seconds = params.max_time /
+      std::ceil(static_cast<double>(segments.size()) / num_threads);
+
+    std::vector<std::vector<Eigen::Vector2d>> smoothed_segments(segments.size());
+    std::vector<char> smoothed(segments.size(), false);
+    std::atomic<size_t> next_segment{0};
+    auto smooth_segments = [&]() {
+        for (size_t i = next_segment++; i < segments.size(); i = next_segment++) {
+          smoothed_segments[i].assign(
+            path.begin() + segments[i].first, path.begin() + segments[i].second);
+          smoothed[i] = smoothSegment(smoothed_segments[i], costmap, params, options);
+        }
+      };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; i++) {
+      threads.emplace_back(smooth_segments);
+    }
+    smooth_segments();
+    for (auto & thread : threads) {
+      thread.join();
+    }
+
+    if (std::none_of(smoothed.begin(), smoothed.end(), [](char s) {return s;})) {
+      return false;
+    }
+
+    // Stitch the segments, blending each one linearly into the previous one over
+    // their overlap, where both go from their fixed end point to the smoothed path
+    for (size_t i = 0; i != segments.size(); i++) {
+      const int begin = segments[i].first;
+      const int blend_end = i > 0 ? segments[i - 1].second : begin;
+      for (int j = begin; j != segments[i].second; j++) {
+        const Eigen::Vector2d & pt = smoothed_segments[i][j - begin];
+        if (j < blend_end) {
+          const double weight = static_cast<double>(j - begin + 1) / (blend_end - begin + 1);
+          path[j] = (1.0 - weight) * path[j] + weight * pt;
+        } else {
+          path[j] = pt;
+        }
+      }
+    }
+
+    return true;
+  }
+
+protected:
+  /**
+   * @brief Smooth a path or a segment of it, keeping its end points
+   * @param path Reference to path
+   * @param costmap Pointer to minimal costmap
+   * @param smoother parameters weights
+   * @param options Solver options
+   * @return If smoothing was successful
+   */
+  bool smoothSegment(
+    std::vector<Eigen::Vector2d> & path,
+    nav2_costmap_2d::Costmap2D * costmap,
+    const SmootherParams & params,
+    const ceres::GradientProblemSolver::Options & options) const
+  {
+    std::vector<double> parameters(path.size() * 2);
     for (unsigned int i = 0; i != path.size(); i++) {
       parameters[2 * i] = path[i][0];
       parameters[2 * i + 1] = path[i][1];
     }
 
     ceres::GradientProblemSolver::Summary summary;
-    ceres::GradientProblem problem(new UnconstrainedSmootherCostFunction(&path, costmap, params));
-    ceres::Solve(_options, problem, parameters, &summary);
+    ceres::GradientProblem problem(
+      new UnconstrainedSmootherCostFunction(&path, costmap, params));
+    ceres::Solve(options, problem, parameters.data(), &summary);
 
     if (_debug) {
       std::cout << summary.FullReport() << '\n';
@@ -136,7 +217,6 @@ public:
     return true;
   }
 
-private:
   bool _debug;
   ceres::GradientProblemSolver::Options _options;
 };
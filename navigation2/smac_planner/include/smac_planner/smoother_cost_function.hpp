@@ -46,6 +46,7 @@ public:
    * @brief A constructor for smac_planner::UnconstrainedSmootherCostFunction
    * @param original_path Original unsmoothed path to smooth
    * @param costmap A costmap to get values for collision and obstacle avoidance
+   * @param params Smoother parameters
    */
   UnconstrainedSmootherCostFunction(
     std::vector<Eigen::Vector2d> * original_path,
@@ -392,7 +393,7 @@ protected:
    * @brief Cost function derivative term for steering away from costs
    * @param weight Weight to apply to function
    * @param mx Point Xi's x coordinate in map frame
-   * @param mx Point Xi's y coordinate in map frame
+   * @param my Point Xi's y coordinate in map frame
    * @param value Point Xi's cost'
    * @param params computed values to reduce overhead
    * @param j0 Gradient of X term
@@ -419,10 +420,10 @@ protected:
 
   /**
    * @brief Computing the gradient of the costmap using
-   * the 2 point numerical differentiation method
+   * the 7 point central difference method
    * @param mx Point Xi's x coordinate in map frame
-   * @param mx Point Xi's y coordinate in map frame
-   * @param params Params reference to store gradients
+   * @param my Point Xi's y coordinate in map frame
+   * @return Normalized gradient of the costmap
    */
   inline Eigen::Vector2d getCostmapGradient(
     const unsigned int mx,
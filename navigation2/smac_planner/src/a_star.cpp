@@ -49,7 +49,12 @@ AStarAlgorithm<NodeT>::AStarAlgorithm(
   _start(nullptr),
   _goal(nullptr),
   _motion_model(motion_model),
-  _collision_checker(nullptr)
+  _collision_checker(nullptr),
+  _search_region(nullptr),
+  _initial_heuristic_weight(1.0),
+  _heuristic_weight_step(0.0),
+  _heuristic_weight(1.0),
+  _max_search_time(0.0)
 {
   _graph.reserve(100000);
 }
@@ -84,11 +89,10 @@ void AStarAlgorithm<Node2D>::createGraph(
   _dim3_size = dim_3_size;  // 2D search MUST be 2D, not 3D or SE2.
   clearGraph();
 
-  if (getSizeX() != x_size || getSizeY() != y_size) {
-    _x_size = x_size;
-    _y_size = y_size;
-    Node2D::initNeighborhood(_x_size, _motion_model);
-  }
+  // The neighborhood is shared by all the instances, which may have different sizes
+  _x_size = x_size;
+  _y_size = y_size;
+  Node2D::initNeighborhood(_x_size, _motion_model);
 }
 
 template<>
@@ -113,6 +117,23 @@ void AStarAlgorithm<NodeSE2>::createGraph(
   }
 }
 
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::setSearchRegion(const std::vector<unsigned char> * region)
+{
+  _search_region = region;
+}
+
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::setAnytimeSearch(
+  const float & initial_heuristic_weight,
+  const float & heuristic_weight_step,
+  const double & max_search_time)
+{
+  _initial_heuristic_weight = std::max(initial_heuristic_weight, 1.0f);
+  _heuristic_weight_step = heuristic_weight_step;
+  _max_search_time = max_search_time;
+}
+
 template<typename NodeT>
 void AStarAlgorithm<NodeT>::setFootprint(nav2_costmap_2d::Footprint footprint, bool use_radius)
 {
@@ -191,7 +212,7 @@ void AStarAlgorithm<NodeSE2>::setGoal(
     _costmap,
     static_cast<unsigned int>(getStart()->pose.x),
     static_cast<unsigned int>(getStart()->pose.y),
-    mx, my);
+    mx, my, _search_region);
 }
 
 template<typename NodeT>
@@ -229,6 +250,8 @@ bool AStarAlgorithm<NodeT>::createPath(
 {
   _tolerance = tolerance * NodeT::neutral_cost;
   _best_heuristic_node = {std::numeric_limits<float>::max(), 0};
+  _heuristic_weight = _initial_heuristic_weight;
+  _inconsistent_nodes.clear();
   clearQueue();
 
   if (!areInputsValid()) {
@@ -242,6 +265,7 @@ bool AStarAlgorithm<NodeT>::createPath(
   // Optimization: preallocate all variables
   NodePtr current_node = nullptr;
   NodePtr neighbor = nullptr;
+  NodePtr solution = nullptr;
   float g_cost = 0.0;
   NodeVector neighbors;
   int approach_iterations = 0;
@@ -249,6 +273,17 @@ bool AStarAlgorithm<NodeT>::createPath(
   int analytic_iterations = 0;
   int closest_distance = std::numeric_limits<int>::max();
 
+  // In the anytime search, the best path so far and its cost
+  const bool anytime = isAnytime();
+  float best_cost = std::numeric_limits<float>::max();
+  CoordinateVector candidate_path;
+  const steady_clock::time_point deadline = steady_clock::now() +
+    duration_cast<steady_clock::duration>(duration<double>(_max_search_time));
+  auto isOutOfTime = [&, this]() -> bool
+    {
+      return _max_search_time > 0.0 && steady_clock::now() > deadline;
+    };
+
   // Given an index, return a node ptr reference if its collision-free and valid
   const unsigned int max_index = getSizeX() * getSizeY() * getSizeDim3();
   NodeGetter neighborGetter =
@@ -258,11 +293,35 @@ bool AStarAlgorithm<NodeT>::createPath(
         return false;
       }
 
+      if (_search_region && !(*_search_region)[index / getSizeDim3()]) {
+        return false;
+      }
+
       neighbor_rtn = addToGraph(index);
+
+      // A visited node is not expanded again in this pass, even if it could get a lower cost
+      // from this node. Traversal costs are at least the neutral cost, so if it could,
+      // this node is searched again in the next pass
+      if (anytime && neighbor_rtn->wasVisited() &&
+        getAccumulatedCost(current_node) + NodeT::neutral_cost <
+        getAccumulatedCost(neighbor_rtn) &&
+        (_inconsistent_nodes.empty() || _inconsistent_nodes.back() != current_node))
+      {
+        _inconsistent_nodes.push_back(current_node);
+      }
       return true;
     };
 
   while (iterations < getMaxIterations() && !_queue.empty()) {
+    // 0.a) In the anytime search, once the path cannot be improved with this weight,
+    // lower it, or return the path if out of time or it is optimal
+    if (anytime && _queue.top().first >= best_cost) {
+      if (isOutOfTime() || !lowerHeuristicWeight()) {
+        return true;
+      }
+      continue;
+    }
+
     // 1) Pick Nbest from O s.t. min(f(Nbest)), remove from queue
     current_node = getNextNode();
 
@@ -274,6 +333,10 @@ bool AStarAlgorithm<NodeT>::createPath(
 
     iterations++;
 
+    if (isOutOfTime()) {
+      return best_cost < std::numeric_limits<float>::max();
+    }
+
     // 2) Mark Nbest as visited
     current_node->visited();
 
@@ -287,17 +350,41 @@ bool AStarAlgorithm<NodeT>::createPath(
     }
 
     // 3) Check if we're at the goal, backtrace if required
+    solution = nullptr;
     if (isGoal(current_node)) {
-      return backtracePath(current_node, path);
+      solution = current_node;
     } else if (_best_heuristic_node.first < getToleranceHeuristic()) {
       // Optimization: Let us find when in tolerance and refine within reason
       approach_iterations++;
       if (approach_iterations > getOnApproachMaxIterations() ||
         iterations + 1 == getMaxIterations())
       {
-        NodePtr node = &_graph.at(_best_heuristic_node.second);
-        return backtracePath(node, path);
+        solution = &_graph.at(_best_heuristic_node.second);
+      }
+    }
+
+    if (solution) {
+      if (!anytime) {
+        return backtracePath(solution, path);
+      }
+
+      // 3.a) In the anytime search, keep the path if it is the best so far,
+      // and search again with a lower weight
+      if (getAccumulatedCost(solution) < best_cost) {
+        candidate_path.clear();
+        if (backtracePath(solution, candidate_path)) {
+          path.swap(candidate_path);
+          best_cost = getAccumulatedCost(solution);
+        }
+      }
+      approach_iterations = 0;
+      if (best_cost == std::numeric_limits<float>::max()) {
+        return false;
+      }
+      if (isOutOfTime() || !lowerHeuristicWeight()) {
+        return true;
       }
+      continue;
     }
 
     // 4) Expand neighbors of Nbest not visited
@@ -320,12 +407,12 @@ bool AStarAlgorithm<NodeT>::createPath(
 
         // 4.3) If not in queue or visited, add it, `getNeighbors()` handles
         neighbor->queued();
-        addNode(g_cost + getHeuristicCost(neighbor), neighbor);
+        addNode(g_cost + _heuristic_weight * getHeuristicCost(neighbor), neighbor);
       }
     }
   }
 
-  return false;
+  return best_cost < std::numeric_limits<float>::max();
 }
 
 template<typename NodeT>
@@ -407,10 +494,64 @@ AStarAlgorithm<NodeSE2>::NodePtr AStarAlgorithm<NodeSE2>::getAnalyticPath(
       return NodePtr(nullptr);
     }
   }
-  // Legitimate path - set the parent relationships - poses already set
+  // Legitimate path - score it as the search scores its motion primitives, so the anytime
+  // search compares it fairly with the paths it finds. Each step is a primitive in the
+  // direction and turn it takes, with its traversal cost in proportion to its length
+  const MotionTable & motion_table = node->motion_table;
+  const float step_scale = d / std::max(num_intervals, 1u) /
+    std::hypot(motion_table.projections[0]._x, motion_table.projections[0]._y);
+  const unsigned int no_primitive = std::numeric_limits<unsigned int>::max();
+  unsigned int prev_primitive = node->getMotionPrimitiveIndex();
+  Coordinates step_start = node_coords;
+  float path_cost = 0.0;
+  for (unsigned int i = 0; i <= possible_nodes.size(); i++) {
+    const NodePtr & step_node = i < possible_nodes.size() ? possible_nodes[i].first : _goal;
+    const Coordinates & step_end = step_node->pose;
+    const float heading = step_start.theta * motion_table.bin_size;
+    const bool reverse = (step_end.x - step_start.x) * std::cos(heading) +
+      (step_end.y - step_start.y) * std::sin(heading) < 0.0;
+    const float turn = std::remainder(
+      step_end.theta - step_start.theta, motion_table.num_angle_quantization_float);
+    // Same indices as the primitives: forward straight, left, right, then reverse
+    // straight, and the turns of the reverse primitives with the angle decreasing then
+    // increasing
+    unsigned int primitive = std::abs(turn) < 0.01 ? 0 : (turn > 0.0 ? 1 : 2);
+    if (reverse) {
+      primitive = primitive == 0 ? 3 : 6 - primitive;
+    }
+
+    // The same traversal cost as NodeSE2::getTraversalCost
+    float travel_cost = NodeSE2::neutral_cost;
+    if (prev_primitive != no_primitive) {
+      const float travel_cost_raw = NodeSE2::neutral_cost +
+        motion_table.cost_penalty * step_node->getCost() / 252.0;
+      if (primitive == 0 || primitive == 3) {
+        travel_cost = travel_cost_raw;
+      } else if (primitive == prev_primitive) {
+        travel_cost = travel_cost_raw * motion_table.non_straight_penalty;
+      } else {
+        travel_cost = travel_cost_raw * motion_table.change_penalty;
+        travel_cost += travel_cost_raw * motion_table.non_straight_penalty;
+      }
+      if (prev_primitive > 2) {
+        travel_cost *= motion_table.reverse_penalty;
+      }
+    }
+    path_cost += travel_cost * step_scale;
+    prev_primitive = primitive;
+    step_start = step_end;
+  }
+
+  // Set the parent relationships - poses already set
   prev = node;
   for (const auto & node_pose : possible_nodes) {
     const auto & n = node_pose.first;
+    // The anytime search goes on after this path, so it can only use nodes
+    // which are not part of the search yet
+    if (isAnytime() && n->getAccumulatedCost() != std::numeric_limits<float>::max()) {
+      n->setPose(node_pose.second);
+      continue;
+    }
     if (!n->wasVisited() && n->getIndex() != _goal->getIndex()) {
       // Make sure this node has not been visited by the regular algorithm.
       // If it has been, there is the (slight) chance that it is in the path we are expanding
@@ -425,6 +566,7 @@ AStarAlgorithm<NodeSE2>::NodePtr AStarAlgorithm<NodeSE2>::getAnalyticPath(
     _goal->parent = prev;
     _goal->visited();
   }
+  _goal->setAccumulatedCost(node->getAccumulatedCost() + path_cost);
   return _goal;
 }
 
@@ -566,6 +708,59 @@ void AStarAlgorithm<NodeT>::clearGraph()
   std::swap(_graph, g);
 }
 
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::isAnytime()
+{
+  return _initial_heuristic_weight > 1.0f;
+}
+
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::lowerHeuristicWeight()
+{
+  if (_heuristic_weight <= 1.0f) {
+    return false;
+  }
+
+  // Without a step, the next search is the optimal one
+  float weight_change = _heuristic_weight - 1.0f;
+  if (_heuristic_weight_step > 0.0f) {
+    weight_change = std::min(weight_change, _heuristic_weight_step);
+  }
+  _heuristic_weight -= weight_change;
+
+  // Keep the nodes in the open set, sorted with the lower weight. All the entries
+  // of a node have the same heuristic, so they keep their order
+  std::vector<NodeElement> elements;
+  elements.reserve(_queue.size());
+  while (!_queue.empty()) {
+    NodeElement element = _queue.top();
+    _queue.pop();
+    if (!element.second.graph_node_ptr->wasVisited()) {
+      element.first -= weight_change * getHeuristicCost(element.second.graph_node_ptr);
+      elements.push_back(element);
+    }
+  }
+  NodeQueue queue(NodeComparator(), std::move(elements));
+  std::swap(_queue, queue);
+
+  // Visited nodes can be expanded again if they get a lower cost. This may change
+  // the pose of an SE2 node without lowering its cost, but only within its cell
+  for (auto & graph_node : _graph) {
+    graph_node.second.wasVisited() = false;
+  }
+
+  // And the nodes which could lower the cost of a visited node are searched again
+  for (auto & node : _inconsistent_nodes) {
+    if (!node->isQueued()) {
+      node->queued();
+      addNode(getAccumulatedCost(node) + _heuristic_weight * getHeuristicCost(node), node);
+    }
+  }
+  _inconsistent_nodes.clear();
+
+  return true;
+}
+
 template<typename NodeT>
 int & AStarAlgorithm<NodeT>::getMaxIterations()
 {
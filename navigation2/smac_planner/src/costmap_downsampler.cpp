@@ -18,13 +18,24 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 namespace smac_planner
 {
 
+// The pyramid always has at least the 2x, 4x and 8x levels
+static const unsigned int MIN_PYRAMID_FACTOR = 8;
+
+static bool isPowerOfTwo(const unsigned int & n)
+{
+  return n > 0 && (n & (n - 1)) == 0;
+}
+
 CostmapDownsampler::CostmapDownsampler()
 : _costmap(nullptr),
   _downsampled_costmap(nullptr),
+  _published_costmap(nullptr),
   _downsampled_costmap_pub(nullptr)
 {
 }
@@ -42,14 +53,24 @@ void CostmapDownsampler::on_configure(
 {
   _costmap = costmap;
   _downsampling_factor = downsampling_factor;
+  _published_factor = downsampling_factor;
   updateCostmapSize();
 
   _downsampled_costmap = std::make_unique<nav2_costmap_2d::Costmap2D>(
     _downsampled_size_x, _downsampled_size_y, _downsampled_resolution,
     _costmap->getOriginX(), _costmap->getOriginY(), UNKNOWN);
 
+  _pyramid.clear();
+  _costs.clear();
+  addLevels(std::max(MIN_PYRAMID_FACTOR, _downsampling_factor));
+
+  _published_costmap = getLevel(_downsampling_factor);
+  if (!_published_costmap) {
+    _published_costmap = _downsampled_costmap.get();
+  }
+
   _downsampled_costmap_pub = std::make_unique<nav2_costmap_2d::Costmap2DPublisher>(
-    node, _downsampled_costmap.get(), global_frame, topic_name, false);
+    node, _published_costmap, global_frame, topic_name, false);
 }
 
 void CostmapDownsampler::on_activate()
@@ -65,33 +86,122 @@ void CostmapDownsampler::on_deactivate()
 void CostmapDownsampler::on_cleanup()
 {
   _costmap = nullptr;
+  _published_costmap = nullptr;
   _downsampled_costmap.reset();
   _downsampled_costmap_pub.reset();
+  _pyramid.clear();
+  _costs.clear();
 }
 
 nav2_costmap_2d::Costmap2D * CostmapDownsampler::downsample(
   const unsigned int & downsampling_factor)
 {
-  _downsampling_factor = downsampling_factor;
+  if (isPowerOfTwo(downsampling_factor) && downsampling_factor > getMaxLevelFactor()) {
+    addLevels(downsampling_factor);
+  }
+
+  if (downsampling_factor != _downsampling_factor) {
+    // The other costmap has to be fully recomputed for the new factor
+    _downsampling_factor = downsampling_factor;
+    _costs.clear();
+  }
+
+  update();
+
+  nav2_costmap_2d::Costmap2D * costmap = getLevel(_downsampling_factor);
+  if (!costmap) {
+    costmap = _downsampled_costmap.get();
+  }
+
+  // Publishing copies the costmap, so it is skipped while nobody listens, and the
+  // changed bounds keep accumulating until then
+  if (isPublishedCostmapCurrent() && _downsampled_costmap_pub->hasSubscribers()) {
+    _downsampled_costmap_pub->publishCostmap();
+  }
+  return costmap;
+}
+
+void CostmapDownsampler::update()
+{
   updateCostmapSize();
 
   // Adjust costmap size if needed
+  const nav2_costmap_2d::Costmap2D * coarsest = _pyramid.back().get();
   if (_downsampled_costmap->getSizeInCellsX() != _downsampled_size_x ||
     _downsampled_costmap->getSizeInCellsY() != _downsampled_size_y ||
-    _downsampled_costmap->getResolution() != _downsampled_resolution)
+    _downsampled_costmap->getResolution() != _downsampled_resolution ||
+    coarsest->getResolution() != getMaxLevelFactor() * _costmap->getResolution() ||
+    coarsest->getOriginX() != _costmap->getOriginX() ||
+    coarsest->getOriginY() != _costmap->getOriginY() ||
+    _costs.size() != _size_x * _size_y)
   {
     resizeCostmap();
   }
 
-  // Assign costs
-  for (unsigned int i = 0; i < _downsampled_size_x; ++i) {
-    for (unsigned int j = 0; j < _downsampled_size_y; ++j) {
-      setCostOfCell(i, j);
+  const unsigned char * costs = _costmap->getCharMap();
+
+  if (_costs.empty()) {
+    _costs.assign(costs, costs + _size_x * _size_y);
+    updateWindow(0, 0, _size_x, _size_y);
+    return;
+  }
+
+  // Look for changes in bands of rows as high as a cell of the coarsest level,
+  // so the cells recomputed for each band do not overlap with the other bands
+  const unsigned int band_size = getMaxLevelFactor();
+  for (unsigned int min_y = 0; min_y < _size_y; min_y += band_size) {
+    const unsigned int max_y = std::min(min_y + band_size, _size_y);
+    unsigned int min_x = _size_x;
+    unsigned int max_x = 0;
+
+    for (unsigned int y = min_y; y < max_y; ++y) {
+      const unsigned char * row = costs + y * _size_x;
+      unsigned char * last_row = _costs.data() + y * _size_x;
+      if (std::memcmp(row, last_row, _size_x) == 0) {
+        continue;
+      }
+
+      unsigned int first = 0;
+      while (row[first] == last_row[first]) {
+        ++first;
+      }
+      unsigned int last = _size_x;
+      while (row[last - 1] == last_row[last - 1]) {
+        --last;
+      }
+
+      std::memcpy(last_row + first, row + first, last - first);
+      min_x = std::min(min_x, first);
+      max_x = std::max(max_x, last);
+    }
+
+    if (min_x < max_x) {
+      updateWindow(min_x, min_y, max_x, max_y);
     }
   }
+}
 
-  _downsampled_costmap_pub->publishCostmap();
-  return _downsampled_costmap.get();
+nav2_costmap_2d::Costmap2D * CostmapDownsampler::getLevel(
+  const unsigned int & downsampling_factor)
+{
+  if (downsampling_factor == 1) {
+    return _costmap;
+  }
+
+  if (!isPowerOfTwo(downsampling_factor) || downsampling_factor > getMaxLevelFactor()) {
+    return nullptr;
+  }
+
+  unsigned int level = 0;
+  while ((2u << level) < downsampling_factor) {
+    ++level;
+  }
+  return _pyramid[level].get();
+}
+
+unsigned int CostmapDownsampler::getMaxLevelFactor() const
+{
+  return 1u << _pyramid.size();
 }
 
 void CostmapDownsampler::updateCostmapSize()
@@ -111,32 +221,126 @@ void CostmapDownsampler::resizeCostmap()
     _downsampled_resolution,
     _costmap->getOriginX(),
     _costmap->getOriginY());
+
+  unsigned int size_x = _costmap->getSizeInCellsX();
+  unsigned int size_y = _costmap->getSizeInCellsY();
+  for (unsigned int i = 0; i < _pyramid.size(); ++i) {
+    size_x = (size_x + 1) / 2;
+    size_y = (size_y + 1) / 2;
+    _pyramid[i]->resizeMap(
+      size_x, size_y, (2u << i) * _costmap->getResolution(),
+      _costmap->getOriginX(), _costmap->getOriginY());
+  }
+
+  // Everything has to be recomputed
+  _costs.clear();
 }
 
-void CostmapDownsampler::setCostOfCell(
-  const unsigned int & new_mx,
-  const unsigned int & new_my)
+void CostmapDownsampler::addLevels(const unsigned int & downsampling_factor)
 {
-  unsigned int mx, my;
-  unsigned char cost = 0;
-  unsigned int x_offset = new_mx * _downsampling_factor;
-  unsigned int y_offset = new_my * _downsampling_factor;
+  while (getMaxLevelFactor() < downsampling_factor) {
+    const unsigned int factor = 2u << _pyramid.size();
+    _pyramid.push_back(
+      std::make_unique<nav2_costmap_2d::Costmap2D>(
+        ceil(static_cast<float>(_costmap->getSizeInCellsX()) / factor),
+        ceil(static_cast<float>(_costmap->getSizeInCellsY()) / factor),
+        factor * _costmap->getResolution(),
+        _costmap->getOriginX(), _costmap->getOriginY(), UNKNOWN));
+  }
 
-  for (unsigned int i = 0; i < _downsampling_factor; ++i) {
-    mx = x_offset + i;
-    if (mx >= _size_x) {
-      continue;
-    }
-    for (unsigned int j = 0; j < _downsampling_factor; ++j) {
-      my = y_offset + j;
-      if (my >= _size_y) {
-        continue;
+  // The new levels have to be computed
+  _costs.clear();
+}
+
+void CostmapDownsampler::updateWindow(
+  const unsigned int & min_x, const unsigned int & min_y,
+  const unsigned int & max_x, const unsigned int & max_y)
+{
+  // Each level is computed from the previous one, 2x2 cells at a time
+  const unsigned char * src = _costmap->getCharMap();
+  unsigned int src_size_x = _size_x;
+  unsigned int src_size_y = _size_y;
+  unsigned int x0 = min_x, y0 = min_y, x1 = max_x, y1 = max_y;
+
+  for (auto & level : _pyramid) {
+    x0 /= 2;
+    y0 /= 2;
+    x1 = (x1 + 1) / 2;
+    y1 = (y1 + 1) / 2;
+    maxPool(src, src_size_x, src_size_y, 2, level.get(), x0, y0, x1, y1);
+
+    src = level->getCharMap();
+    src_size_x = level->getSizeInCellsX();
+    src_size_y = level->getSizeInCellsY();
+  }
+
+  nav2_costmap_2d::Costmap2D * costmap = getLevel(_downsampling_factor);
+  if (!costmap) {
+    costmap = _downsampled_costmap.get();
+    maxPool(
+      _costmap->getCharMap(), _size_x, _size_y, _downsampling_factor, costmap,
+      min_x / _downsampling_factor, min_y / _downsampling_factor,
+      (max_x + _downsampling_factor - 1) / _downsampling_factor,
+      (max_y + _downsampling_factor - 1) / _downsampling_factor);
+  }
+
+  if (isPublishedCostmapCurrent()) {
+    _downsampled_costmap_pub->updateBounds(
+      min_x / _published_factor,
+      (max_x + _published_factor - 1) / _published_factor,
+      min_y / _published_factor,
+      (max_y + _published_factor - 1) / _published_factor);
+  }
+}
+
+bool CostmapDownsampler::isPublishedCostmapCurrent() const
+{
+  // The levels of the pyramid are all updated, but the other costmap only has the
+  // published factor when it was last downsampled to it
+  return _published_costmap != _downsampled_costmap.get() ||
+         _downsampling_factor == _published_factor;
+}
+
+void CostmapDownsampler::maxPool(
+  const unsigned char * src,
+  const unsigned int & src_size_x,
+  const unsigned int & src_size_y,
+  const unsigned int & factor,
+  nav2_costmap_2d::Costmap2D * dst,
+  const unsigned int & min_x, const unsigned int & min_y,
+  const unsigned int & max_x, const unsigned int & max_y)
+{
+  unsigned char * dst_costs = dst->getCharMap();
+  const unsigned int dst_size_x = dst->getSizeInCellsX();
+  const unsigned int src_min_x = min_x * factor;
+  const unsigned int src_max_x = std::min(max_x * factor, src_size_x);
+  if (src_min_x >= src_max_x) {
+    return;
+  }
+  const unsigned int width = src_max_x - src_min_x;
+  _row_buffer.resize(width);
+
+  for (unsigned int y = min_y; y < max_y; ++y) {
+    // Max of the subcells rows, element-wise over contiguous memory
+    const unsigned int src_min_y = y * factor;
+    const unsigned int src_max_y = std::min(src_min_y + factor, src_size_y);
+    const unsigned char * row = src + src_min_y * src_size_x + src_min_x;
+    std::memcpy(_row_buffer.data(), row, width);
+    for (unsigned int src_y = src_min_y + 1; src_y < src_max_y; ++src_y) {
+      row += src_size_x;
+      for (unsigned int i = 0; i < width; ++i) {
+        _row_buffer[i] = std::max(_row_buffer[i], row[i]);
       }
-      cost = std::max(cost, _costmap->getCost(mx, my));
     }
-  }
 
-  _downsampled_costmap->setCost(new_mx, new_my, cost);
+    // Max of the subcells columns
+    unsigned char * dst_row = dst_costs + y * dst_size_x;
+    for (unsigned int x = min_x; x < max_x; ++x) {
+      const unsigned int begin = (x - min_x) * factor;
+      const unsigned int end = std::min(begin + factor, width);
+      dst_row[x] = *std::max_element(_row_buffer.data() + begin, _row_buffer.data() + end);
+    }
+  }
 }
 
 }  // namespace smac_planner
@@ -0,0 +1,376 @@
+// Copyright (c) 2020, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "smac_planner/d_star_lite.hpp"
+
+namespace smac_planner
+{
+
+static const float INF_COST = std::numeric_limits<float>::infinity();
+static const float SQRT_2 = std::sqrt(2.0f);
+
+DStarLite::DStarLite()
+: _traverse_unknown(true),
+  _max_iterations(std::numeric_limits<int>::max()),
+  _x_size(0),
+  _y_size(0),
+  _start_x(0),
+  _start_y(0),
+  _goal_x(0),
+  _goal_y(0),
+  _last_start(0),
+  _key_modifier(0.0),
+  _initialized(false)
+{
+}
+
+template<typename FunctionT>
+void DStarLite::forEachNeighbor(const unsigned int & index, FunctionT fn)
+{
+  // Unlike the 2D A*, moves do not wrap around the edges of the grid
+  const unsigned int x = index % _x_size;
+  const unsigned int y = index / _x_size;
+  const bool left = x > 0, right = x + 1 < _x_size, down = y > 0, up = y + 1 < _y_size;
+
+  if (left) {fn(index - 1, false);}
+  if (right) {fn(index + 1, false);}
+  if (down) {fn(index - _x_size, false);}
+  if (up) {fn(index + _x_size, false);}
+  if (down && left) {fn(index - _x_size - 1, true);}
+  if (down && right) {fn(index - _x_size + 1, true);}
+  if (up && left) {fn(index + _x_size - 1, true);}
+  if (up && right) {fn(index + _x_size + 1, true);}
+}
+
+void DStarLite::initialize(const bool & allow_unknown, const int & max_iterations)
+{
+  _traverse_unknown = allow_unknown;
+  _max_iterations = max_iterations;
+  _initialized = false;
+}
+
+void DStarLite::setGoal(const unsigned int & mx, const unsigned int & my)
+{
+  if (mx != _goal_x || my != _goal_y) {
+    _goal_x = mx;
+    _goal_y = my;
+    _initialized = false;
+  }
+}
+
+void DStarLite::setStart(const unsigned int & mx, const unsigned int & my)
+{
+  _start_x = mx;
+  _start_y = my;
+
+  // Keys of the queue stay lower bounds when the start moves
+  const unsigned int start = _start_y * _x_size + _start_x;
+  if (_initialized && start != _last_start) {
+    _key_modifier += getHeuristicCost(_last_start, start);
+    _last_start = start;
+  }
+}
+
+void DStarLite::reset()
+{
+  _initialized = false;
+}
+
+unsigned int DStarLite::updateCosts(const nav2_costmap_2d::Costmap2D * costmap)
+{
+  const unsigned int x_size = costmap->getSizeInCellsX();
+  const unsigned int y_size = costmap->getSizeInCellsY();
+  const unsigned char * char_map = costmap->getCharMap();
+  const unsigned int size = x_size * y_size;
+
+  // A new size is a new graph, to search from scratch
+  if (x_size != _x_size || y_size != _y_size) {
+    _x_size = x_size;
+    _y_size = y_size;
+    _costs.assign(char_map, char_map + size);
+    _cost_to_go.resize(size);
+    _lookahead_cost.resize(size);
+    _keys.resize(size);
+    _queued.resize(size);
+    _changed.assign(size, 0);
+    _initialized = false;
+    return size;
+  }
+
+  // Compare row by row, most rows are the same in a replan
+  _changed_nodes.clear();
+  for (unsigned int y = 0; y != _y_size; y++) {
+    const unsigned int row = y * _x_size;
+    if (std::memcmp(&_costs[row], char_map + row, _x_size) == 0) {
+      continue;
+    }
+
+    for (unsigned int index = row; index != row + _x_size; index++) {
+      if (_costs[index] == char_map[index]) {
+        continue;
+      }
+      _costs[index] = char_map[index];
+
+      // The cost of a node is the cost to enter it, so the moves which changed
+      // are the ones from its neighbors
+      forEachNeighbor(
+        index, [this](const unsigned int & neighbor, const bool & /*diagonal*/) {
+          if (!_changed[neighbor]) {
+            _changed[neighbor] = 1;
+            _changed_nodes.push_back(neighbor);
+          }
+        });
+    }
+  }
+
+  if (!_initialized) {
+    for (const auto & index : _changed_nodes) {
+      _changed[index] = 0;
+    }
+    return static_cast<unsigned int>(_changed_nodes.size());
+  }
+
+  const unsigned int goal = _goal_y * _x_size + _goal_x;
+  for (const auto & index : _changed_nodes) {
+    _changed[index] = 0;
+    if (index != goal) {
+      _lookahead_cost[index] = getLookaheadCost(index);
+      updateNode(index);
+    }
+  }
+
+  return static_cast<unsigned int>(_changed_nodes.size());
+}
+
+bool DStarLite::createPath(CoordinateVector & path, int & iterations)
+{
+  // Check if costs were filled in
+  if (_costs.empty()) {
+    throw std::runtime_error("Failed to compute path, no costmap given.");
+  }
+
+  // Check if points are in the costmap
+  if (_start_x >= _x_size || _start_y >= _y_size || _goal_x >= _x_size || _goal_y >= _y_size) {
+    throw std::runtime_error("Failed to compute path, no valid start or goal given.");
+  }
+
+  const unsigned int goal = _goal_y * _x_size + _goal_x;
+  const unsigned int start = _start_y * _x_size + _start_x;
+
+  // Check if ending point is valid
+  if (getTraversalCost(goal, false) == INF_COST) {
+    throw std::runtime_error("Failed to compute path, goal is occupied.");
+  }
+
+  if (!_initialized) {
+    initializeSearch();
+  } else if (start != _last_start) {
+    setStart(_start_x, _start_y);
+  }
+
+  if (!computeShortestPath(iterations) || _cost_to_go[start] == INF_COST) {
+    return false;
+  }
+
+  // Follow the lowest cost to go from the start
+  path.clear();
+  path.push_back(Coordinates(_start_x, _start_y));
+  unsigned int current = start;
+  const unsigned int max_length = _x_size * _y_size;
+  while (current != goal) {
+    if (path.size() > max_length) {
+      return false;
+    }
+
+    unsigned int next = current;
+    float best_cost = INF_COST;
+    forEachNeighbor(
+      current, [&, this](const unsigned int & neighbor, const bool & diagonal) {
+        const float cost = getTraversalCost(neighbor, diagonal) + _cost_to_go[neighbor];
+        if (cost < best_cost) {
+          best_cost = cost;
+          next = neighbor;
+        }
+      });
+
+    if (next == current) {
+      return false;
+    }
+    current = next;
+    path.push_back(Node2D::getCoords(current, _x_size, 1));
+  }
+
+  return true;
+}
+
+float DStarLite::getCostToGo(const unsigned int & mx, const unsigned int & my)
+{
+  if (!_initialized || mx >= _x_size || my >= _y_size) {
+    return INF_COST;
+  }
+  return _cost_to_go[my * _x_size + mx];
+}
+
+int & DStarLite::getMaxIterations()
+{
+  return _max_iterations;
+}
+
+DStarLite::Key DStarLite::calculateKey(const unsigned int & index)
+{
+  const float cost = std::min(_cost_to_go[index], _lookahead_cost[index]);
+  return Key(cost + getHeuristicCost(_last_start, index) + _key_modifier, cost);
+}
+
+float DStarLite::getHeuristicCost(const unsigned int & a, const unsigned int & b)
+{
+  const float dx = std::abs(static_cast<float>(a % _x_size) - static_cast<float>(b % _x_size));
+  const float dy = std::abs(static_cast<float>(a / _x_size) - static_cast<float>(b / _x_size));
+  // Kept just under the cost of free moves, so rounding of equal keys cannot
+  // end the search before an underconsistent node on the path is expanded
+  return 0.999f * static_cast<float>(Node2D::neutral_cost) *
+         (std::max(dx, dy) + (SQRT_2 - 1.0f) * std::min(dx, dy));
+}
+
+float DStarLite::getTraversalCost(const unsigned int & index, const bool & diagonal)
+{
+  const unsigned char & cost = _costs[index];
+  if (cost == OCCUPIED || cost == INSCRIBED || (cost == UNKNOWN && !_traverse_unknown)) {
+    return INF_COST;
+  }
+
+  // Same costs as the 2D A*, scaled by the length of the move
+  const float traversal_cost = static_cast<float>(Node2D::neutral_cost) + 0.8f * cost;
+  return diagonal ? SQRT_2 * traversal_cost : traversal_cost;
+}
+
+float DStarLite::getLookaheadCost(const unsigned int & index)
+{
+  float cost = INF_COST;
+  forEachNeighbor(
+    index, [&, this](const unsigned int & neighbor, const bool & diagonal) {
+      cost = std::min(cost, getTraversalCost(neighbor, diagonal) + _cost_to_go[neighbor]);
+    });
+  return cost;
+}
+
+void DStarLite::updateNode(const unsigned int & index)
+{
+  // Nodes are queued again with their new key, the old entries are skipped
+  if (_cost_to_go[index] != _lookahead_cost[index]) {
+    _keys[index] = calculateKey(index);
+    _queued[index] = 1;
+    _queue.emplace(_keys[index], index);
+  } else {
+    _queued[index] = 0;
+  }
+}
+
+bool DStarLite::computeShortestPath(int & iterations)
+{
+  const unsigned int start = _last_start;
+  const unsigned int goal = _goal_y * _x_size + _goal_x;
+
+  while (!_queue.empty()) {
+    const QueueElement element = _queue.top();
+    const unsigned int & index = element.second;
+    if (!_queued[index] || element.first != _keys[index]) {
+      _queue.pop();
+      continue;
+    }
+
+    // Done once the start is consistent and no node can lower its cost
+    if (!(element.first < calculateKey(start)) &&
+      _lookahead_cost[start] == _cost_to_go[start])
+    {
+      return true;
+    }
+
+    if (iterations >= _max_iterations) {
+      return false;
+    }
+    iterations++;
+    _queue.pop();
+
+    const Key key = calculateKey(index);
+    if (element.first < key) {
+      // Key is out of date since the start moved
+      _keys[index] = key;
+      _queue.emplace(key, index);
+    } else if (_cost_to_go[index] > _lookahead_cost[index]) {
+      // Overconsistent: settle its cost and lower the cost of its neighbors
+      _cost_to_go[index] = _lookahead_cost[index];
+      _queued[index] = 0;
+      const float cost_to_go = _cost_to_go[index];
+      const bool traversable = getTraversalCost(index, false) != INF_COST;
+      if (!traversable) {
+        continue;
+      }
+      forEachNeighbor(
+        index, [&, this](const unsigned int & neighbor, const bool & diagonal) {
+          if (neighbor == goal) {
+            return;
+          }
+          const float cost = getTraversalCost(index, diagonal) + cost_to_go;
+          if (cost < _lookahead_cost[neighbor]) {
+            _lookahead_cost[neighbor] = cost;
+            updateNode(neighbor);
+          }
+        });
+    } else {
+      // Underconsistent: raise its cost and update the neighbors going through it
+      const float old_cost_to_go = _cost_to_go[index];
+      _cost_to_go[index] = INF_COST;
+      forEachNeighbor(
+        index, [&, this](const unsigned int & neighbor, const bool & diagonal) {
+          if (neighbor != goal &&
+            _lookahead_cost[neighbor] == getTraversalCost(index, diagonal) + old_cost_to_go)
+          {
+            _lookahead_cost[neighbor] = getLookaheadCost(neighbor);
+            updateNode(neighbor);
+          }
+        });
+      updateNode(index);
+    }
+  }
+
+  // Nothing left to search, the start may be unreachable
+  return true;
+}
+
+void DStarLite::initializeSearch()
+{
+  const unsigned int goal = _goal_y * _x_size + _goal_x;
+  _last_start = _start_y * _x_size + _start_x;
+  _key_modifier = 0.0;
+  std::fill(_cost_to_go.begin(), _cost_to_go.end(), INF_COST);
+  std::fill(_lookahead_cost.begin(), _lookahead_cost.end(), INF_COST);
+  std::fill(_queued.begin(), _queued.end(), 0);
+  NodeQueue queue;
+  std::swap(_queue, queue);
+
+  _lookahead_cost[goal] = 0.0;
+  updateNode(goal);
+  _initialized = true;
+}
+
+}  // namespace smac_planner
@@ -321,7 +321,8 @@ void NodeSE2::initMotionModel(
 void NodeSE2::computeWavefrontHeuristic(
   nav2_costmap_2d::Costmap2D * & costmap,
   const unsigned int & start_x, const unsigned int & start_y,
-  const unsigned int & goal_x, const unsigned int & goal_y)
+  const unsigned int & goal_x, const unsigned int & goal_y,
+  const std::vector<unsigned char> * region)
 {
   unsigned int size = costmap->getSizeInCellsX() * costmap->getSizeInCellsY();
   if (_wavefront_heuristic.size() == size) {
@@ -372,7 +373,8 @@ void NodeSE2::computeWavefrontHeuristic(
       // if neighbor is unvisited and non-lethal, set N and add to queue
       if (new_idx > 0 && new_idx < size_x * size_y &&
         _wavefront_heuristic[new_idx] == 0 &&
-        static_cast<float>(costmap->getCost(idx)) < INSCRIBED)
+        static_cast<float>(costmap->getCost(idx)) < INSCRIBED &&
+        (!region || (*region)[new_idx]))
       {
         my = new_idx / size_x;
         mx = new_idx - (my * size_x);
@@ -32,7 +32,8 @@ SmacPlanner::SmacPlanner()
 : _a_star(nullptr),
   _smoother(nullptr),
   _costmap(nullptr),
-  _costmap_downsampler(nullptr)
+  _costmap_downsampler(nullptr),
+  _coarse_a_star(nullptr)
 {
 }
 
@@ -60,6 +61,11 @@ void SmacPlanner::configure(
   int angle_quantizations;
   SearchInfo search_info;
   bool smooth_path;
+  bool hierarchical_search;
+  bool anytime_search;
+  double anytime_initial_heuristic_weight;
+  double anytime_heuristic_weight_step;
+  double anytime_max_search_time;
   std::string motion_model_for_search;
 
   // General planner params
@@ -113,6 +119,31 @@ void SmacPlanner::configure(
     node, name + ".max_planning_time_ms", rclcpp::ParameterValue(5000.0));
   node->get_parameter(name + ".max_planning_time_ms", _max_planning_time);
 
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".anytime_search", anytime_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_initial_heuristic_weight", rclcpp::ParameterValue(3.0));
+  node->get_parameter(
+    name + ".anytime_initial_heuristic_weight", anytime_initial_heuristic_weight);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_heuristic_weight_step", rclcpp::ParameterValue(0.5));
+  node->get_parameter(name + ".anytime_heuristic_weight_step", anytime_heuristic_weight_step);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_max_search_time_ms", rclcpp::ParameterValue(500.0));
+  node->get_parameter(name + ".anytime_max_search_time_ms", anytime_max_search_time);
+
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".hierarchical_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".hierarchical_search", hierarchical_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".hierarchical_downsampling_factor", rclcpp::ParameterValue(4));
+  node->get_parameter(
+    name + ".hierarchical_downsampling_factor", _hierarchical_downsampling_factor);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".hierarchical_corridor_width", rclcpp::ParameterValue(1.0));
+  node->get_parameter(name + ".hierarchical_corridor_width", _hierarchical_corridor_width);
+
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".motion_model_for_search", rclcpp::ParameterValue(std::string("DUBIN")));
   node->get_parameter(name + ".motion_model_for_search", motion_model_for_search);
@@ -149,6 +180,14 @@ void SmacPlanner::configure(
     allow_unknown,
     max_iterations,
     max_on_approach_iterations);
+
+  // The search cannot take longer than the whole planning
+  if (anytime_search) {
+    _a_star->setAnytimeSearch(
+      static_cast<float>(anytime_initial_heuristic_weight),
+      static_cast<float>(anytime_heuristic_weight_step),
+      std::min(anytime_max_search_time, _max_planning_time) / 1000.0);
+  }
   _a_star->setFootprint(costmap_ros->getRobotFootprint(), costmap_ros->getUseRadius());
 
   if (smooth_path) {
@@ -166,6 +205,30 @@ void SmacPlanner::configure(
       node, _global_frame, topic_name, _costmap, _downsampling_factor);
   }
 
+  if (hierarchical_search) {
+    // The coarse costmap is a level of the pyramid, so its factor must be a power of 2
+    const int search_factor = _costmap_downsampler ? _downsampling_factor : 1;
+    _coarse_downsampling_factor = search_factor * _hierarchical_downsampling_factor;
+    if (_hierarchical_downsampling_factor < 2 ||
+      (_coarse_downsampling_factor & (_coarse_downsampling_factor - 1)) != 0)
+    {
+      RCLCPP_WARN(
+        _logger, "Hierarchical search requires the downsampling factors to be powers of 2, "
+        "disabling hierarchical search.");
+    } else {
+      if (!_costmap_downsampler) {
+        std::string topic_name = "coarse_costmap";
+        _costmap_downsampler = std::make_unique<CostmapDownsampler>();
+        _costmap_downsampler->on_configure(
+          node, _global_frame, topic_name, _costmap, _coarse_downsampling_factor);
+      }
+      _costmap_downsampler->addLevels(_coarse_downsampling_factor);
+
+      _coarse_a_star = std::make_unique<AStarAlgorithm<Node2D>>(MotionModel::MOORE, search_info);
+      _coarse_a_star->initialize(allow_unknown, max_iterations, std::numeric_limits<int>::max());
+    }
+  }
+
   _raw_plan_publisher = node->create_publisher<nav_msgs::msg::Path>("unsmoothed_plan", 1);
 
   RCLCPP_INFO(
@@ -205,9 +268,12 @@ void SmacPlanner::cleanup()
     _logger, "Cleaning up plugin %s of type SmacPlanner",
     _name.c_str());
   _a_star.reset();
+  _coarse_a_star.reset();
   _smoother.reset();
-  _costmap_downsampler->on_cleanup();
-  _costmap_downsampler.reset();
+  if (_costmap_downsampler) {
+    _costmap_downsampler->on_cleanup();
+    _costmap_downsampler.reset();
+  }
   _raw_plan_publisher.reset();
 }
 
@@ -221,35 +287,29 @@ nav_msgs::msg::Path SmacPlanner::createPlan(
 
   // Downsample costmap, if required
   nav2_costmap_2d::Costmap2D * costmap = _costmap;
-  if (_costmap_downsampler) {
+  if (_downsample_costmap && _downsampling_factor > 1) {
     costmap = _costmap_downsampler->downsample(_downsampling_factor);
+  } else if (_coarse_a_star) {
+    _costmap_downsampler->downsample(_coarse_downsampling_factor);
   }
 
-  // Set Costmap
-  _a_star->createGraph(
-    costmap->getSizeInCellsX(),
-    costmap->getSizeInCellsY(),
-    _angle_quantizations,
-    costmap);
-
-  // Set starting point, in A* bin search coordinates
-  unsigned int mx, my;
-  costmap->worldToMap(start.pose.position.x, start.pose.position.y, mx, my);
+  // Get starting point, in A* bin search coordinates
+  unsigned int start_mx, start_my;
+  costmap->worldToMap(start.pose.position.x, start.pose.position.y, start_mx, start_my);
   double orientation_bin = tf2::getYaw(start.pose.orientation) / _angle_bin_size;
   while (orientation_bin < 0.0) {
     orientation_bin += static_cast<float>(_angle_quantizations);
   }
-  unsigned int orientation_bin_id = static_cast<unsigned int>(floor(orientation_bin));
-  _a_star->setStart(mx, my, orientation_bin_id);
+  unsigned int start_bin_id = static_cast<unsigned int>(floor(orientation_bin));
 
-  // Set goal point, in A* bin search coordinates
-  costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, mx, my);
+  // Get goal point, in A* bin search coordinates
+  unsigned int goal_mx, goal_my;
+  costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, goal_mx, goal_my);
   orientation_bin = tf2::getYaw(goal.pose.orientation) / _angle_bin_size;
   while (orientation_bin < 0.0) {
     orientation_bin += static_cast<float>(_angle_quantizations);
   }
-  orientation_bin_id = static_cast<unsigned int>(floor(orientation_bin));
-  _a_star->setGoal(mx, my, orientation_bin_id);
+  unsigned int goal_bin_id = static_cast<unsigned int>(floor(orientation_bin));
 
   // Setup message
   nav_msgs::msg::Path plan;
@@ -263,23 +323,53 @@ nav_msgs::msg::Path SmacPlanner::createPlan(
   pose.pose.orientation.z = 0.0;
   pose.pose.orientation.w = 1.0;
 
-  // Compute plan
+  // In hierarchical search, search first in the corridor of a coarse path,
+  // then in the whole costmap if there is no path in the corridor
+  bool use_corridor = _coarse_a_star &&
+    computeCorridor(costmap, start_mx, start_my, goal_mx, goal_my);
+
   NodeSE2::CoordinateVector path;
   int num_iterations = 0;
   std::string error;
-  try {
-    if (!_a_star->createPath(
-        path, num_iterations, _tolerance / static_cast<float>(costmap->getResolution())))
-    {
-      if (num_iterations < _a_star->getMaxIterations()) {
-        error = std::string("no valid path found");
-      } else {
-        error = std::string("exceeded maximum iterations");
+  while (true) {
+    // Set Costmap
+    _a_star->createGraph(
+      costmap->getSizeInCellsX(),
+      costmap->getSizeInCellsY(),
+      _angle_quantizations,
+      costmap);
+    _a_star->setSearchRegion(use_corridor ? &_corridor : nullptr);
+    _a_star->setStart(start_mx, start_my, start_bin_id);
+    _a_star->setGoal(goal_mx, goal_my, goal_bin_id);
+
+    // Compute plan
+    path.clear();
+    num_iterations = 0;
+    error.clear();
+    try {
+      if (!_a_star->createPath(
+          path, num_iterations, _tolerance / static_cast<float>(costmap->getResolution())))
+      {
+        if (num_iterations < _a_star->getMaxIterations()) {
+          error = std::string("no valid path found");
+        } else {
+          error = std::string("exceeded maximum iterations");
+        }
       }
+    } catch (const std::runtime_error & e) {
+      error = "invalid use: ";
+      error += e.what();
+    }
+
+    if (error.empty() || !use_corridor) {
+      break;
     }
-  } catch (const std::runtime_error & e) {
-    error = "invalid use: ";
-    error += e.what();
+
+    RCLCPP_DEBUG(
+      _logger,
+      "%s: %s in the corridor of the coarse path, searching the whole costmap.",
+      _name.c_str(), error.c_str());
+    use_corridor = false;
   }
 
   if (!error.empty()) {
@@ -349,6 +439,87 @@ nav_msgs::msg::Path SmacPlanner::createPlan(
   return plan;
 }
 
+bool SmacPlanner::computeCorridor(
+  nav2_costmap_2d::Costmap2D * costmap,
+  const unsigned int & start_x, const unsigned int & start_y,
+  const unsigned int & goal_x, const unsigned int & goal_y)
+{
+  const unsigned int factor = static_cast<unsigned int>(_hierarchical_downsampling_factor);
+  if (start_x >= costmap->getSizeInCellsX() || start_y >= costmap->getSizeInCellsY() ||
+    goal_x >= costmap->getSizeInCellsX() || goal_y >= costmap->getSizeInCellsY())
+  {
+    return false;
+  }
+
+  // The coarse cells of the start and goal may be blocked by obstacles next to them,
+  // so they take the cost of the start and goal during the coarse search. The level
+  // of the pyramid is modified in place and restored afterwards, instead of copied
+  nav2_costmap_2d::Costmap2D * coarse_costmap =
+    _costmap_downsampler->getLevel(_coarse_downsampling_factor);
+  const unsigned int coarse_start_x = start_x / factor;
+  const unsigned int coarse_start_y = start_y / factor;
+  const unsigned int coarse_goal_x = goal_x / factor;
+  const unsigned int coarse_goal_y = goal_y / factor;
+  const unsigned char coarse_start_cost = coarse_costmap->getCost(coarse_start_x, coarse_start_y);
+  const unsigned char coarse_goal_cost = coarse_costmap->getCost(coarse_goal_x, coarse_goal_y);
+  coarse_costmap->setCost(coarse_start_x, coarse_start_y, costmap->getCost(start_x, start_y));
+  coarse_costmap->setCost(coarse_goal_x, coarse_goal_y, costmap->getCost(goal_x, goal_y));
+
+  const unsigned int coarse_size_x = coarse_costmap->getSizeInCellsX();
+  const unsigned int coarse_size_y = coarse_costmap->getSizeInCellsY();
+  _coarse_a_star->createGraph(coarse_size_x, coarse_size_y, 1, coarse_costmap);
+  _coarse_a_star->setStart(coarse_start_x, coarse_start_y, 0);
+  _coarse_a_star->setGoal(coarse_goal_x, coarse_goal_y, 0);
+
+  Node2D::CoordinateVector coarse_path;
+  int num_iterations = 0;
+  bool found_path = false;
+  try {
+    found_path = _coarse_a_star->createPath(
+      coarse_path, num_iterations,
+      _tolerance / static_cast<float>(coarse_costmap->getResolution()));
+  } catch (const std::runtime_error &) {
+    found_path = false;
+  }
+
+  coarse_costmap->setCost(coarse_goal_x, coarse_goal_y, coarse_goal_cost);
+  coarse_costmap->setCost(coarse_start_x, coarse_start_y, coarse_start_cost);
+  if (!found_path) {
+    return false;
+  }
+
+  // Mark the coarse cells within the corridor width of the coarse path
+  const int radius = static_cast<int>(
+    std::ceil(_hierarchical_corridor_width / coarse_costmap->getResolution()));
+  _coarse_corridor.assign(coarse_size_x * coarse_size_y, 0);
+  for (const auto & coords : coarse_path) {
+    const int x = static_cast<int>(coords.x);
+    const int y = static_cast<int>(coords.y);
+    const unsigned int min_x = std::max(x - radius, 0);
+    const unsigned int max_x = std::min(x + radius + 1, static_cast<int>(coarse_size_x));
+    const unsigned int min_y = std::max(y - radius, 0);
+    const unsigned int max_y = std::min(y + radius + 1, static_cast<int>(coarse_size_y));
+    for (unsigned int my = min_y; my < max_y; ++my) {
+      auto row = _coarse_corridor.begin() + my * coarse_size_x;
+      std::fill(row + min_x, row + max_x, 1);
+    }
+  }
+
+  // Upsample the corridor to the cells of the SE2 search
+  const unsigned int size_x = costmap->getSizeInCellsX();
+  const unsigned int size_y = costmap->getSizeInCellsY();
+  _corridor.resize(size_x * size_y);
+  for (unsigned int y = 0; y < size_y; ++y) {
+    const unsigned char * coarse_row = &_coarse_corridor[(y / factor) * coarse_size_x];
+    unsigned char * row = &_corridor[y * size_x];
+    for (unsigned int x = 0; x < size_x; ++x) {
+      row[x] = coarse_row[x / factor];
+    }
+  }
+
+  return true;
+}
+
 void SmacPlanner::removeHook(std::vector<Eigen::Vector2d> & path)
 {
   // Removes the end "hooking" since goal is locked in place
@@ -57,6 +57,10 @@ void SmacPlanner2D::configure(
   int max_on_approach_iterations;
   bool smooth_path;
   double minimum_turning_radius;
+  bool anytime_search;
+  double anytime_initial_heuristic_weight;
+  double anytime_heuristic_weight_step;
+  double anytime_max_search_time;
   std::string motion_model_for_search;
 
   // General planner params
@@ -90,6 +94,20 @@ void SmacPlanner2D::configure(
     node, name + ".max_planning_time_ms", rclcpp::ParameterValue(1000.0));
   node->get_parameter(name + ".max_planning_time_ms", _max_planning_time);
 
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".anytime_search", anytime_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_initial_heuristic_weight", rclcpp::ParameterValue(3.0));
+  node->get_parameter(
+    name + ".anytime_initial_heuristic_weight", anytime_initial_heuristic_weight);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_heuristic_weight_step", rclcpp::ParameterValue(0.5));
+  node->get_parameter(name + ".anytime_heuristic_weight_step", anytime_heuristic_weight_step);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_max_search_time_ms", rclcpp::ParameterValue(500.0));
+  node->get_parameter(name + ".anytime_max_search_time_ms", anytime_max_search_time);
+
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".motion_model_for_search", rclcpp::ParameterValue(std::string("MOORE")));
   node->get_parameter(name + ".motion_model_for_search", motion_model_for_search);
@@ -122,6 +140,14 @@ void SmacPlanner2D::configure(
     max_iterations,
     max_on_approach_iterations);
 
+  // The search cannot take longer than the whole planning
+  if (anytime_search) {
+    _a_star->setAnytimeSearch(
+      static_cast<float>(anytime_initial_heuristic_weight),
+      static_cast<float>(anytime_heuristic_weight_step),
+      std::min(anytime_max_search_time, _max_planning_time) / 1000.0);
+  }
+
   if (smooth_path) {
     _smoother = std::make_unique<Smoother>();
     _optimizer_params.get(node.get(), name);
@@ -0,0 +1,191 @@
+// Copyright (c) 2020, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <string>
+#include <memory>
+#include <limits>
+
+#include "smac_planner/smac_planner_d_star_lite.hpp"
+
+namespace smac_planner
+{
+
+SmacPlannerDStarLite::SmacPlannerDStarLite()
+: _d_star_lite(nullptr),
+  _costmap_ros(nullptr),
+  _last_costmap_version(0),
+  _last_origin_x(0.0),
+  _last_origin_y(0.0),
+  _last_resolution(0.0)
+{
+}
+
+SmacPlannerDStarLite::~SmacPlannerDStarLite()
+{
+  RCLCPP_INFO(
+    _logger, "Destroying plugin %s of type SmacPlannerDStarLite",
+    _name.c_str());
+}
+
+void SmacPlannerDStarLite::configure(
+  rclcpp_lifecycle::LifecycleNode::SharedPtr node,
+  std::string name, std::shared_ptr<tf2_ros::Buffer>/*tf*/,
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros)
+{
+  _logger = node->get_logger();
+  _clock = node->get_clock();
+  _costmap_ros = costmap_ros;
+  _name = name;
+  _global_frame = costmap_ros->getGlobalFrameID();
+
+  bool allow_unknown;
+  int max_iterations;
+
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".allow_unknown", rclcpp::ParameterValue(true));
+  node->get_parameter(name + ".allow_unknown", allow_unknown);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".max_iterations", rclcpp::ParameterValue(-1));
+  node->get_parameter(name + ".max_iterations", max_iterations);
+
+  if (max_iterations <= 0) {
+    RCLCPP_INFO(
+      _logger, "maximum iteration selected as <= 0, "
+      "disabling maximum iterations.");
+    max_iterations = std::numeric_limits<int>::max();
+  }
+
+  _d_star_lite = std::make_unique<DStarLite>();
+  _d_star_lite->initialize(allow_unknown, max_iterations);
+  _last_resolution = 0.0;  // costs are given again to the new search
+
+  RCLCPP_INFO(
+    _logger, "Configured plugin %s of type SmacPlannerDStarLite with "
+    "maximum iterations %i, and %s.",
+    _name.c_str(), max_iterations,
+    allow_unknown ? "allowing unknown traversal" : "not allowing unknown traversal");
+}
+
+void SmacPlannerDStarLite::activate()
+{
+  RCLCPP_INFO(
+    _logger, "Activating plugin %s of type SmacPlannerDStarLite",
+    _name.c_str());
+}
+
+void SmacPlannerDStarLite::deactivate()
+{
+  RCLCPP_INFO(
+    _logger, "Deactivating plugin %s of type SmacPlannerDStarLite",
+    _name.c_str());
+}
+
+void SmacPlannerDStarLite::cleanup()
+{
+  RCLCPP_INFO(
+    _logger, "Cleaning up plugin %s of type SmacPlannerDStarLite",
+    _name.c_str());
+  _d_star_lite.reset();
+  _costmap_ros.reset();
+}
+
+nav_msgs::msg::Path SmacPlannerDStarLite::createPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal)
+{
+  // Plan on a snapshot of the costmap, which does not block the map updates meanwhile
+  std::shared_ptr<const nav2_costmap_2d::CostmapSnapshot> snapshot =
+    _costmap_ros->getCostmapSnapshot();
+  const nav2_costmap_2d::Costmap2D * costmap = &snapshot->costmap;
+
+  // A moved or rescaled costmap, like a rolling one, no longer matches the cells searched
+  bool reset = false;
+  if (costmap->getOriginX() != _last_origin_x || costmap->getOriginY() != _last_origin_y ||
+    costmap->getResolution() != _last_resolution)
+  {
+    _last_origin_x = costmap->getOriginX();
+    _last_origin_y = costmap->getOriginY();
+    _last_resolution = costmap->getResolution();
+    _d_star_lite->reset();
+    reset = true;
+  }
+
+  // Set goal point, a new goal is searched from scratch
+  unsigned int mx, my;
+  costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, mx, my);
+  _d_star_lite->setGoal(mx, my);
+
+  // Set starting point
+  costmap->worldToMap(start.pose.position.x, start.pose.position.y, mx, my);
+  _d_star_lite->setStart(mx, my);
+
+  // Set Costmap, only the cells changed since the last plan are repaired. The same
+  // version of the snapshot has no changed cells to look for
+  if (reset || snapshot->version != _last_costmap_version) {
+    _d_star_lite->updateCosts(costmap);
+    _last_costmap_version = snapshot->version;
+  }
+
+  // Setup message
+  nav_msgs::msg::Path plan;
+  plan.header.stamp = _clock->now();
+  plan.header.frame_id = _global_frame;
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header = plan.header;
+  pose.pose.position.z = 0.0;
+  pose.pose.orientation.x = 0.0;
+  pose.pose.orientation.y = 0.0;
+  pose.pose.orientation.z = 0.0;
+  pose.pose.orientation.w = 1.0;
+
+  // Compute plan
+  DStarLite::CoordinateVector path;
+  int num_iterations = 0;
+  std::string error;
+  try {
+    if (!_d_star_lite->createPath(path, num_iterations)) {
+      if (num_iterations < _d_star_lite->getMaxIterations()) {
+        error = std::string("no valid path found");
+      } else {
+        error = std::string("exceeded maximum iterations");
+      }
+    }
+  } catch (const std::runtime_error & e) {
+    error = "invalid use: ";
+    error += e.what();
+  }
+
+  if (!error.empty()) {
+    RCLCPP_WARN(
+      _logger,
+      "%s: failed to create plan, %s.",
+      _name.c_str(), error.c_str());
+    return plan;
+  }
+
+  // Convert to world coordinates, the path is already from start to goal
+  plan.poses.reserve(path.size());
+  for (unsigned int i = 0; i != path.size(); i++) {
+    pose.pose.position.x = costmap->getOriginX() + (path[i].x + 0.5) * costmap->getResolution();
+    pose.pose.position.y = costmap->getOriginY() + (path[i].y + 0.5) * costmap->getResolution();
+    plan.poses.push_back(pose);
+  }
+
+  return plan;
+}
+
+}  // namespace smac_planner
+
+#include "pluginlib/class_list_macros.hpp"
+PLUGINLIB_EXPORT_CLASS(smac_planner::SmacPlannerDStarLite, nav2_core::GlobalPlanner)
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "ompl/base/ScopedState.h"
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
 #include "nav2_costmap_2d/costmap_subscriber.hpp"
@@ -34,6 +35,32 @@ public:
 };
 RclCppFixture g_rclcppfixture;
 
+// Tries the analytic expansion from the start, as the search does from its nodes
+class AStarSE2Wrapper : public smac_planner::AStarAlgorithm<smac_planner::NodeSE2>
+{
+public:
+  AStarSE2Wrapper(
+    const smac_planner::MotionModel & motion_model, const smac_planner::SearchInfo & info)
+  : smac_planner::AStarAlgorithm<smac_planner::NodeSE2>(motion_model, info)
+  {
+  }
+
+  // The accumulated cost of the goal through the analytic path, negative if there is none
+  float getAnalyticPathCost()
+  {
+    getStart()->isNodeValid(_traverse_unknown, _collision_checker);
+    getGoal()->isNodeValid(_traverse_unknown, _collision_checker);
+    getStart()->setAccumulatedCost(0.0);
+    NodeGetter getter = [this](const unsigned int & index, NodePtr & node) -> bool
+      {
+        node = &(_graph.emplace(index, smac_planner::NodeSE2(index)).first->second);
+        return true;
+      };
+    NodePtr goal = getAnalyticPath(getStart(), getter);
+    return goal ? goal->getAccumulatedCost() : -1.0;
+  }
+};
+
 TEST(AStarTest, test_a_star_2d)
 {
   smac_planner::SearchInfo info;
@@ -162,6 +189,188 @@ TEST(AStarTest, test_a_star_se2)
   delete costmapA;
 }
 
+TEST(AStarTest, test_a_star_se2_search_region)
+{
+  smac_planner::SearchInfo info;
+  info.change_penalty = 1.2;
+  info.non_straight_penalty = 1.4;
+  info.reverse_penalty = 2.1;
+  info.minimum_turning_radius = 2.0;  // in grid coordinates
+  unsigned int size_theta = 72;
+  smac_planner::AStarAlgorithm<smac_planner::NodeSE2> a_star(
+    smac_planner::MotionModel::DUBIN, info);
+  int max_iterations = 10000;
+  float tolerance = 10.0;
+  int it_on_approach = 10;
+  int num_it = 0;
+
+  a_star.initialize(false, max_iterations, it_on_approach);
+  a_star.setFootprint(nav2_costmap_2d::Footprint(), true);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+
+  // corridor going up on the left of the island and then right above it
+  std::vector<unsigned char> region(100 * 100, 0);
+  for (unsigned int j = 0; j < 100; ++j) {
+    for (unsigned int i = 0; i < 100; ++i) {
+      if ((i <= 35 && j <= 90) || (j >= 65 && j <= 90)) {
+        region[j * 100 + i] = 1;
+      }
+    }
+  }
+
+  a_star.createGraph(
+    costmapA->getSizeInCellsX(), costmapA->getSizeInCellsY(), size_theta, costmapA);
+  a_star.setSearchRegion(&region);
+  a_star.setStart(10u, 10u, 0u);
+  a_star.setGoal(80u, 80u, 0u);
+  smac_planner::NodeSE2::CoordinateVector path;
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+
+  // check path is collision free and within the region
+  EXPECT_GT(path.size(), 0u);
+  for (unsigned int i = 0; i != path.size(); i++) {
+    unsigned int x = static_cast<unsigned int>(path[i].x);
+    unsigned int y = static_cast<unsigned int>(path[i].y);
+    EXPECT_EQ(costmapA->getCost(x, y), 0);
+    EXPECT_EQ(region[y * 100 + x], 1);
+  }
+
+  // a region not reaching the goal has no path
+  std::fill(region.begin() + 50 * 100, region.end(), 0);
+  a_star.createGraph(
+    costmapA->getSizeInCellsX(), costmapA->getSizeInCellsY(), size_theta, costmapA);
+  a_star.setSearchRegion(&region);
+  a_star.setStart(10u, 10u, 0u);
+  a_star.setGoal(80u, 80u, 0u);
+  path.clear();
+  num_it = 0;
+  EXPECT_FALSE(a_star.createPath(path, num_it, 0.0));
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_2d_anytime)
+{
+  smac_planner::SearchInfo info;
+  int max_iterations = 10000;
+  float tolerance = 0.0;
+  int it_on_approach = 10;
+  int num_it = 0;
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross, and walls on the sides
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+  for (unsigned int j = 0; j != 100; ++j) {
+    costmapA->setCost(0, j, 254);
+    costmapA->setCost(99, j, 254);
+  }
+
+  // the anytime search ends with the optimal path, when not limited in time
+  smac_planner::AStarAlgorithm<smac_planner::Node2D> a_star(
+    smac_planner::MotionModel::VON_NEUMANN, info);
+  a_star.initialize(false, max_iterations, it_on_approach);
+  a_star.setFootprint(nav2_costmap_2d::Footprint(), true);
+  a_star.setAnytimeSearch(3.0, 0.5, 0.0);
+  a_star.createGraph(costmapA->getSizeInCellsX(), costmapA->getSizeInCellsY(), 1, costmapA);
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoal(80u, 80u, 0);
+  smac_planner::Node2D::CoordinateVector path;
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+  EXPECT_EQ(num_it, 4667);
+  EXPECT_EQ(path.size(), 120u);
+  for (unsigned int i = 0; i != path.size(); i++) {
+    EXPECT_EQ(costmapA->getCost(path[i].x, path[i].y), 0);
+  }
+
+  // without time to find a first path, it fails
+  a_star.setAnytimeSearch(3.0, 0.5, 1e-9);
+  a_star.createGraph(costmapA->getSizeInCellsX(), costmapA->getSizeInCellsY(), 1, costmapA);
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoal(80u, 80u, 0);
+  path.clear();
+  num_it = 0;
+  EXPECT_FALSE(a_star.createPath(path, num_it, tolerance));
+  EXPECT_TRUE(path.empty());
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_se2_analytic_path_cost)
+{
+  smac_planner::SearchInfo info;
+  info.change_penalty = 1.2;
+  info.non_straight_penalty = 1.4;
+  info.reverse_penalty = 2.1;
+  info.minimum_turning_radius = 2.0;  // in grid coordinates
+  info.cost_penalty = 2.0;
+  unsigned int size_theta = 72;
+  AStarSE2Wrapper a_star(smac_planner::MotionModel::DUBIN, info);
+  a_star.initialize(false, 10000, 10);
+  a_star.setFootprint(nav2_costmap_2d::Footprint(), true);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // a band of non-lethal cost across the upper rows
+  for (unsigned int i = 40; i < 50; ++i) {
+    for (unsigned int j = 60; j < 70; ++j) {
+      costmapA->setCost(i, j, 100);
+    }
+  }
+  auto analyticPathCost = [&](unsigned int y, unsigned int goal_theta) -> float
+    {
+      a_star.createGraph(
+        costmapA->getSizeInCellsX(), costmapA->getSizeInCellsY(), size_theta, costmapA);
+      a_star.setStart(10u, y, 0u);
+      a_star.setGoal(80u, y, goal_theta);
+      return a_star.getAnalyticPathCost();
+    };
+  const smac_planner::MotionPose & forward = smac_planner::NodeSE2::motion_table.projections[0];
+  const float primitive_length = std::hypot(forward._x, forward._y);
+  const float neutral_cost = smac_planner::NodeSE2::neutral_cost;
+
+  // a straight path in free space costs the neutral cost of each primitive length
+  const float free_cost = analyticPathCost(50u, 0u);
+  EXPECT_NEAR(free_cost, 70.0 / primitive_length * neutral_cost, 1e-2);
+
+  // crossing the band adds the cost penalty of the cells crossed, as the search does
+  const float band_cost = analyticPathCost(65u, 0u);
+  EXPECT_NEAR(
+    band_cost - free_cost,
+    10.0 / primitive_length * neutral_cost * info.cost_penalty * 100.0 / 252.0, 1.5);
+
+  // turning paths have the penalties of the turns on top of their length
+  ompl::base::ScopedState<> from(smac_planner::NodeSE2::motion_table.state_space),
+  to(smac_planner::NodeSE2::motion_table.state_space);
+  from[0] = 10.0;
+  from[1] = 50.0;
+  from[2] = 0.0;
+  to[0] = 80.0;
+  to[1] = 50.0;
+  to[2] = M_PI_2;
+  const float turn_length =
+    smac_planner::NodeSE2::motion_table.state_space->distance(from(), to());
+  const float turn_cost = analyticPathCost(50u, 18u);
+  EXPECT_GT(turn_cost, turn_length / primitive_length * neutral_cost + 1.0);
+  EXPECT_LT(
+    turn_cost, turn_length / primitive_length * neutral_cost *
+    (info.change_penalty + info.non_straight_penalty));
+
+  delete costmapA;
+}
+
 TEST(AStarTest, test_constants)
 {
   smac_planner::MotionModel mm = smac_planner::MotionModel::UNKNOWN;  // unknown
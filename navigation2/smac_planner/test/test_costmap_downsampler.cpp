@@ -29,6 +29,15 @@ public:
 };
 RclCppFixture g_rclcppfixture;
 
+class DownsamplerWrapper : public smac_planner::CostmapDownsampler
+{
+public:
+  bool publishedCostmapIsCurrent() const
+  {
+    return isPublishedCostmapCurrent();
+  }
+};
+
 TEST(CostmapDownsampler, costmap_downsample_test)
 {
   nav2_util::LifecycleNode::SharedPtr node = std::make_shared<nav2_util::LifecycleNode>(
@@ -65,3 +74,78 @@ TEST(CostmapDownsampler, costmap_downsample_test)
 
   downsampler.resizeCostmap();
 }
+
+TEST(CostmapDownsampler, costmap_pyramid_test)
+{
+  nav2_util::LifecycleNode::SharedPtr node = std::make_shared<nav2_util::LifecycleNode>(
+    "CostmapDownsamplerTest");
+  smac_planner::CostmapDownsampler downsampler;
+
+  nav2_costmap_2d::Costmap2D costmap(20, 20, 0.05, 0.0, 0.0, 0);
+  costmap.setCost(19, 19, 100);
+
+  downsampler.on_configure(node, "map", "unused_topic", &costmap, 2);
+  EXPECT_EQ(downsampler.getMaxLevelFactor(), 8u);
+  downsampler.update();
+
+  EXPECT_EQ(downsampler.getLevel(1), &costmap);
+  EXPECT_EQ(downsampler.getLevel(3), nullptr);
+  EXPECT_EQ(downsampler.getLevel(16), nullptr);
+
+  nav2_costmap_2d::Costmap2D * level8 = downsampler.getLevel(8);
+  EXPECT_EQ(level8->getSizeInCellsX(), 3u);
+  EXPECT_EQ(level8->getSizeInCellsY(), 3u);
+  EXPECT_NEAR(level8->getResolution(), 0.4, 1e-6);
+  EXPECT_EQ(level8->getCost(2, 2), 100);
+  EXPECT_EQ(downsampler.getLevel(4)->getCost(4, 4), 100);
+
+  // Only the changed regions are recomputed, in every level
+  costmap.setCost(19, 19, 0);
+  costmap.setCost(1, 9, 200);
+  nav2_costmap_2d::Costmap2D * level2 = downsampler.downsample(2);
+  EXPECT_EQ(level2, downsampler.getLevel(2));
+  EXPECT_EQ(level2->getCost(9, 9), 0);
+  EXPECT_EQ(level2->getCost(0, 4), 200);
+  EXPECT_EQ(downsampler.getLevel(4)->getCost(4, 4), 0);
+  EXPECT_EQ(downsampler.getLevel(4)->getCost(0, 2), 200);
+  EXPECT_EQ(level8->getCost(2, 2), 0);
+  EXPECT_EQ(level8->getCost(0, 1), 200);
+
+  // Factors that are not a level of the pyramid are computed directly
+  nav2_costmap_2d::Costmap2D * downsampled3 = downsampler.downsample(3);
+  EXPECT_EQ(downsampled3->getSizeInCellsX(), 7u);
+  EXPECT_EQ(downsampled3->getCost(0, 3), 200);
+
+  // Larger factors add levels to the pyramid
+  nav2_costmap_2d::Costmap2D * downsampled16 = downsampler.downsample(16);
+  EXPECT_EQ(downsampler.getMaxLevelFactor(), 16u);
+  EXPECT_EQ(downsampled16->getSizeInCellsX(), 2u);
+  EXPECT_EQ(downsampled16->getCost(0, 0), 200);
+}
+
+TEST(CostmapDownsampler, costmap_published_level_test)
+{
+  nav2_util::LifecycleNode::SharedPtr node = std::make_shared<nav2_util::LifecycleNode>(
+    "CostmapDownsamplerTest");
+  DownsamplerWrapper downsampler;
+
+  nav2_costmap_2d::Costmap2D costmap(20, 20, 0.05, 0.0, 0.0, 0);
+
+  // The costmap of a factor which is not a level only has the configured factor once
+  // downsampled to it again
+  downsampler.on_configure(node, "map", "unused_topic", &costmap, 3);
+  downsampler.downsample(3);
+  EXPECT_TRUE(downsampler.publishedCostmapIsCurrent());
+  downsampler.downsample(4);
+  EXPECT_FALSE(downsampler.publishedCostmapIsCurrent());
+  downsampler.downsample(3);
+  EXPECT_TRUE(downsampler.publishedCostmapIsCurrent());
+
+  // The levels are always up to date
+  downsampler.on_configure(node, "map", "unused_topic", &costmap, 2);
+  downsampler.downsample(4);
+  EXPECT_TRUE(downsampler.publishedCostmapIsCurrent());
+  downsampler.downsample(5);
+  EXPECT_TRUE(downsampler.publishedCostmapIsCurrent());
+  EXPECT_EQ(downsampler.getLevel(2)->getSizeInCellsX(), 10u);
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2020, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <math.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_util/lifecycle_node.hpp"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "smac_planner/d_star_lite.hpp"
+#include "smac_planner/smac_planner_d_star_lite.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+void checkPath(
+  const smac_planner::DStarLite::CoordinateVector & path,
+  nav2_costmap_2d::Costmap2D * costmap,
+  const unsigned int & start_x, const unsigned int & start_y,
+  const unsigned int & goal_x, const unsigned int & goal_y)
+{
+  ASSERT_FALSE(path.empty());
+  EXPECT_EQ(path.front().x, start_x);
+  EXPECT_EQ(path.front().y, start_y);
+  EXPECT_EQ(path.back().x, goal_x);
+  EXPECT_EQ(path.back().y, goal_y);
+
+  // check path is connected and collision free
+  for (unsigned int i = 1; i != path.size(); i++) {
+    EXPECT_LE(fabs(path[i].x - path[i - 1].x), 1.0);
+    EXPECT_LE(fabs(path[i].y - path[i - 1].y), 1.0);
+    EXPECT_EQ(costmap->getCost(path[i].x, path[i].y), 0);
+  }
+}
+
+TEST(DStarLiteTest, test_d_star_lite)
+{
+  smac_planner::DStarLite d_star_lite;
+  d_star_lite.initialize(false, 100000);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+
+  // first plan searches from scratch
+  smac_planner::DStarLite::CoordinateVector path;
+  int num_it = 0;
+  d_star_lite.setGoal(80u, 80u);
+  d_star_lite.setStart(20u, 20u);
+  EXPECT_EQ(d_star_lite.updateCosts(costmapA), 10000u);
+  EXPECT_TRUE(d_star_lite.createPath(path, num_it));
+  EXPECT_EQ(num_it, 1939);
+  EXPECT_EQ(path.size(), 82u);
+  checkPath(path, costmapA, 20u, 20u, 80u, 80u);
+  const float cost_to_go = d_star_lite.getCostToGo(20u, 20u);
+  EXPECT_NEAR(cost_to_go, 4857.71, 0.1);
+
+  // nothing changed, the search is already done
+  num_it = 0;
+  EXPECT_EQ(d_star_lite.updateCosts(costmapA), 0u);
+  EXPECT_TRUE(d_star_lite.createPath(path, num_it));
+  EXPECT_EQ(num_it, 0);
+  EXPECT_EQ(path.size(), 82u);
+
+  // a wall closing the way below the island is repaired with fewer iterations
+  // than a new search
+  for (unsigned int j = 0; j < 40; ++j) {
+    costmapA->setCost(50, j, 254);
+  }
+  num_it = 0;
+  EXPECT_GT(d_star_lite.updateCosts(costmapA), 0u);
+  EXPECT_TRUE(d_star_lite.createPath(path, num_it));
+  checkPath(path, costmapA, 20u, 20u, 80u, 80u);
+
+  smac_planner::DStarLite d_star_lite_scratch;
+  d_star_lite_scratch.initialize(false, 100000);
+  d_star_lite_scratch.setGoal(80u, 80u);
+  d_star_lite_scratch.setStart(20u, 20u);
+  d_star_lite_scratch.updateCosts(costmapA);
+  smac_planner::DStarLite::CoordinateVector path_scratch;
+  int num_it_scratch = 0;
+  EXPECT_TRUE(d_star_lite_scratch.createPath(path_scratch, num_it_scratch));
+  EXPECT_LT(num_it, num_it_scratch);
+  EXPECT_NEAR(d_star_lite.getCostToGo(20u, 20u), d_star_lite_scratch.getCostToGo(20u, 20u), 0.1);
+  // the way above the island costs the same, by symmetry
+  EXPECT_NEAR(d_star_lite.getCostToGo(20u, 20u), cost_to_go, 0.1);
+  EXPECT_GT(path[41].y, 60.0);
+
+  // moving the start along the path reuses the search
+  num_it = 0;
+  d_star_lite.setStart(path[10].x, path[10].y);
+  EXPECT_EQ(d_star_lite.updateCosts(costmapA), 0u);
+  EXPECT_TRUE(d_star_lite.createPath(path, num_it));
+  EXPECT_LT(num_it, 10);
+  checkPath(path, costmapA, path.front().x, path.front().y, 80u, 80u);
+
+  // the goal cannot be reached anymore
+  for (unsigned int i = 75; i <= 85; ++i) {
+    costmapA->setCost(i, 75, 254);
+    costmapA->setCost(i, 85, 254);
+    costmapA->setCost(75, i, 254);
+    costmapA->setCost(85, i, 254);
+  }
+  num_it = 0;
+  d_star_lite.updateCosts(costmapA);
+  EXPECT_FALSE(d_star_lite.createPath(path, num_it));
+  EXPECT_TRUE(std::isinf(d_star_lite.getCostToGo(path.front().x, path.front().y)));
+
+  // invalid goal
+  d_star_lite.setGoal(50u, 50u);
+  EXPECT_THROW(d_star_lite.createPath(path, num_it), std::runtime_error);
+
+  // out of bounds start
+  d_star_lite.setGoal(80u, 80u);
+  d_star_lite.setStart(200u, 200u);
+  EXPECT_THROW(d_star_lite.createPath(path, num_it), std::runtime_error);
+
+  delete costmapA;
+}
+
+TEST(DStarLiteTest, test_d_star_lite_max_iterations)
+{
+  smac_planner::DStarLite d_star_lite;
+  d_star_lite.initialize(false, 1000);
+  EXPECT_EQ(d_star_lite.getMaxIterations(), 1000);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+
+  // the search is kept when exceeding the iterations, and goes on in the next plan
+  smac_planner::DStarLite::CoordinateVector path;
+  int num_it = 0;
+  d_star_lite.setGoal(80u, 80u);
+  d_star_lite.setStart(20u, 20u);
+  d_star_lite.updateCosts(costmapA);
+  EXPECT_FALSE(d_star_lite.createPath(path, num_it));
+  EXPECT_EQ(num_it, 1000);
+  num_it = 0;
+  EXPECT_TRUE(d_star_lite.createPath(path, num_it));
+  EXPECT_LT(num_it, 1000);
+  checkPath(path, costmapA, 20u, 20u, 80u, 80u);
+
+  // a new size searches from scratch
+  nav2_costmap_2d::Costmap2D * costmapB =
+    new nav2_costmap_2d::Costmap2D(50, 50, 0.1, 0.0, 0.0, 0);
+  d_star_lite.setGoal(45u, 45u);
+  d_star_lite.setStart(5u, 5u);
+  EXPECT_EQ(d_star_lite.updateCosts(costmapB), 2500u);
+  num_it = 0;
+  EXPECT_TRUE(d_star_lite.createPath(path, num_it));
+  checkPath(path, costmapB, 5u, 5u, 45u, 45u);
+
+  delete costmapA;
+  delete costmapB;
+}
+
+// Smoke test for plugin-level issues, the algorithm is tested above
+TEST(DStarLiteTest, test_smac_d_star_lite)
+{
+  rclcpp_lifecycle::LifecycleNode::SharedPtr nodeDStarLite =
+    std::make_shared<rclcpp_lifecycle::LifecycleNode>("SmacDStarLiteTest");
+
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros =
+    std::make_shared<nav2_costmap_2d::Costmap2DROS>("global_costmap");
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+
+  geometry_msgs::msg::PoseStamped start, goal;
+  start.pose.position.x = 0.0;
+  start.pose.position.y = 0.0;
+  start.pose.orientation.w = 1.0;
+  goal = start;
+  auto planner = std::make_unique<smac_planner::SmacPlannerDStarLite>();
+  planner->configure(nodeDStarLite, "test", nullptr, costmap_ros);
+  planner->activate();
+  try {
+    planner->createPlan(start, goal);
+    planner->createPlan(start, goal);
+  } catch (...) {
+  }
+
+  planner->deactivate();
+  planner->cleanup();
+
+  planner.reset();
+  costmap_ros->on_cleanup(rclcpp_lifecycle::State());
+  nodeDStarLite.reset();
+  costmap_ros.reset();
+}
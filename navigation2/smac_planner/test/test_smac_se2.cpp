@@ -15,6 +15,7 @@
 #include <math.h>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -37,6 +38,17 @@ public:
 };
 RclCppFixture g_rclcppfixture;
 
+class SmacPlannerWrapper : public smac_planner::SmacPlanner
+{
+public:
+  using smac_planner::SmacPlanner::computeCorridor;
+
+  std::vector<unsigned char> & getCorridor()
+  {
+    return _corridor;
+  }
+};
+
 // SMAC smoke tests for plugin-level issues rather than algorithms
 // (covered by more extensively testing in other files)
 // System tests in nav2_system_tests will actually plan with this work
@@ -80,6 +92,93 @@ TEST(SmacTest, test_smac_se2)
   nodeSE2.reset();
 }
 
+TEST(SmacTest, test_smac_se2_hierarchical)
+{
+  rclcpp_lifecycle::LifecycleNode::SharedPtr nodeSE2 =
+    std::make_shared<rclcpp_lifecycle::LifecycleNode>("SmacSE2HierarchicalTest");
+
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros =
+    std::make_shared<nav2_costmap_2d::Costmap2DROS>("global_costmap");
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+
+  // U-shaped obstacle opening towards the start, that a search only guided by
+  // the distance to the goal floods before going around it
+  nav2_costmap_2d::Costmap2D * costmap = costmap_ros->getCostmap();
+  for (unsigned int i = 10; i <= 40; ++i) {
+    costmap->setCost(30, i, 254);
+  }
+  for (unsigned int i = 15; i <= 30; ++i) {
+    costmap->setCost(i, 10, 254);
+    costmap->setCost(i, 40, 254);
+  }
+
+  geometry_msgs::msg::PoseStamped start, goal;
+  start.pose.position.x = 0.55;
+  start.pose.position.y = 2.55;
+  start.pose.orientation.w = 1.0;
+  goal.pose.position.x = 4.55;
+  goal.pose.position.y = 2.55;
+  goal.pose.orientation.w = 1.0;
+
+  // Both the full and the hierarchical search find a path
+  std::unique_ptr<SmacPlannerWrapper> hierarchical_planner;
+  for (bool hierarchical : {false, true}) {
+    std::string name = hierarchical ? "hierarchical" : "full";
+    nodeSE2->declare_parameter(name + ".hierarchical_search", hierarchical);
+    nodeSE2->declare_parameter(name + ".hierarchical_corridor_width", 0.5);
+
+    auto planner = std::make_unique<SmacPlannerWrapper>();
+    planner->configure(nodeSE2, name, nullptr, costmap_ros);
+    planner->activate();
+    EXPECT_GT(planner->createPlan(start, goal).poses.size(), 0u);
+
+    if (hierarchical) {
+      hierarchical_planner = std::move(planner);
+    } else {
+      planner->deactivate();
+      planner->cleanup();
+    }
+  }
+
+  // The search confined to the corridor of the coarse path expands fewer nodes
+  ASSERT_TRUE(hierarchical_planner->computeCorridor(costmap, 5u, 25u, 45u, 25u));
+  std::vector<unsigned char> corridor = hierarchical_planner->getCorridor();
+
+  smac_planner::SearchInfo info;
+  info.change_penalty = 1.2;
+  info.non_straight_penalty = 1.4;
+  info.reverse_penalty = 2.1;
+  info.minimum_turning_radius = 2.0;  // in grid coordinates
+  unsigned int size_theta = 72;
+  smac_planner::AStarAlgorithm<smac_planner::NodeSE2> a_star(
+    smac_planner::MotionModel::DUBIN, info);
+  int max_iterations = 1000000;
+  a_star.initialize(false, max_iterations, 10);
+  a_star.setFootprint(nav2_costmap_2d::Footprint(), true);
+
+  std::vector<int> iterations;
+  for (bool use_corridor : {false, true}) {
+    a_star.createGraph(
+      costmap->getSizeInCellsX(), costmap->getSizeInCellsY(), size_theta, costmap);
+    a_star.setSearchRegion(use_corridor ? &corridor : nullptr);
+    a_star.setStart(5u, 25u, 0u);
+    a_star.setGoal(45u, 25u, 0u);
+    smac_planner::NodeSE2::CoordinateVector path;
+    int num_it = 0;
+    EXPECT_TRUE(a_star.createPath(path, num_it, 10.0));
+    iterations.push_back(num_it);
+  }
+  EXPECT_LT(iterations[1], iterations[0]);
+
+  hierarchical_planner->deactivate();
+  hierarchical_planner->cleanup();
+  hierarchical_planner.reset();
+
+  costmap_ros->on_cleanup(rclcpp_lifecycle::State());
+  costmap_ros.reset();
+  nodeSE2.reset();
+}
+
 TEST(SmacTestSE2, test_dist)
 {
   Eigen::Vector2d p1;
@@ -13,6 +13,7 @@
 // limitations under the License. Reserved.
 
 #include <math.h>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -100,5 +101,62 @@ TEST(SmootherTest, test_smoother)
       hypot(path[i][0] - path[i + 1][0], path[i][1] - path[i + 1][1]), 1.407170, 0.5);
   }
 
+  // smoothing overlapping segments keeps the end points, keeps the path continuous
+  // across the seams between segments, and gets at least half of the improvement
+  // of smoothing the whole path
+  smoother_params.smooth_weight = 1.0;
+  std::vector<Eigen::Vector2d> whole_path = initial_path;
+  EXPECT_TRUE(smoother.smooth(whole_path, costmap, smoother_params));
+
+  std::vector<Eigen::Vector2d> segmented_path = initial_path;
+  smoother_params.segment_size = 20;
+  smoother_params.segment_overlap = 5;
+  smoother_params.max_threads = 2;
+  EXPECT_TRUE(smoother.smooth(segmented_path, costmap, smoother_params));
+
+  EXPECT_EQ(segmented_path.size(), 73u);
+  EXPECT_EQ(segmented_path.front(), initial_path.front());
+  EXPECT_EQ(segmented_path.back(), initial_path.back());
+  for (unsigned int i = 1; i != segmented_path.size() - 1; i++) {
+    EXPECT_NEAR(
+      hypot(
+        segmented_path[i][0] - segmented_path[i + 1][0],
+        segmented_path[i][1] - segmented_path[i + 1][1]), 1.407170, 0.5);
+  }
+
+  // no kink at the seams sharper than the sharpest one of the unsmoothed path
+  auto kink = [](const std::vector<Eigen::Vector2d> & p, const unsigned int i) {
+      return (p[i - 1] - 2.0 * p[i] + p[i + 1]).norm();
+    };
+  double max_kink = 0.0;
+  for (unsigned int i = 1; i != initial_path.size() - 1; i++) {
+    max_kink = std::max(max_kink, kink(initial_path, i));
+  }
+  // the segments start every 15 points, and each overlap ends 20 points after it starts
+  for (unsigned int seam_end = 20; seam_end < segmented_path.size() - 1; seam_end += 15) {
+    for (unsigned int i = seam_end - 5; i <= seam_end; i++) {
+      EXPECT_LE(kink(segmented_path, i), max_kink);
+    }
+  }
+
+  auto path_cost = [&](const std::vector<Eigen::Vector2d> & p) {
+      smac_planner::UnconstrainedSmootherCostFunction cost_function(
+        &initial_path, costmap, smoother_params);
+      std::vector<double> parameters;
+      for (const auto & pt : p) {
+        parameters.push_back(pt[0]);
+        parameters.push_back(pt[1]);
+      }
+      std::vector<double> gradient(parameters.size());
+      double cost = 0.0;
+      cost_function.Evaluate(parameters.data(), &cost, gradient.data());
+      return cost;
+    };
+  const double initial_cost = path_cost(initial_path);
+  const double whole_cost = path_cost(whole_path);
+  const double segmented_cost = path_cost(segmented_path);
+  EXPECT_LT(whole_cost, initial_cost);
+  EXPECT_LE(segmented_cost, initial_cost - 0.5 * (initial_cost - whole_cost));
+
   delete costmap;
 }
@@ -33,6 +33,14 @@
 namespace plansys2
 {
 
+/// Action performer that executes a Behavior Tree.
+/**
+ * The XML is parsed once when the node is configured, and the tree for the next
+ * activation is built from it ahead of time. Each activation takes that tree and only
+ * sets the arguments of the action in the blackboard. On deactivation, the tree is
+ * halted and discarded, and a fresh one is built for the next activation, so no node
+ * state leaks from one execution to the next.
+ */
 class BTAction : public plansys2::ActionExecutorClient
 {
 public:
@@ -61,7 +69,9 @@ protected:
   BT::BehaviorTreeFactory factory_;
 
 private:
+  std::unique_ptr<BT::XMLParser> parser_;
   BT::Tree tree_;
+  BT::Tree next_tree_;
   BT::Blackboard::Ptr blackboard_;
   std::string action_;
   std::string bt_xml_file_;
@@ -63,6 +63,17 @@ BTAction::on_configure(const rclcpp_lifecycle::State & previous_state)
   blackboard_ = BT::Blackboard::create();
   blackboard_->set("node", node);
 
+  try {
+    parser_ = std::make_unique<BT::XMLParser>(factory_);
+    parser_->loadFromFile(bt_xml_file_);
+    next_tree_ = parser_->instantiateTree(blackboard_);
+  } catch (const std::exception & e) {
+    RCLCPP_ERROR_STREAM(get_logger(), "Error loading BT [" << bt_xml_file_ << "]: " << e.what());
+    parser_.reset();
+    next_tree_ = BT::Tree();
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+  }
+
   return ActionExecutorClient::on_configure(previous_state);
 }
 
@@ -70,13 +81,20 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 BTAction::on_cleanup(const rclcpp_lifecycle::State & previous_state)
 {
   publisher_zmq_.reset();
+  tree_ = BT::Tree();
+  next_tree_ = BT::Tree();
+  parser_.reset();
   return ActionExecutorClient::on_cleanup(previous_state);
 }
 
 rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 BTAction::on_activate(const rclcpp_lifecycle::State & previous_state)
 {
-  tree_ = factory_.createTreeFromFile(bt_xml_file_, blackboard_);
+  if (next_tree_.rootNode() == nullptr) {
+    next_tree_ = parser_->instantiateTree(blackboard_);
+  }
+  tree_ = std::move(next_tree_);
+  next_tree_ = BT::Tree();
 
   for (int i = 0; i < get_arguments().size(); i++) {
     std::string argname = "arg" + std::to_string(i);
@@ -118,7 +136,20 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 BTAction::on_deactivate(const rclcpp_lifecycle::State & previous_state)
 {
   publisher_zmq_.reset();
-  tree_.haltTree();
+
+  if (tree_.rootNode() != nullptr) {
+    tree_.haltTree();
+    tree_ = BT::Tree();
+  }
+
+  // The nodes of a halted tree may keep state from this execution, so the tree
+  // for the next activation is built from scratch, while the action is idle
+  try {
+    next_tree_ = parser_->instantiateTree(blackboard_);
+  } catch (const std::exception & e) {
+    RCLCPP_ERROR_STREAM(get_logger(), "Error building BT [" << bt_xml_file_ << "]: " << e.what());
+    next_tree_ = BT::Tree();
+  }
 
   return ActionExecutorClient::on_deactivate(previous_state);
 }
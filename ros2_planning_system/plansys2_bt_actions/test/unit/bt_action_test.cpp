@@ -166,6 +166,75 @@ TEST(bt_actions, bt_action)
   }
 }
 
+TEST(bt_actions, bt_action_reuse_tree)
+{
+  std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_bt_actions");
+  std::string xml_file = pkgpath + "/test/behavior_tree/assemble.xml";
+
+  std::vector<std::string> plugins = {
+    "plansys2_close_gripper_bt_node", "plansys2_open_gripper_bt_node"};
+
+  auto bt_action = std::make_shared<plansys2::BTAction>("assemble", 100ms);
+
+  auto lc_node = rclcpp_lifecycle::LifecycleNode::make_shared("test_node");
+
+  bt_action->set_parameter(rclcpp::Parameter("action_name", "assemble"));
+  bt_action->set_parameter(rclcpp::Parameter("bt_xml_file", xml_file));
+  bt_action->set_parameter(rclcpp::Parameter("plugins", plugins));
+
+  bt_action->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+  ASSERT_EQ(
+    bt_action->get_current_state().id(), lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE);
+
+  rclcpp::executors::MultiThreadedExecutor exe;
+  exe.add_node(bt_action->get_node_base_interface());
+  exe.add_node(lc_node->get_node_base_interface());
+
+  // A first execution is cancelled while its nodes are running
+  {
+    auto action_client = plansys2::ActionExecutor::make_shared(
+      "(assemble r2d2 z p1 p2 p3)", lc_node);
+
+    auto start = lc_node->now();
+    while ((lc_node->now() - start).seconds() < 0.5) {
+      exe.spin_some();
+      action_client->tick(lc_node->now());
+    }
+    ASSERT_EQ(
+      bt_action->get_current_state().id(), lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE);
+
+    action_client->cancel();
+
+    start = lc_node->now();
+    while ((lc_node->now() - start).seconds() < 1) {
+      exe.spin_some();
+    }
+    ASSERT_EQ(
+      bt_action->get_current_state().id(), lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE);
+  }
+
+  // The next executions run on a fresh tree built from the already parsed XML
+  for (const auto & action : {"(assemble r2d2 y p4 p5 p6)", "(assemble r2d2 x p7 p8 p9)"}) {
+    auto action_client = plansys2::ActionExecutor::make_shared(action, lc_node);
+
+    bool finished = false;
+    while (rclcpp::ok && !finished) {
+      exe.spin_some();
+
+      action_client->tick(lc_node->now());
+      finished = action_client->get_status() == BT::NodeStatus::SUCCESS;
+    }
+
+    auto start = lc_node->now();
+    while ((lc_node->now() - start).seconds() < 1) {
+      exe.spin_some();
+    }
+
+    ASSERT_EQ(
+      bt_action->get_current_state().id(), lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE);
+  }
+}
+
 TEST(bt_actions, cancel_bt_action)
 {
   std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_bt_actions");
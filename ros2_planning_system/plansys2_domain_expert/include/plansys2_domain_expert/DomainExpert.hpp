@@ -17,6 +17,7 @@
 
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -44,6 +45,8 @@ public:
 
   /// Extend the content of aDomainExpert with the content of another domain.
   /**
+   * Invalidates the cache of grounded actions.
+   *
    * \param[in] node_name The content of a PDDL domain.
    */
   void extendDomain(const std::string & domain);
@@ -90,6 +93,8 @@ public:
 
   /// Get the details of an regular action existing in the domain.
   /**
+   * The result is cached by action and parameters, and a copy is returned on each call.
+   *
    * \param[in] action The name of the action.
    * \return An Action object containing the action name, parameters, requirements and effects.
    *    If the action does not exist, the value returned has not value.
@@ -106,6 +111,8 @@ public:
 
   /// Get the details of an durative action existing in the domain.
   /**
+   * The result is cached by action and parameters, and a copy is returned on each call.
+   *
    * \param[in] action The name of the action.
    * \return A Durative Action object containing the action name, parameters, requirements and
    *    effects. If the action does not exist, the value returned has not value.
@@ -128,8 +135,15 @@ public:
   bool existDomain(const std::string & domain_name);
 
 private:
+  static std::string getActionKey(
+    const std::string & action, const std::vector<std::string> & params);
+
   std::shared_ptr<parser::pddl::Domain> domain_;
   DomainReader domains_;
+
+  std::unordered_map<std::string, plansys2_msgs::msg::Action::SharedPtr> actions_cache_;
+  std::unordered_map<std::string, plansys2_msgs::msg::DurativeAction::SharedPtr>
+    durative_actions_cache_;
 };
 
 }  // namespace plansys2
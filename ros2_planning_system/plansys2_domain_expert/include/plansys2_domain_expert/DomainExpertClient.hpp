@@ -15,8 +15,10 @@
 #ifndef PLANSYS2_DOMAIN_EXPERT__DOMAINEXPERTCLIENT_HPP_
 #define PLANSYS2_DOMAIN_EXPERT__DOMAINEXPERTCLIENT_HPP_
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -35,6 +37,8 @@
 #include "plansys2_msgs/srv/get_node_details.hpp"
 #include "plansys2_msgs/srv/get_states.hpp"
 
+#include "std_msgs/msg/empty.hpp"
+
 #include "rclcpp/rclcpp.hpp"
 
 namespace plansys2
@@ -45,6 +49,9 @@ namespace plansys2
  * Any node can create a DomainExpertClient object to requests changes to the
  * DomainExpertNode, or to get information from it. It presents the same interface
  * of the DomainExpert, and hides the complexity of using services.
+ *
+ * The details of grounded actions are cached by action and parameters. The cache
+ * is cleared each time the DomainExpertNode notifies that its domain has changed.
  */
 class DomainExpertClient : public DomainExpertInterface
 {
@@ -124,9 +131,28 @@ public:
    */
   std::string getDomain();
 
+  /// Get the number of domain changes notified by the DomainExpertNode.
+  /**
+   * Anything built from the domain may be cached while this number does not change.
+   * \return The number of update notifications received so far.
+   */
+  uint64_t getUpdateCount();
+
 private:
+  static std::string getActionKey(
+    const std::string & action, const std::vector<std::string> & params);
+
+  void update_callback(const std_msgs::msg::Empty::SharedPtr msg);
+
   rclcpp::Node::SharedPtr node_;
 
+  rclcpp::Subscription<std_msgs::msg::Empty>::SharedPtr update_sub_;
+  uint64_t update_count_;
+
+  std::unordered_map<std::string, plansys2_msgs::msg::Action::SharedPtr> actions_cache_;
+  std::unordered_map<std::string, plansys2_msgs::msg::DurativeAction::SharedPtr>
+    durative_actions_cache_;
+
   rclcpp::Client<plansys2_msgs::srv::GetDomain>::SharedPtr get_domain_client_;
   rclcpp::Client<plansys2_msgs::srv::GetDomainTypes>::SharedPtr get_types_client_;
   rclcpp::Client<plansys2_msgs::srv::GetStates>::SharedPtr get_predicates_client_;
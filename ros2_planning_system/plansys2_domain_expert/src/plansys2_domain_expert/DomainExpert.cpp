@@ -34,6 +34,9 @@ DomainExpert::extendDomain(const std::string & domain)
 {
   domains_.add_domain(domain);
 
+  actions_cache_.clear();
+  durative_actions_cache_.clear();
+
   domain_ = std::make_shared<parser::pddl::Domain>();
 
   try {
@@ -169,6 +172,12 @@ DomainExpert::getActions()
 plansys2_msgs::msg::Action::SharedPtr
 DomainExpert::getAction(const std::string & action, const std::vector<std::string> & params)
 {
+  auto key = getActionKey(action, params);
+  auto cached = actions_cache_.find(key);
+  if (cached != actions_cache_.end()) {
+    return std::make_shared<plansys2_msgs::msg::Action>(*cached->second);
+  }
+
   std::string action_search = action;
   std::transform(
     action_search.begin(), action_search.end(),
@@ -213,7 +222,8 @@ DomainExpert::getAction(const std::string & action, const std::vector<std::strin
   }
 
   if (found) {
-    return ret;
+    actions_cache_[key] = ret;
+    return std::make_shared<plansys2_msgs::msg::Action>(*ret);
   } else {
     return {};
   }
@@ -238,6 +248,12 @@ DomainExpert::getDurativeActions()
 plansys2_msgs::msg::DurativeAction::SharedPtr
 DomainExpert::getDurativeAction(const std::string & action, const std::vector<std::string> & params)
 {
+  auto key = getActionKey(action, params);
+  auto cached = durative_actions_cache_.find(key);
+  if (cached != durative_actions_cache_.end()) {
+    return std::make_shared<plansys2_msgs::msg::DurativeAction>(*cached->second);
+  }
+
   std::string action_search = action;
   std::transform(
     action_search.begin(), action_search.end(),
@@ -299,12 +315,23 @@ DomainExpert::getDurativeAction(const std::string & action, const std::vector<st
   }
 
   if (found) {
-    return ret;
+    durative_actions_cache_[key] = ret;
+    return std::make_shared<plansys2_msgs::msg::DurativeAction>(*ret);
   } else {
     return {};
   }
 }
 
+std::string
+DomainExpert::getActionKey(const std::string & action, const std::vector<std::string> & params)
+{
+  std::string key = action;
+  for (const auto & param : params) {
+    key += " " + param;
+  }
+  return key;
+}
+
 std::string
 DomainExpert::getDomain()
 {
@@ -24,6 +24,7 @@ namespace plansys2
 {
 
 DomainExpertClient::DomainExpertClient()
+: update_count_(0)
 {
   node_ = rclcpp::Node::make_shared("domain_expert_client");
 
@@ -50,6 +51,37 @@ DomainExpertClient::DomainExpertClient()
   get_durative_action_details_client_ =
     node_->create_client<plansys2_msgs::srv::GetDomainDurativeActionDetails>(
     "domain_expert/get_domain_durative_action_details");
+
+  update_sub_ = node_->create_subscription<std_msgs::msg::Empty>(
+    "domain_expert/update_notify", rclcpp::QoS(100).transient_local(),
+    std::bind(&DomainExpertClient::update_callback, this, std::placeholders::_1));
+}
+
+void
+DomainExpertClient::update_callback(const std_msgs::msg::Empty::SharedPtr msg)
+{
+  actions_cache_.clear();
+  durative_actions_cache_.clear();
+  update_count_++;
+}
+
+uint64_t
+DomainExpertClient::getUpdateCount()
+{
+  // Process pending update notifications before reading the count
+  rclcpp::spin_some(node_);
+  return update_count_;
+}
+
+std::string
+DomainExpertClient::getActionKey(
+  const std::string & action, const std::vector<std::string> & params)
+{
+  std::string key = action;
+  for (const auto & param : params) {
+    key += " " + param;
+  }
+  return key;
 }
 
 std::vector<std::string>
@@ -256,6 +288,15 @@ DomainExpertClient::getAction(
   const std::string & action,
   const std::vector<std::string> & params)
 {
+  // Process pending update notifications before looking up the cache
+  rclcpp::spin_some(node_);
+
+  auto key = getActionKey(action, params);
+  auto cached = actions_cache_.find(key);
+  if (cached != actions_cache_.end()) {
+    return std::make_shared<plansys2_msgs::msg::Action>(*cached->second);
+  }
+
   while (!get_action_details_client_->wait_for_service(std::chrono::seconds(1))) {
     if (!rclcpp::ok()) {
       return {};
@@ -280,7 +321,9 @@ DomainExpertClient::getAction(
   }
 
   if (future_result.get()->success) {
-    return std::make_shared<plansys2_msgs::msg::Action>(future_result.get()->action);
+    auto ret = std::make_shared<plansys2_msgs::msg::Action>(future_result.get()->action);
+    actions_cache_[key] = ret;
+    return std::make_shared<plansys2_msgs::msg::Action>(*ret);
   } else {
     RCLCPP_ERROR_STREAM(
       node_->get_logger(),
@@ -327,6 +370,15 @@ DomainExpertClient::getDurativeAction(
   const std::string & action,
   const std::vector<std::string> & params)
 {
+  // Process pending update notifications before looking up the cache
+  rclcpp::spin_some(node_);
+
+  auto key = getActionKey(action, params);
+  auto cached = durative_actions_cache_.find(key);
+  if (cached != durative_actions_cache_.end()) {
+    return std::make_shared<plansys2_msgs::msg::DurativeAction>(*cached->second);
+  }
+
   while (!get_durative_action_details_client_->wait_for_service(std::chrono::seconds(1))) {
     if (!rclcpp::ok()) {
       return nullptr;
@@ -351,8 +403,10 @@ DomainExpertClient::getDurativeAction(
   }
 
   if (future_result.get()->success) {
-    return std::make_shared<plansys2_msgs::msg::DurativeAction>(
+    auto ret = std::make_shared<plansys2_msgs::msg::DurativeAction>(
       future_result.get()->durative_action);
+    durative_actions_cache_[key] = ret;
+    return std::make_shared<plansys2_msgs::msg::DurativeAction>(*ret);
   } else {
     RCLCPP_ERROR_STREAM(
       node_->get_logger(),
@@ -88,6 +88,9 @@ DomainExpertNode::DomainExpertNode()
       &DomainExpertNode::get_domain_service_callback,
       this, std::placeholders::_1, std::placeholders::_2,
       std::placeholders::_3));
+
+  update_pub_ = create_publisher<std_msgs::msg::Empty>(
+    "domain_expert/update_notify", rclcpp::QoS(100).transient_local());
 }
 
 
@@ -139,6 +142,10 @@ CallbackReturnT
 DomainExpertNode::on_activate(const rclcpp_lifecycle::State & state)
 {
   RCLCPP_INFO(get_logger(), "[%s] Activating...", get_name());
+  update_pub_->on_activate();
+
+  // The domain may have changed in the last configuration, so clients drop their caches
+  update_pub_->publish(std_msgs::msg::Empty());
   RCLCPP_INFO(get_logger(), "[%s] Activated", get_name());
 
   return CallbackReturnT::SUCCESS;
@@ -148,6 +155,7 @@ CallbackReturnT
 DomainExpertNode::on_deactivate(const rclcpp_lifecycle::State & state)
 {
   RCLCPP_INFO(get_logger(), "[%s] Deactivating...", get_name());
+  update_pub_->on_deactivate();
   RCLCPP_INFO(get_logger(), "[%s] Deactivated", get_name());
 
   return CallbackReturnT::SUCCESS;
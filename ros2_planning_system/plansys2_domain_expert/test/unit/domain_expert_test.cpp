@@ -285,6 +285,43 @@ TEST(domain_expert, get_action_params)
     "(and (robot_at ?0 ?2))");
 }
 
+TEST(domain_expert, cached_actions)
+{
+  std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_domain_expert");
+  std::ifstream domain_ifs(pkgpath + "/pddl/domain_simple.pddl");
+  std::string domain_str((
+      std::istreambuf_iterator<char>(domain_ifs)),
+    std::istreambuf_iterator<char>());
+
+  plansys2::DomainExpert domain_expert(domain_str);
+
+  auto move_1 = domain_expert.getDurativeAction("move", {"r2d2", "kitchen", "bedroom"});
+  ASSERT_TRUE(move_1);
+  ASSERT_EQ(parser::pddl::toString(move_1->at_end_effects), "(and (robot_at r2d2 bedroom))");
+
+  // Changes in a returned action must not leak into the cache
+  move_1->at_end_effects.nodes.clear();
+  auto move_2 = domain_expert.getDurativeAction("move", {"r2d2", "kitchen", "bedroom"});
+  ASSERT_NE(move_1, move_2);
+  ASSERT_EQ(parser::pddl::toString(move_2->at_end_effects), "(and (robot_at r2d2 bedroom))");
+
+  auto move_3 = domain_expert.getDurativeAction("move", {"r2d2", "bedroom", "kitchen"});
+  ASSERT_EQ(parser::pddl::toString(move_3->at_end_effects), "(and (robot_at r2d2 kitchen))");
+
+  ASSERT_FALSE(domain_expert.getDurativeAction("pick_object"));
+
+  std::ifstream domain_ext_ifs(pkgpath + "/pddl/domain_simple_ext.pddl");
+  std::string domain_ext_str((
+      std::istreambuf_iterator<char>(domain_ext_ifs)),
+    std::istreambuf_iterator<char>());
+
+  domain_expert.extendDomain(domain_ext_str);
+
+  ASSERT_TRUE(domain_expert.getDurativeAction("pick_object"));
+  auto move_4 = domain_expert.getDurativeAction("move", {"r2d2", "kitchen", "bedroom"});
+  ASSERT_EQ(parser::pddl::toString(move_4->at_end_effects), "(and (robot_at r2d2 bedroom))");
+}
+
 TEST(domain_expert, multidomain_get_types)
 {
   std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_domain_expert");
@@ -18,7 +18,9 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <functional>
 
+#include "plansys2_executor/ActionHub.hpp"
 #include "plansys2_msgs/msg/action_execution.hpp"
 #include "plansys2_msgs/msg/action_execution_info.hpp"
 #include "plansys2_msgs/msg/durative_action.hpp"
@@ -30,7 +32,7 @@
 namespace plansys2
 {
 
-class ActionExecutor
+class ActionExecutor : public std::enable_shared_from_this<ActionExecutor>
 {
 public:
   enum Status
@@ -53,6 +55,7 @@ public:
 
   explicit ActionExecutor(
     const std::string & action, rclcpp_lifecycle::LifecycleNode::SharedPtr node);
+  ~ActionExecutor();
 
   BT::NodeStatus tick(const rclcpp::Time & now);
   void cancel();
@@ -72,6 +75,9 @@ public:
   std::string get_feedback() const {return feedback_;}
   float get_completion() const {return completion_;}
 
+  /// Set a function called each time the status or the feedback of the action changes.
+  void set_change_callback(std::function<void()> callback) {change_callback_ = callback;}
+
 protected:
   rclcpp_lifecycle::LifecycleNode::SharedPtr node_;
 
@@ -87,10 +93,9 @@ protected:
   std::string feedback_;
   float completion_;
 
-  rclcpp_lifecycle::LifecyclePublisher<plansys2_msgs::msg::ActionExecution>::SharedPtr
-    action_hub_pub_;
-  rclcpp::Subscription<plansys2_msgs::msg::ActionExecution>::SharedPtr action_hub_sub_;
+  ActionHub::Ptr action_hub_;
 
+  friend class ActionHub;
   void action_hub_callback(const plansys2_msgs::msg::ActionExecution::SharedPtr msg);
   void request_for_performers();
   void confirm_performer(const std::string & node_id);
@@ -101,6 +106,9 @@ protected:
 
   void wait_timeout();
   rclcpp::TimerBase::SharedPtr waiting_timer_;
+
+  std::function<void()> change_callback_;
+  void notify_change();
 };
 
 struct ActionExecutionInfo
@@ -76,6 +76,7 @@ protected:
   rclcpp_lifecycle::LifecyclePublisher<plansys2_msgs::msg::ActionExecution>::SharedPtr
     action_hub_pub_;
   rclcpp::Subscription<plansys2_msgs::msg::ActionExecution>::SharedPtr action_hub_sub_;
+  rclcpp::Subscription<plansys2_msgs::msg::ActionExecution>::SharedPtr performer_sub_;
   rclcpp::TimerBase::SharedPtr timer_;
 
   rclcpp_lifecycle::LifecyclePublisher<plansys2_msgs::msg::ActionPerformerStatus>::SharedPtr
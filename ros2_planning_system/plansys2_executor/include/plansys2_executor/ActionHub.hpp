@@ -0,0 +1,101 @@
+// Copyright 2019 Intelligent Robotics Lab
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLANSYS2_EXECUTOR__ACTIONHUB_HPP_
+#define PLANSYS2_EXECUTOR__ACTIONHUB_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "plansys2_msgs/msg/action_execution.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+
+namespace plansys2
+{
+
+class ActionExecutor;
+
+/// Shared endpoint to the actions hub for all the ActionExecutors of a node.
+/**
+ * Instead of one publisher and one subscription per ActionExecutor, all the
+ * executors created with the same node share a single ActionHub. Incoming
+ * messages are dispatched only to the executors of the same action and
+ * arguments, looked up in a hash table. Messages sent by requesters are
+ * dropped on arrival.
+ *
+ * If the node has the parameter routed_actions_hub set to true, REQUEST
+ * messages are sent to a topic per action, and CONFIRM, REJECT and CANCEL
+ * messages to a topic per performer, so that each performer only receives
+ * the traffic meant for it. Performers must use the same setting. Messages
+ * from performers always go through /actions_hub.
+ */
+class ActionHub
+{
+public:
+  using Ptr = std::shared_ptr<ActionHub>;
+
+  /// Get the hub of a node, creating it if it does not exist yet.
+  static Ptr get(rclcpp_lifecycle::LifecycleNode::SharedPtr node);
+
+  explicit ActionHub(rclcpp_lifecycle::LifecycleNode::SharedPtr node);
+
+  /// Start dispatching the messages of an action to an executor.
+  void add(std::shared_ptr<ActionExecutor> action_executor);
+
+  /// Stop dispatching messages to an executor.
+  void remove(const ActionExecutor * action_executor);
+
+  void publish(const plansys2_msgs::msg::ActionExecution & msg);
+
+  bool is_routed() const {return routed_;}
+
+  /// Topic with the requests for an action, in routed mode.
+  static std::string get_action_topic(const std::string & action_name);
+
+  /// Topic with the messages for a performer, in routed mode.
+  static std::string get_performer_topic(const std::string & node_name);
+
+protected:
+  using Publisher =
+    rclcpp_lifecycle::LifecyclePublisher<plansys2_msgs::msg::ActionExecution>;
+
+  void action_hub_callback(const plansys2_msgs::msg::ActionExecution::SharedPtr msg);
+  Publisher::SharedPtr get_publisher(const std::string & topic, bool transient_local);
+
+  static std::string get_key(
+    const std::string & action, const std::vector<std::string> & arguments);
+
+  rclcpp_lifecycle::LifecycleNode::SharedPtr node_;
+  bool routed_;
+
+  Publisher::SharedPtr action_hub_pub_;
+  rclcpp::Subscription<plansys2_msgs::msg::ActionExecution>::SharedPtr action_hub_sub_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::vector<std::weak_ptr<ActionExecutor>>> executors_;
+  std::unordered_map<std::string, Publisher::SharedPtr> routed_pubs_;
+
+  static std::mutex hubs_mutex_;
+  static std::map<const rclcpp_lifecycle::LifecycleNode *, std::weak_ptr<ActionHub>> hubs_;
+};
+
+}  // namespace plansys2
+
+#endif  // PLANSYS2_EXECUTOR__ACTIONHUB_HPP_
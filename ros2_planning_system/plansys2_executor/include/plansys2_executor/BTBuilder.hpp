@@ -45,15 +45,58 @@ struct ActionStamped
   std::shared_ptr<plansys2_msgs::msg::DurativeAction> action;
 };
 
+/// Grounded action compiled against the interned predicates and functions of a BTBuilder.
+/**
+ * Templates are built once per grounded action and reused across plans.
+ */
+struct ActionTemplate
+{
+  using Ptr = std::shared_ptr<ActionTemplate>;
+
+  struct Condition
+  {
+    uint32_t node_id;
+    int base;       // Interned predicate or function the condition refers to
+    int predicate;  // Interned predicate, or -1 if it is not a (negated) predicate
+    bool negate;
+  };
+
+  struct Effect
+  {
+    uint32_t node_id;
+    int predicate;  // Interned predicate, or -1 for function modifiers
+    bool negate;
+  };
+
+  std::shared_ptr<plansys2_msgs::msg::DurativeAction> action;
+
+  std::vector<Condition> at_start_requirements;
+  std::vector<Condition> over_all_requirements;
+  std::vector<Condition> at_end_requirements;
+
+  std::vector<Effect> at_start_effects;
+  std::vector<Effect> at_end_effects;
+
+  // Every predicate or function read or written by the action
+  std::set<int> bases;
+
+  // Predicates in the requirements, encoded as 2 * predicate + negate
+  std::set<int> at_start_literals;
+  std::set<int> over_all_literals;
+};
+
 struct GraphNode
 {
   using Ptr = std::shared_ptr<GraphNode>;
   static Ptr make_shared() {return std::make_shared<GraphNode>();}
 
   ActionStamped action;
+  ActionTemplate::Ptr action_template;
   int node_num;
   int level_num;
 
+  // Interned predicates that hold after the node. If empty, predicates is used instead.
+  std::vector<bool> state;
   std::vector<plansys2::Predicate> predicates;
   std::vector<plansys2::Function> functions;
 
@@ -77,6 +120,7 @@ public:
 
   Graph::Ptr get_graph(const plansys2_msgs::msg::Plan & current_plan);
   std::string get_tree(const plansys2_msgs::msg::Plan & current_plan);
+  std::string get_tree(const Graph::Ptr & action_graph);
   std::string get_dotgraph(
     Graph::Ptr action_graph, std::shared_ptr<std::map<std::string,
     ActionExecutionInfo>> action_map, bool enable_legend = false,
@@ -88,9 +132,52 @@ protected:
 
   std::string bt_action_;
 
+  // Compiled against the domain as of domain_version_, and cleared when it changes
+  std::map<std::string, ActionTemplate::Ptr> action_templates_;
+  std::map<std::pair<std::string, uint8_t>, int> base_ids_;
+  std::vector<plansys2::Predicate> base_predicates_;
+  uint64_t domain_version_;
+
+  void update_domain_version();
+
   std::vector<ActionStamped> get_plan_actions(const plansys2_msgs::msg::Plan & plan);
   void prune_backwards(GraphNode::Ptr new_node, GraphNode::Ptr node_satisfy);
-  void prune_forward(GraphNode::Ptr current, std::list<GraphNode::Ptr> & used_nodes);
+  void prune_backwards(
+    GraphNode::Ptr new_node, GraphNode::Ptr node_satisfy,
+    std::set<GraphNode::Ptr> & visited);
+  void prune_forward(GraphNode::Ptr current, std::set<GraphNode::Ptr> & used_nodes);
+
+  ActionTemplate::Ptr get_action_template(
+    const std::shared_ptr<plansys2_msgs::msg::DurativeAction> & action);
+  ActionTemplate::Ptr compile_action(
+    const std::shared_ptr<plansys2_msgs::msg::DurativeAction> & action);
+  std::vector<ActionTemplate::Condition> compile_conditions(
+    const plansys2_msgs::msg::Tree & tree);
+  void compile_effects(
+    const plansys2_msgs::msg::Tree & tree,
+    std::vector<ActionTemplate::Effect> & effects,
+    uint32_t node_id = 0,
+    bool negate = false);
+  ActionTemplate::Condition get_condition(
+    const plansys2_msgs::msg::Tree & tree,
+    uint32_t node_id);
+  int get_base_id(const plansys2_msgs::msg::Tree & tree, uint32_t node_id = 0);
+  int get_predicate_id(const plansys2::Predicate & predicate);
+  int intern_base(
+    const std::pair<std::string, uint8_t> & base,
+    const plansys2_msgs::msg::Node * predicate = nullptr);
+
+  std::vector<bool> get_state(const std::vector<plansys2::Predicate> & predicates);
+  std::vector<plansys2::Predicate> get_state_predicates(const std::vector<bool> & state) const;
+  bool check_state(
+    const plansys2_msgs::msg::Tree & tree,
+    const ActionTemplate::Condition & condition,
+    const GraphNode::Ptr & node) const;
+  void apply_effects(const GraphNode::Ptr & node) const;
+  void apply_effects(
+    const plansys2_msgs::msg::Tree & tree,
+    const std::vector<ActionTemplate::Effect> & effects,
+    const GraphNode::Ptr & node) const;
 
   bool is_action_executable(
     const ActionStamped & action,
@@ -114,6 +201,27 @@ protected:
     uint32_t node_id,
     const GraphNode::Ptr & node,
     const GraphNode::Ptr & current);
+  GraphNode::Ptr get_node_satisfy(
+    const plansys2_msgs::msg::Tree & requirement,
+    const ActionTemplate::Condition & condition,
+    const GraphNode::Ptr & node,
+    const GraphNode::Ptr & current,
+    std::map<GraphNode::Ptr, GraphNode::Ptr> & visited);
+  GraphNode::Ptr find_node_satisfy(
+    const plansys2_msgs::msg::Tree & requirement,
+    const ActionTemplate::Condition & condition,
+    const std::list<GraphNode::Ptr> & roots,
+    const GraphNode::Ptr & current,
+    const std::map<int, std::vector<GraphNode::Ptr>> & producers);
+  std::vector<uint32_t> connect_requirements(
+    const plansys2_msgs::msg::Tree & tree,
+    const std::vector<ActionTemplate::Condition> & requirements,
+    const std::list<GraphNode::Ptr> & roots,
+    const GraphNode::Ptr & new_node,
+    const std::map<int, std::vector<GraphNode::Ptr>> & producers);
+  void index_node(
+    const GraphNode::Ptr & node,
+    std::map<int, std::vector<GraphNode::Ptr>> & producers) const;
   void remove_existing_requirements(
     const plansys2_msgs::msg::Tree & tree,
     std::vector<uint32_t> & requirements,
@@ -121,11 +229,11 @@ protected:
     std::vector<plansys2::Function> & functions) const;
   bool is_parallelizable(
     const plansys2::ActionStamped & action,
-    const std::list<GraphNode::Ptr> & ret) const;
+    const std::list<GraphNode::Ptr> & ret);
 
   std::string get_flow_tree(
     GraphNode::Ptr node,
-    std::list<std::string> & used_nodes,
+    std::set<std::string> & used_nodes,
     int level = 0);
   std::string get_flow_dotgraph(GraphNode::Ptr node, int level = 0);
   std::string get_node_dotgraph(
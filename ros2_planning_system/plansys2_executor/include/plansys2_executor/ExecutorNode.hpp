@@ -15,7 +15,9 @@
 #ifndef PLANSYS2_EXECUTOR__EXECUTORNODE_HPP_
 #define PLANSYS2_EXECUTOR__EXECUTORNODE_HPP_
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <map>
@@ -24,6 +26,7 @@
 #include "plansys2_problem_expert/ProblemExpertClient.hpp"
 #include "plansys2_planner/PlannerClient.hpp"
 #include "plansys2_executor/ActionExecutor.hpp"
+#include "plansys2_executor/BTBuilder.hpp"
 
 #include "lifecycle_msgs/msg/state.hpp"
 #include "lifecycle_msgs/msg/transition.hpp"
@@ -31,6 +34,7 @@
 #include "plansys2_msgs/action/execute_plan.hpp"
 #include "plansys2_msgs/msg/action_execution_info.hpp"
 #include "plansys2_msgs/srv/get_ordered_sub_goals.hpp"
+#include "std_msgs/msg/empty.hpp"
 #include "std_msgs/msg/string.hpp"
 
 #include "rclcpp/rclcpp.hpp"
@@ -81,6 +85,7 @@ protected:
   std::shared_ptr<plansys2::DomainExpertClient> domain_client_;
   std::shared_ptr<plansys2::ProblemExpertClient> problem_client_;
   std::shared_ptr<plansys2::PlannerClient> planner_client_;
+  std::shared_ptr<BTBuilder> bt_builder_;
 
   rclcpp_lifecycle::LifecyclePublisher<plansys2_msgs::msg::ActionExecutionInfo>::SharedPtr
     execution_info_pub_;
@@ -89,6 +94,15 @@ protected:
   rclcpp::Service<plansys2_msgs::srv::GetOrderedSubGoals>::SharedPtr
     get_ordered_sub_goals_service_;
   rclcpp_lifecycle::LifecyclePublisher<std_msgs::msg::String>::SharedPtr dotgraph_pub_;
+  rclcpp::Subscription<std_msgs::msg::Empty>::SharedPtr update_sub_;
+
+  // The plan is ticked when an action or the problem changes, instead of polling
+  std::mutex tick_mutex_;
+  std::condition_variable tick_cv_;
+  bool tick_requested_;
+  uint64_t changes_;
+
+  void request_tick();
 
   std::optional<std::vector<plansys2_msgs::msg::Tree>> getOrderedSubGoals();
 
@@ -23,7 +23,6 @@
 namespace plansys2
 {
 
-using std::placeholders::_1;
 using namespace std::chrono_literals;
 
 ActionExecutor::ActionExecutor(
@@ -31,11 +30,7 @@ ActionExecutor::ActionExecutor(
   rclcpp_lifecycle::LifecycleNode::SharedPtr node)
 : node_(node), state_(IDLE), completion_(0.0)
 {
-  action_hub_pub_ = node_->create_publisher<plansys2_msgs::msg::ActionExecution>(
-    "/actions_hub", rclcpp::QoS(100).reliable());
-  action_hub_sub_ = node_->create_subscription<plansys2_msgs::msg::ActionExecution>(
-    "/actions_hub", rclcpp::QoS(100).reliable(),
-    std::bind(&ActionExecutor::action_hub_callback, this, _1));
+  action_hub_ = ActionHub::get(node_);
 
   state_time_ = node_->now();
 
@@ -46,6 +41,11 @@ ActionExecutor::ActionExecutor(
   state_time_ = start_execution_;
 }
 
+ActionExecutor::~ActionExecutor()
+{
+  action_hub_->remove(this);
+}
+
 void
 ActionExecutor::action_hub_callback(const plansys2_msgs::msg::ActionExecution::SharedPtr msg)
 {
@@ -67,6 +67,7 @@ ActionExecutor::action_hub_callback(const plansys2_msgs::msg::ActionExecution::S
           waiting_timer_ = nullptr;
           start_execution_ = node_->now();
           state_time_ = node_->now();
+          notify_change();
         } else {
           reject_performer(msg->node_id);
         }
@@ -81,6 +82,7 @@ ActionExecutor::action_hub_callback(const plansys2_msgs::msg::ActionExecution::S
       feedback_ = msg->status;
       completion_ = msg->completion;
       state_time_ = node_->now();
+      notify_change();
 
       break;
     case plansys2_msgs::msg::ActionExecution::FINISH:
@@ -98,9 +100,9 @@ ActionExecutor::action_hub_callback(const plansys2_msgs::msg::ActionExecution::S
 
         state_time_ = node_->now();
 
-        action_hub_pub_->on_deactivate();
-        action_hub_pub_ = nullptr;
-        action_hub_sub_ = nullptr;
+        action_hub_->remove(this);
+
+        notify_change();
       }
       break;
     default:
@@ -120,7 +122,7 @@ ActionExecutor::confirm_performer(const std::string & node_id)
   msg.action = action_name_;
   msg.arguments = action_params_;
 
-  action_hub_pub_->publish(msg);
+  action_hub_->publish(msg);
 }
 
 void
@@ -132,7 +134,7 @@ ActionExecutor::reject_performer(const std::string & node_id)
   msg.action = action_name_;
   msg.arguments = action_params_;
 
-  action_hub_pub_->publish(msg);
+  action_hub_->publish(msg);
 }
 
 void
@@ -144,7 +146,7 @@ ActionExecutor::request_for_performers()
   msg.action = action_name_;
   msg.arguments = action_params_;
 
-  action_hub_pub_->publish(msg);
+  action_hub_->publish(msg);
 }
 
 BT::NodeStatus
@@ -184,7 +186,7 @@ ActionExecutor::tick(const rclcpp::Time & now)
       state_ = DEALING;
       state_time_ = node_->now();
 
-      action_hub_pub_->on_activate();
+      action_hub_->add(shared_from_this());
 
       completion_ = 0.0;
       feedback_ = "";
@@ -192,6 +194,7 @@ ActionExecutor::tick(const rclcpp::Time & now)
       request_for_performers();
       waiting_timer_ = node_->create_wall_timer(
         1s, std::bind(&ActionExecutor::wait_timeout, this));
+      notify_change();
       break;
     case DEALING:
       {
@@ -201,6 +204,7 @@ ActionExecutor::tick(const rclcpp::Time & now)
             node_->get_logger(),
             "Aborting %s. Timeout after requesting for 30 seconds", action_.c_str());
           state_ = FAILURE;
+          notify_change();
         }
       }
       break;
@@ -228,7 +232,8 @@ ActionExecutor::cancel()
   msg.action = action_name_;
   msg.arguments = action_params_;
 
-  action_hub_pub_->publish(msg);
+  action_hub_->publish(msg);
+  notify_change();
 }
 
 std::string
@@ -268,6 +273,14 @@ ActionExecutor::get_params(const std::string & action_expr)
   return ret;
 }
 
+void
+ActionExecutor::notify_change()
+{
+  if (change_callback_) {
+    change_callback_();
+  }
+}
+
 void
 ActionExecutor::wait_timeout()
 {
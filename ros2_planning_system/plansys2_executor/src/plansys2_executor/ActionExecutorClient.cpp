@@ -22,6 +22,7 @@
 #include "plansys2_msgs/msg/action_execution_info.hpp"
 
 #include "plansys2_executor/ActionExecutorClient.hpp"
+#include "plansys2_executor/ActionHub.hpp"
 
 namespace plansys2
 {
@@ -38,6 +39,7 @@ ActionExecutorClient::ActionExecutorClient(
   declare_parameter("action_name");
   declare_parameter("specialized_arguments");
   declare_parameter("rate");
+  declare_parameter("routed_actions_hub", false);
 
   status_.state = plansys2_msgs::msg::ActionPerformerStatus::NOT_READY;
   status_.node_name = get_name();
@@ -75,9 +77,20 @@ ActionExecutorClient::on_configure(const rclcpp_lifecycle::State & state)
 
   action_hub_pub_ = create_publisher<plansys2_msgs::msg::ActionExecution>(
     "/actions_hub", rclcpp::QoS(100).reliable());
-  action_hub_sub_ = create_subscription<plansys2_msgs::msg::ActionExecution>(
-    "/actions_hub", rclcpp::QoS(100).reliable(),
-    std::bind(&ActionExecutorClient::action_hub_callback, this, _1));
+
+  if (get_parameter("routed_actions_hub").as_bool()) {
+    // Only receive the requests for our action and the messages sent to us
+    action_hub_sub_ = create_subscription<plansys2_msgs::msg::ActionExecution>(
+      ActionHub::get_action_topic(action_managed_), rclcpp::QoS(100).reliable(),
+      std::bind(&ActionExecutorClient::action_hub_callback, this, _1));
+    performer_sub_ = create_subscription<plansys2_msgs::msg::ActionExecution>(
+      ActionHub::get_performer_topic(get_name()), rclcpp::QoS(100).reliable().transient_local(),
+      std::bind(&ActionExecutorClient::action_hub_callback, this, _1));
+  } else {
+    action_hub_sub_ = create_subscription<plansys2_msgs::msg::ActionExecution>(
+      "/actions_hub", rclcpp::QoS(100).reliable(),
+      std::bind(&ActionExecutorClient::action_hub_callback, this, _1));
+  }
 
   action_hub_pub_->on_activate();
 
@@ -0,0 +1,231 @@
+// Copyright 2019 Intelligent Robotics Lab
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "plansys2_executor/ActionHub.hpp"
+#include "plansys2_executor/ActionExecutor.hpp"
+
+namespace plansys2
+{
+
+using std::placeholders::_1;
+
+namespace
+{
+
+std::string
+to_topic_token(const std::string & name)
+{
+  std::string ret = name;
+  std::replace_if(
+    ret.begin(), ret.end(),
+    [](char c) {return !std::isalnum(static_cast<unsigned char>(c)) && c != '_';}, '_');
+  return ret;
+}
+
+}  // namespace
+
+std::mutex ActionHub::hubs_mutex_;
+std::map<const rclcpp_lifecycle::LifecycleNode *, std::weak_ptr<ActionHub>> ActionHub::hubs_;
+
+ActionHub::Ptr
+ActionHub::get(rclcpp_lifecycle::LifecycleNode::SharedPtr node)
+{
+  std::lock_guard<std::mutex> lock(hubs_mutex_);
+
+  for (auto it = hubs_.begin(); it != hubs_.end(); ) {
+    if (it->second.expired()) {
+      it = hubs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  auto it = hubs_.find(node.get());
+  if (it != hubs_.end()) {
+    return it->second.lock();
+  }
+
+  auto hub = std::make_shared<ActionHub>(node);
+  hubs_[node.get()] = hub;
+  return hub;
+}
+
+ActionHub::ActionHub(rclcpp_lifecycle::LifecycleNode::SharedPtr node)
+: node_(node), routed_(false)
+{
+  node_->get_parameter_or("routed_actions_hub", routed_, false);
+
+  action_hub_pub_ = node_->create_publisher<plansys2_msgs::msg::ActionExecution>(
+    "/actions_hub", rclcpp::QoS(100).reliable());
+  action_hub_pub_->on_activate();
+
+  action_hub_sub_ = node_->create_subscription<plansys2_msgs::msg::ActionExecution>(
+    "/actions_hub", rclcpp::QoS(100).reliable(),
+    std::bind(&ActionHub::action_hub_callback, this, _1));
+}
+
+void
+ActionHub::add(std::shared_ptr<ActionExecutor> action_executor)
+{
+  auto key = get_key(action_executor->get_action_name(), action_executor->get_action_params());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto & executors = executors_[key];
+  for (const auto & executor : executors) {
+    if (executor.lock() == action_executor) {
+      return;
+    }
+  }
+  executors.push_back(action_executor);
+}
+
+void
+ActionHub::remove(const ActionExecutor * action_executor)
+{
+  auto key = get_key(action_executor->get_action_name(), action_executor->get_action_params());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = executors_.find(key);
+  if (it == executors_.end()) {
+    return;
+  }
+
+  auto & executors = it->second;
+  executors.erase(
+    std::remove_if(
+      executors.begin(), executors.end(),
+      [action_executor](const std::weak_ptr<ActionExecutor> & executor) {
+        auto ptr = executor.lock();
+        return ptr == nullptr || ptr.get() == action_executor;
+      }),
+    executors.end());
+
+  if (executors.empty()) {
+    executors_.erase(it);
+  }
+}
+
+void
+ActionHub::publish(const plansys2_msgs::msg::ActionExecution & msg)
+{
+  if (!routed_) {
+    action_hub_pub_->publish(msg);
+    return;
+  }
+
+  switch (msg.type) {
+    case plansys2_msgs::msg::ActionExecution::REQUEST:
+      // Lost requests are sent again, so they do not need to be kept
+      get_publisher(get_action_topic(msg.action), false)->publish(msg);
+      break;
+    case plansys2_msgs::msg::ActionExecution::CONFIRM:
+    case plansys2_msgs::msg::ActionExecution::REJECT:
+    case plansys2_msgs::msg::ActionExecution::CANCEL:
+      // Without a performer, there is nobody to send it to
+      if (!msg.node_id.empty()) {
+        get_publisher(get_performer_topic(msg.node_id), true)->publish(msg);
+      }
+      break;
+    default:
+      action_hub_pub_->publish(msg);
+      break;
+  }
+}
+
+void
+ActionHub::action_hub_callback(const plansys2_msgs::msg::ActionExecution::SharedPtr msg)
+{
+  switch (msg->type) {
+    case plansys2_msgs::msg::ActionExecution::REQUEST:
+    case plansys2_msgs::msg::ActionExecution::CONFIRM:
+    case plansys2_msgs::msg::ActionExecution::REJECT:
+    case plansys2_msgs::msg::ActionExecution::CANCEL:
+      // Sent by requesters, nothing to do for us
+      return;
+    default:
+      break;
+  }
+
+  std::vector<std::shared_ptr<ActionExecutor>> receivers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = executors_.find(get_key(msg->action, msg->arguments));
+    if (it == executors_.end()) {
+      return;
+    }
+    for (const auto & executor : it->second) {
+      if (auto ptr = executor.lock()) {
+        receivers.push_back(ptr);
+      }
+    }
+  }
+
+  // Executors may remove themselves while handling the message
+  for (auto & executor : receivers) {
+    executor->action_hub_callback(msg);
+  }
+}
+
+ActionHub::Publisher::SharedPtr
+ActionHub::get_publisher(const std::string & topic, bool transient_local)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = routed_pubs_.find(topic);
+  if (it != routed_pubs_.end()) {
+    return it->second;
+  }
+
+  // A new publisher may not be matched yet when the first message is sent
+  auto qos = rclcpp::QoS(100).reliable();
+  if (transient_local) {
+    qos.transient_local();
+  }
+
+  auto pub = node_->create_publisher<plansys2_msgs::msg::ActionExecution>(topic, qos);
+  pub->on_activate();
+  routed_pubs_[topic] = pub;
+  return pub;
+}
+
+std::string
+ActionHub::get_key(const std::string & action, const std::vector<std::string> & arguments)
+{
+  std::string key = action;
+  for (const auto & argument : arguments) {
+    key += " " + argument;
+  }
+  return key;
+}
+
+std::string
+ActionHub::get_action_topic(const std::string & action_name)
+{
+  return "/actions_hub/action/" + to_topic_token(action_name);
+}
+
+std::string
+ActionHub::get_performer_topic(const std::string & node_name)
+{
+  return "/actions_hub/performer/" + to_topic_token(node_name);
+}
+
+}  // namespace plansys2
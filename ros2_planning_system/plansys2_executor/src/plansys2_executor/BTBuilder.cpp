@@ -37,6 +37,7 @@ namespace plansys2
 BTBuilder::BTBuilder(
   rclcpp::Node::SharedPtr node,
   const std::string & bt_action)
+: domain_version_(0)
 {
   domain_client_ = std::make_shared<plansys2::DomainExpertClient>();
   problem_client_ = std::make_shared<plansys2::ProblemExpertClient>();
@@ -121,122 +122,326 @@ BTBuilder::get_base(
   return std::make_pair(base_expr, base_type);
 }
 
-GraphNode::Ptr
-BTBuilder::get_node_satisfy(
-  const plansys2_msgs::msg::Tree & requirement,
+int
+BTBuilder::intern_base(
+  const std::pair<std::string, uint8_t> & base,
+  const plansys2_msgs::msg::Node * predicate)
+{
+  auto it = base_ids_.find(base);
+  if (it != base_ids_.end()) {
+    return it->second;
+  }
+
+  int id = static_cast<int>(base_predicates_.size());
+  base_ids_[base] = id;
+
+  base_predicates_.push_back(plansys2::Predicate());
+  if (predicate != nullptr && predicate->node_type == plansys2_msgs::msg::Node::PREDICATE) {
+    base_predicates_.back() = *predicate;
+  }
+
+  return id;
+}
+
+int
+BTBuilder::get_base_id(const plansys2_msgs::msg::Tree & tree, uint32_t node_id)
+{
+  auto base = get_base(tree, node_id);
+
+  const plansys2_msgs::msg::Node * predicate = &tree.nodes[node_id];
+  if (predicate->node_type == plansys2_msgs::msg::Node::NOT) {
+    predicate = &tree.nodes[predicate->children[0]];
+  }
+
+  return intern_base(base, predicate);
+}
+
+int
+BTBuilder::get_predicate_id(const plansys2::Predicate & predicate)
+{
+  return intern_base(
+    std::make_pair(parser::pddl::toString(predicate), plansys2_msgs::msg::Node::PREDICATE),
+    &predicate);
+}
+
+ActionTemplate::Condition
+BTBuilder::get_condition(
+  const plansys2_msgs::msg::Tree & tree,
+  uint32_t node_id)
+{
+  ActionTemplate::Condition condition;
+  condition.node_id = node_id;
+  condition.base = get_base_id(tree, node_id);
+  condition.predicate = -1;
+  condition.negate = false;
+
+  uint32_t literal_id = node_id;
+  while (tree.nodes[literal_id].node_type == plansys2_msgs::msg::Node::NOT) {
+    condition.negate = !condition.negate;
+    literal_id = tree.nodes[literal_id].children[0];
+  }
+
+  if (tree.nodes[literal_id].node_type == plansys2_msgs::msg::Node::PREDICATE) {
+    condition.predicate = get_base_id(tree, literal_id);
+  }
+
+  return condition;
+}
+
+std::vector<ActionTemplate::Condition>
+BTBuilder::compile_conditions(const plansys2_msgs::msg::Tree & tree)
+{
+  std::vector<ActionTemplate::Condition> ret;
+  for (const auto & subtree : parser::pddl::getSubtrees(tree)) {
+    ret.push_back(get_condition(tree, subtree));
+  }
+  return ret;
+}
+
+void
+BTBuilder::compile_effects(
+  const plansys2_msgs::msg::Tree & tree,
+  std::vector<ActionTemplate::Effect> & effects,
   uint32_t node_id,
-  const GraphNode::Ptr & node,
-  const GraphNode::Ptr & current)
+  bool negate)
 {
-  if (node == current) {
-    return nullptr;
+  if (node_id >= tree.nodes.size()) {
+    return;
   }
 
-  std::pair<std::string, uint8_t> requirement_base = get_base(requirement, node_id);
+  // Same traversal as plansys2::apply, which these effects replace
+  switch (tree.nodes[node_id].node_type) {
+    case plansys2_msgs::msg::Node::AND:
+    case plansys2_msgs::msg::Node::OR:
+      for (const auto & child_id : tree.nodes[node_id].children) {
+        compile_effects(tree, effects, child_id, negate);
+      }
+      break;
 
-  GraphNode::Ptr ret = nullptr;
-  std::vector<uint32_t> at_start_effects =
-    parser::pddl::getSubtrees(node->action.action->at_start_effects);
-  std::vector<uint32_t> at_end_effects =
-    parser::pddl::getSubtrees(node->action.action->at_end_effects);
-
-  std::vector<uint32_t> at_start_requirements =
-    parser::pddl::getSubtrees(node->action.action->at_start_requirements);
-  std::vector<uint32_t> over_all_requirements =
-    parser::pddl::getSubtrees(node->action.action->over_all_requirements);
-  std::vector<uint32_t> at_end_requirements =
-    parser::pddl::getSubtrees(node->action.action->at_end_requirements);
-
-  for (const auto & effect : at_end_effects) {
-    std::pair<std::string, uint8_t> base = get_base(node->action.action->at_end_effects, effect);
-    if (base != requirement_base) {
-      continue;
-    }
+    case plansys2_msgs::msg::Node::NOT:
+      compile_effects(tree, effects, tree.nodes[node_id].children[0], !negate);
+      break;
 
-    if (check(requirement, node->predicates, node->functions, node_id)) {
-      ret = node;
-    }
+    case plansys2_msgs::msg::Node::PREDICATE:
+      effects.push_back({node_id, get_base_id(tree, node_id), negate});
+      break;
+
+    case plansys2_msgs::msg::Node::FUNCTION_MODIFIER:
+      effects.push_back({node_id, -1, negate});
+      break;
+
+    default:
+      break;
   }
+}
 
-  for (const auto & effect : at_start_effects) {
-    std::pair<std::string, uint8_t> base = get_base(node->action.action->at_start_effects, effect);
-    if (base != requirement_base) {
-      continue;
-    }
+ActionTemplate::Ptr
+BTBuilder::compile_action(const std::shared_ptr<plansys2_msgs::msg::DurativeAction> & action)
+{
+  auto ret = std::make_shared<ActionTemplate>();
+  ret->action = action;
 
-    if (check(requirement, node->predicates, node->functions, node_id)) {
-      ret = node;
+  ret->at_start_requirements = compile_conditions(action->at_start_requirements);
+  ret->over_all_requirements = compile_conditions(action->over_all_requirements);
+  ret->at_end_requirements = compile_conditions(action->at_end_requirements);
+
+  compile_effects(action->at_start_effects, ret->at_start_effects);
+  compile_effects(action->at_end_effects, ret->at_end_effects);
+
+  for (const auto * conditions : {&ret->at_start_requirements, &ret->over_all_requirements,
+      &ret->at_end_requirements})
+  {
+    for (const auto & condition : *conditions) {
+      ret->bases.insert(condition.base);
     }
   }
 
-  for (const auto & req : at_start_requirements) {
-    std::pair<std::string,
-      uint8_t> base = get_base(node->action.action->at_start_requirements, req);
-    if (base != requirement_base) {
-      continue;
+  for (const auto * effects : {&action->at_start_effects, &action->at_end_effects}) {
+    for (const auto & effect : parser::pddl::getSubtrees(*effects)) {
+      ret->bases.insert(get_base_id(*effects, effect));
     }
+  }
 
-    if (check(requirement, node->predicates, node->functions, node_id)) {
-      ret = node;
-    }
+  std::vector<plansys2_msgs::msg::Node> predicates;
+  parser::pddl::getPredicates(predicates, action->at_start_requirements);
+  for (const auto & predicate : predicates) {
+    ret->at_start_literals.insert(2 * get_predicate_id(predicate) + predicate.negate);
   }
 
-  for (const auto & req : over_all_requirements) {
-    std::pair<std::string,
-      uint8_t> base = get_base(node->action.action->over_all_requirements, req);
-    if (base != requirement_base) {
-      continue;
-    }
+  predicates.clear();
+  parser::pddl::getPredicates(predicates, action->over_all_requirements);
+  for (const auto & predicate : predicates) {
+    ret->over_all_literals.insert(2 * get_predicate_id(predicate) + predicate.negate);
+  }
 
-    if (check(requirement, node->predicates, node->functions, node_id)) {
-      ret = node;
+  return ret;
+}
+
+ActionTemplate::Ptr
+BTBuilder::get_action_template(const std::shared_ptr<plansys2_msgs::msg::DurativeAction> & action)
+{
+  const auto key = parser::pddl::nameActionsToString(action);
+
+  auto it = action_templates_.find(key);
+  if (it != action_templates_.end()) {
+    return it->second;
+  }
+
+  auto ret = compile_action(action);
+  action_templates_[key] = ret;
+  return ret;
+}
+
+std::vector<bool>
+BTBuilder::get_state(const std::vector<plansys2::Predicate> & predicates)
+{
+  std::vector<bool> ret(base_predicates_.size(), false);
+  for (const auto & predicate : predicates) {
+    size_t id = get_predicate_id(predicate);
+    if (id >= ret.size()) {
+      ret.resize(id + 1, false);
     }
+    ret[id] = true;
   }
+  return ret;
+}
 
-  for (const auto & req : at_end_requirements) {
-    std::pair<std::string, uint8_t> base = get_base(node->action.action->at_end_requirements, req);
-    if (base != requirement_base) {
-      continue;
+std::vector<plansys2::Predicate>
+BTBuilder::get_state_predicates(const std::vector<bool> & state) const
+{
+  std::vector<plansys2::Predicate> ret;
+  for (size_t id = 0; id < state.size(); id++) {
+    if (state[id] && base_predicates_[id].node_type == plansys2_msgs::msg::Node::PREDICATE) {
+      ret.push_back(base_predicates_[id]);
     }
+  }
+  return ret;
+}
 
-    if (check(requirement, node->predicates, node->functions, node_id)) {
-      ret = node;
+bool
+BTBuilder::check_state(
+  const plansys2_msgs::msg::Tree & tree,
+  const ActionTemplate::Condition & condition,
+  const GraphNode::Ptr & node) const
+{
+  if (node->state.empty()) {
+    return check(tree, node->predicates, node->functions, condition.node_id);
+  }
+
+  if (condition.predicate >= 0) {
+    size_t id = condition.predicate;
+    bool value = id < node->state.size() && node->state[id];
+    return value != condition.negate;
+  }
+
+  // Other conditions go through the generic evaluation. Predicates are only built if needed
+  std::vector<plansys2_msgs::msg::Node> used_predicates;
+  parser::pddl::getPredicates(used_predicates, tree, condition.node_id);
+
+  std::vector<plansys2::Predicate> predicates;
+  if (!used_predicates.empty()) {
+    predicates = get_state_predicates(node->state);
+  }
+  return check(tree, predicates, node->functions, condition.node_id);
+}
+
+void
+BTBuilder::apply_effects(
+  const plansys2_msgs::msg::Tree & tree,
+  const std::vector<ActionTemplate::Effect> & effects,
+  const GraphNode::Ptr & node) const
+{
+  for (const auto & effect : effects) {
+    if (effect.predicate >= 0) {
+      size_t id = effect.predicate;
+      if (id >= node->state.size()) {
+        node->state.resize(id + 1, false);
+      }
+      node->state[id] = !effect.negate;
+    } else {
+      std::vector<plansys2::Predicate> predicates;
+      evaluate(tree, predicates, node->functions, true, effect.node_id);
     }
   }
+}
+
+void
+BTBuilder::apply_effects(const GraphNode::Ptr & node) const
+{
+  apply_effects(
+    node->action.action->at_start_effects, node->action_template->at_start_effects, node);
+  apply_effects(
+    node->action.action->at_end_effects, node->action_template->at_end_effects, node);
+}
+
+GraphNode::Ptr
+BTBuilder::get_node_satisfy(
+  const plansys2_msgs::msg::Tree & requirement,
+  uint32_t node_id,
+  const GraphNode::Ptr & node,
+  const GraphNode::Ptr & current)
+{
+  std::map<GraphNode::Ptr, GraphNode::Ptr> visited;
+  return get_node_satisfy(
+    requirement, get_condition(requirement, node_id), node, current, visited);
+}
+
+GraphNode::Ptr
+BTBuilder::get_node_satisfy(
+  const plansys2_msgs::msg::Tree & requirement,
+  const ActionTemplate::Condition & condition,
+  const GraphNode::Ptr & node,
+  const GraphNode::Ptr & current,
+  std::map<GraphNode::Ptr, GraphNode::Ptr> & visited)
+{
+  if (node == current) {
+    return nullptr;
+  }
+
+  // Nodes reachable through several paths give the same answer every time
+  auto it = visited.find(node);
+  if (it != visited.end()) {
+    return it->second;
+  }
+
+  if (node->action_template == nullptr) {
+    node->action_template = get_action_template(node->action.action);
+  }
+
+  GraphNode::Ptr ret = nullptr;
+  if (node->action_template->bases.count(condition.base) > 0 &&
+    check_state(requirement, condition, node))
+  {
+    ret = node;
+  }
 
   for (const auto & arc : node->out_arcs) {
-    auto node_ret = get_node_satisfy(requirement, node_id, arc, current);
+    auto node_ret = get_node_satisfy(requirement, condition, arc, current, visited);
 
     if (node_ret != nullptr) {
       ret = node_ret;
     }
   }
 
+  visited[node] = ret;
   return ret;
 }
 
 bool
 BTBuilder::is_parallelizable(
   const plansys2::ActionStamped & action,
-  const std::list<GraphNode::Ptr> & ret) const
+  const std::list<GraphNode::Ptr> & ret)
 {
-  std::vector<plansys2_msgs::msg::Node> action_at_start_requirements;
-  parser::pddl::getPredicates(action_at_start_requirements, action.action->at_start_requirements);
+  auto action_template = get_action_template(action.action);
 
   for (const auto & other : ret) {
-    std::vector<plansys2_msgs::msg::Node> other_over_all_requirements;
-    parser::pddl::getPredicates(
-      other_over_all_requirements,
-      other->action.action->over_all_requirements);
-
-    for (const auto & prev_over_all_req : other_over_all_requirements) {
-      for (const auto & action_at_start_req : action_at_start_requirements) {
-        if (parser::pddl::toString(prev_over_all_req) ==
-          parser::pddl::toString(action_at_start_req) &&
-          prev_over_all_req.negate == action_at_start_req.negate)
-        {
-          return false;
-        }
+    if (other->action_template == nullptr) {
+      other->action_template = get_action_template(other->action.action);
+    }
+
+    for (const auto & literal : action_template->at_start_literals) {
+      if (other->action_template->over_all_literals.count(literal) > 0) {
+        return false;
       }
     }
   }
@@ -251,9 +456,12 @@ BTBuilder::get_node_satisfy(
   const std::list<GraphNode::Ptr> & roots,
   const GraphNode::Ptr & current)
 {
+  auto condition = get_condition(requirement, node_id);
+  std::map<GraphNode::Ptr, GraphNode::Ptr> visited;
+
   GraphNode::Ptr ret;
   for (const auto & node : roots) {
-    auto node_ret = get_node_satisfy(requirement, node_id, node, current);
+    auto node_ret = get_node_satisfy(requirement, condition, node, current, visited);
     if (node_ret != nullptr) {
       ret = node_ret;
     }
@@ -262,6 +470,91 @@ BTBuilder::get_node_satisfy(
   return ret;
 }
 
+GraphNode::Ptr
+BTBuilder::find_node_satisfy(
+  const plansys2_msgs::msg::Tree & requirement,
+  const ActionTemplate::Condition & condition,
+  const std::list<GraphNode::Ptr> & roots,
+  const GraphNode::Ptr & current,
+  const std::map<int, std::vector<GraphNode::Ptr>> & producers)
+{
+  auto producers_it = producers.find(condition.base);
+  if (producers_it == producers.end()) {
+    return nullptr;
+  }
+
+  GraphNode::Ptr ret;
+  int candidates = 0;
+  for (const auto & node : producers_it->second) {
+    if (node != current && check_state(requirement, condition, node)) {
+      ret = node;
+      if (++candidates > 1) {
+        break;
+      }
+    }
+  }
+
+  if (candidates <= 1) {
+    return ret;
+  }
+
+  // Several nodes satisfy the requirement. Pick the same one than a traversal from the roots
+  std::map<GraphNode::Ptr, GraphNode::Ptr> visited;
+  ret = nullptr;
+  for (const auto & node : roots) {
+    auto node_ret = get_node_satisfy(requirement, condition, node, current, visited);
+    if (node_ret != nullptr) {
+      ret = node_ret;
+    }
+  }
+
+  return ret;
+}
+
+std::vector<uint32_t>
+BTBuilder::connect_requirements(
+  const plansys2_msgs::msg::Tree & tree,
+  const std::vector<ActionTemplate::Condition> & requirements,
+  const std::list<GraphNode::Ptr> & roots,
+  const GraphNode::Ptr & new_node,
+  const std::map<int, std::vector<GraphNode::Ptr>> & producers)
+{
+  std::vector<uint32_t> unsatisfied;
+
+  for (const auto & requirement : requirements) {
+    auto node_satisfy = find_node_satisfy(tree, requirement, roots, new_node, producers);
+    if (node_satisfy == nullptr) {
+      unsatisfied.push_back(requirement.node_id);
+      continue;
+    }
+
+    prune_backwards(new_node, node_satisfy);
+
+    // Create the connections to the parent node
+    new_node->in_arcs.insert(node_satisfy);
+    node_satisfy->out_arcs.insert(new_node);
+
+    // Copy the state from the parent node
+    new_node->state = node_satisfy->state;
+    new_node->functions = node_satisfy->functions;
+
+    // Apply the effects of the new node
+    apply_effects(new_node);
+  }
+
+  return unsatisfied;
+}
+
+void
+BTBuilder::index_node(
+  const GraphNode::Ptr & node,
+  std::map<int, std::vector<GraphNode::Ptr>> & producers) const
+{
+  for (const auto & base : node->action_template->bases) {
+    producers[base].push_back(node);
+  }
+}
+
 std::list<GraphNode::Ptr>
 BTBuilder::get_roots(
   std::vector<plansys2::ActionStamped> & action_sequence,
@@ -277,6 +570,7 @@ BTBuilder::get_roots(
     if (is_action_executable(action, predicates, functions) && is_parallelizable(action, ret)) {
       auto new_root = GraphNode::make_shared();
       new_root->action = action;
+      new_root->action_template = get_action_template(action.action);
       new_root->node_num = node_counter++;
       new_root->level_num = 0;
 
@@ -310,9 +604,22 @@ BTBuilder::remove_existing_requirements(
 void
 BTBuilder::prune_backwards(GraphNode::Ptr new_node, GraphNode::Ptr node_satisfy)
 {
+  std::set<GraphNode::Ptr> visited;
+  prune_backwards(new_node, node_satisfy, visited);
+}
+
+void
+BTBuilder::prune_backwards(
+  GraphNode::Ptr new_node, GraphNode::Ptr node_satisfy,
+  std::set<GraphNode::Ptr> & visited)
+{
+  if (!visited.insert(node_satisfy).second) {
+    return;
+  }
+
   // Repeat prune to the roots
   for (auto & in : node_satisfy->in_arcs) {
-    prune_backwards(new_node, in);
+    prune_backwards(new_node, in, visited);
   }
 
   auto it = node_satisfy->out_arcs.begin();
@@ -327,15 +634,15 @@ BTBuilder::prune_backwards(GraphNode::Ptr new_node, GraphNode::Ptr node_satisfy)
 }
 
 void
-BTBuilder::prune_forward(GraphNode::Ptr current, std::list<GraphNode::Ptr> & used_nodes)
+BTBuilder::prune_forward(GraphNode::Ptr current, std::set<GraphNode::Ptr> & used_nodes)
 {
   auto it = current->out_arcs.begin();
   while (it != current->out_arcs.end()) {
-    if (std::find(used_nodes.begin(), used_nodes.end(), *it) != used_nodes.end()) {
+    if (used_nodes.count(*it) > 0) {
       it = current->out_arcs.erase(it);
     } else {
       prune_forward(*it, used_nodes);
-      used_nodes.push_back(*it);
+      used_nodes.insert(*it);
 
       ++it;
     }
@@ -349,25 +656,27 @@ BTBuilder::get_graph(const plansys2_msgs::msg::Plan & current_plan)
   int level_counter = 0;
   auto graph = Graph::make_shared();
 
+  update_domain_version();
+
   auto action_sequence = get_plan_actions(current_plan);
   auto predicates = problem_client_->getPredicates();
   auto functions = problem_client_->getFunctions();
+  const auto initial_state = get_state(predicates);
+  const auto initial_functions = functions;
+
+  // Nodes reachable from the roots, indexed by the predicates and functions they use
+  std::map<int, std::vector<GraphNode::Ptr>> producers;
 
   graph->roots = get_roots(action_sequence, predicates, functions, node_counter);
 
   // Apply root actions
   for (auto & action_node : graph->roots) {
     // Create a local copy of the state
-    action_node->predicates = problem_client_->getPredicates();
-    action_node->functions = problem_client_->getFunctions();
+    action_node->state = initial_state;
+    action_node->functions = initial_functions;
 
     // Apply the effects to the local node state
-    apply(
-      action_node->action.action->at_start_effects,
-      action_node->predicates, action_node->functions);
-    apply(
-      action_node->action.action->at_end_effects,
-      action_node->predicates, action_node->functions);
+    apply_effects(action_node);
 
     // Apply the effects to the global state
     apply(
@@ -376,6 +685,8 @@ BTBuilder::get_graph(const plansys2_msgs::msg::Plan & current_plan)
     apply(
       action_node->action.action->at_end_effects,
       predicates, functions);
+
+    index_node(action_node, producers);
   }
 
 
@@ -383,6 +694,7 @@ BTBuilder::get_graph(const plansys2_msgs::msg::Plan & current_plan)
   while (!action_sequence.empty()) {
     auto new_node = GraphNode::make_shared();
     new_node->action = *action_sequence.begin();
+    new_node->action_template = get_action_template(new_node->action.action);
     new_node->node_num = node_counter++;
     float time = new_node->action.time;
 
@@ -397,135 +709,44 @@ BTBuilder::get_graph(const plansys2_msgs::msg::Plan & current_plan)
     }
     new_node->level_num = level_counter;
 
-    std::vector<uint32_t> at_start_requirements =
-      parser::pddl::getSubtrees(action_sequence.begin()->action->at_start_requirements);
-    std::vector<uint32_t> over_all_requirements =
-      parser::pddl::getSubtrees(action_sequence.begin()->action->over_all_requirements);
-    std::vector<uint32_t> at_end_requirements =
-      parser::pddl::getSubtrees(action_sequence.begin()->action->at_end_requirements);
-
-    auto it_at_start = at_start_requirements.begin();
-    while (it_at_start != at_start_requirements.end()) {
-      auto node_satisfy =
-        get_node_satisfy(
-        action_sequence.begin()->action->at_start_requirements,
-        *it_at_start,
-        graph->roots,
-        new_node);
-      if (node_satisfy != nullptr) {
-        prune_backwards(new_node, node_satisfy);
-
-        // Create the connections to the parent node
-        new_node->in_arcs.insert(node_satisfy);
-        node_satisfy->out_arcs.insert(new_node);
-
-        // Copy the state from the parent node
-        new_node->predicates = node_satisfy->predicates;
-        new_node->functions = node_satisfy->functions;
-
-        // Apply the effects of the new node
-        apply(
-          new_node->action.action->at_start_effects,
-          new_node->predicates, new_node->functions);
-        apply(
-          new_node->action.action->at_end_effects,
-          new_node->predicates, new_node->functions);
-
-        it_at_start = at_start_requirements.erase(it_at_start);
-      } else {
-        ++it_at_start;
-      }
-    }
-
-    auto it_over_all = over_all_requirements.begin();
-    while (it_over_all != over_all_requirements.end()) {
-      auto node_satisfy =
-        get_node_satisfy(
-        action_sequence.begin()->action->over_all_requirements,
-        *it_over_all,
-        graph->roots,
-        new_node);
-      if (node_satisfy != nullptr) {
-        prune_backwards(new_node, node_satisfy);
-
-        // Create the connections to the parent node
-        new_node->in_arcs.insert(node_satisfy);
-        node_satisfy->out_arcs.insert(new_node);
-
-        // Copy the state from the parent node
-        new_node->predicates = node_satisfy->predicates;
-        new_node->functions = node_satisfy->functions;
-
-        // Apply the effects of the new node
-        apply(
-          new_node->action.action->at_start_effects,
-          new_node->predicates, new_node->functions);
-        apply(
-          new_node->action.action->at_end_effects,
-          new_node->predicates, new_node->functions);
-
-        it_over_all = over_all_requirements.erase(it_over_all);
-      } else {
-        ++it_over_all;
-      }
-    }
+    const auto & action = new_node->action.action;
+    const auto & action_template = new_node->action_template;
 
-    auto it_at_end = at_end_requirements.begin();
-    while (it_at_end != at_end_requirements.end()) {
-      auto node_satisfy =
-        get_node_satisfy(
-        action_sequence.begin()->action->at_end_requirements,
-        *it_at_end,
-        graph->roots,
-        new_node);
-      if (node_satisfy != nullptr) {
-        prune_backwards(new_node, node_satisfy);
-
-        // Create the connections to the parent node
-        new_node->in_arcs.insert(node_satisfy);
-        node_satisfy->out_arcs.insert(new_node);
-
-        // Copy the state from the parent node
-        new_node->predicates = node_satisfy->predicates;
-        new_node->functions = node_satisfy->functions;
-
-        // Apply the effects of the new node
-        apply(
-          new_node->action.action->at_start_effects,
-          new_node->predicates, new_node->functions);
-        apply(
-          new_node->action.action->at_end_effects,
-          new_node->predicates, new_node->functions);
-
-        it_at_end = at_end_requirements.erase(it_at_end);
-      } else {
-        ++it_at_end;
-      }
-    }
+    std::vector<uint32_t> at_start_requirements = connect_requirements(
+      action->at_start_requirements, action_template->at_start_requirements,
+      graph->roots, new_node, producers);
+    std::vector<uint32_t> over_all_requirements = connect_requirements(
+      action->over_all_requirements, action_template->over_all_requirements,
+      graph->roots, new_node, producers);
+    std::vector<uint32_t> at_end_requirements = connect_requirements(
+      action->at_end_requirements, action_template->at_end_requirements,
+      graph->roots, new_node, producers);
 
     remove_existing_requirements(
-      action_sequence.begin()->action->at_start_requirements, at_start_requirements, predicates,
-      functions);
+      action->at_start_requirements, at_start_requirements, predicates, functions);
     remove_existing_requirements(
-      action_sequence.begin()->action->over_all_requirements, over_all_requirements, predicates,
-      functions);
+      action->over_all_requirements, over_all_requirements, predicates, functions);
     remove_existing_requirements(
-      action_sequence.begin()->action->at_end_requirements, at_end_requirements, predicates,
-      functions);
+      action->at_end_requirements, at_end_requirements, predicates, functions);
 
     for (const auto & req : at_start_requirements) {
       std::cerr << "===> [" << parser::pddl::toString(
-        action_sequence.begin()->action->at_start_requirements, req) << "]" << std::endl;
+        action->at_start_requirements, req) << "]" << std::endl;
     }
 
     assert(at_start_requirements.empty());
     assert(over_all_requirements.empty());
     assert(at_end_requirements.empty());
 
+    // Only nodes hanging from the roots can satisfy the requirements of the next ones
+    if (!new_node->in_arcs.empty()) {
+      index_node(new_node, producers);
+    }
+
     action_sequence.erase(action_sequence.begin());
   }
 
-  std::list<GraphNode::Ptr> used_nodes;
+  std::set<GraphNode::Ptr> used_nodes;
   for (auto & root : graph->roots) {
     prune_forward(root, used_nodes);
   }
@@ -535,11 +756,15 @@ BTBuilder::get_graph(const plansys2_msgs::msg::Plan & current_plan)
 std::string
 BTBuilder::get_tree(const plansys2_msgs::msg::Plan & current_plan)
 {
-  auto action_graph = get_graph(current_plan);
+  return get_tree(get_graph(current_plan));
+}
 
+std::string
+BTBuilder::get_tree(const Graph::Ptr & action_graph)
+{
   std::string bt_plan;
 
-  std::list<std::string> used_nodes;
+  std::set<std::string> used_nodes;
 
   if (action_graph->roots.size() > 1) {
     bt_plan = std::string("<root main_tree_to_execute=\"MainTree\">\n") +
@@ -663,7 +888,7 @@ BTBuilder::get_dotgraph(
 std::string
 BTBuilder::get_flow_tree(
   GraphNode::Ptr node,
-  std::list<std::string> & used_nodes,
+  std::set<std::string> & used_nodes,
   int level)
 {
   std::string ret;
@@ -673,11 +898,11 @@ BTBuilder::get_flow_tree(
     "):" +
     std::to_string(static_cast<int>(node->action.time * 1000));
 
-  if (std::find(used_nodes.begin(), used_nodes.end(), action_id) != used_nodes.end()) {
+  if (used_nodes.count(action_id) > 0) {
     return t(l) + "<WaitAction action=\"" + action_id + "\"/>\n";
   }
 
-  used_nodes.push_back(action_id);
+  used_nodes.insert(action_id);
 
   if (node->out_arcs.size() == 0) {
     ret = ret + execution_block(node, l);
@@ -881,6 +1106,19 @@ BTBuilder::execution_block(const GraphNode::Ptr & node, int l)
   return ret;
 }
 
+void
+BTBuilder::update_domain_version()
+{
+  // Templates and interned predicates of a previous domain are no longer valid
+  auto domain_version = domain_client_->getUpdateCount();
+  if (domain_version != domain_version_) {
+    action_templates_.clear();
+    base_ids_.clear();
+    base_predicates_.clear();
+    domain_version_ = domain_version;
+  }
+}
+
 std::vector<ActionStamped>
 BTBuilder::get_plan_actions(const plansys2_msgs::msg::Plan & plan)
 {
@@ -891,9 +1129,21 @@ BTBuilder::get_plan_actions(const plansys2_msgs::msg::Plan & plan)
 
     action_stamped.time = item.time;
     action_stamped.duration = item.duration;
-    action_stamped.action =
-      domain_client_->getDurativeAction(
-      get_action_name(item.action), get_action_params(item.action));
+
+    // Grounded actions are requested to the domain expert only the first time
+    auto action_template = action_templates_.find(get_action_expression(item.action));
+    if (action_template != action_templates_.end()) {
+      action_stamped.action = action_template->second->action;
+    } else {
+      action_stamped.action =
+        domain_client_->getDurativeAction(
+        get_action_name(item.action), get_action_params(item.action));
+
+      if (action_stamped.action != nullptr) {
+        action_templates_[get_action_expression(item.action)] =
+          compile_action(action_stamped.action);
+      }
+    }
 
     ret.push_back(action_stamped);
   }
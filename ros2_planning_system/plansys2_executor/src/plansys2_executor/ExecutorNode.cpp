@@ -12,15 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <filesystem>
-
 #include <algorithm>
+#include <chrono>
 #include <string>
 #include <memory>
 #include <iostream>
 #include <fstream>
 #include <map>
 #include <set>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "plansys2_executor/ExecutorNode.hpp"
@@ -59,13 +60,19 @@ using ExecutePlan = plansys2_msgs::action::ExecutePlan;
 using namespace std::chrono_literals;
 
 ExecutorNode::ExecutorNode()
-: rclcpp_lifecycle::LifecycleNode("executor")
+: rclcpp_lifecycle::LifecycleNode("executor"),
+  tick_requested_(false),
+  changes_(0)
 {
   using namespace std::placeholders;
 
   this->declare_parameter<std::string>("default_action_bt_xml_filename", "");
   this->declare_parameter<bool>("enable_dotgraph_legend", true);
   this->declare_parameter<bool>("print_graph", false);
+  this->declare_parameter<bool>("enable_bt_xml_output", false);
+  this->declare_parameter<double>("bt_max_tick_rate", 100.0);
+  this->declare_parameter<double>("bt_min_tick_rate", 10.0);
+  this->declare_parameter<bool>("routed_actions_hub", false);
   this->declare_parameter("action_timeouts.actions", std::vector<std::string>{});
   // Declaring individual action parameters so they can be queried on the command line
   auto action_timeouts_actions = this->get_parameter("action_timeouts.actions").as_string_array();
@@ -138,6 +145,13 @@ ExecutorNode::on_configure(const rclcpp_lifecycle::State & state)
   problem_client_ = std::make_shared<plansys2::ProblemExpertClient>();
   planner_client_ = std::make_shared<plansys2::PlannerClient>();
 
+  // Kept across plans, so grounded actions are only compiled once
+  bt_builder_ = std::make_shared<BTBuilder>(aux_node_, action_bt_xml_);
+
+  update_sub_ = create_subscription<std_msgs::msg::Empty>(
+    "problem_expert/update_notify", rclcpp::QoS(100),
+    [this](const std_msgs::msg::Empty::SharedPtr msg) {request_tick();});
+
   execution_info_pub_ = create_publisher<plansys2_msgs::msg::ActionExecutionInfo>(
     "/action_execution_info", 100);
 
@@ -171,6 +185,8 @@ ExecutorNode::on_cleanup(const rclcpp_lifecycle::State & state)
 {
   RCLCPP_INFO(get_logger(), "[%s] Cleaning up...", get_name());
   dotgraph_pub_.reset();
+  update_sub_.reset();
+  bt_builder_.reset();
   RCLCPP_INFO(get_logger(), "[%s] Cleaned up", get_name());
 
   return CallbackReturnT::SUCCESS;
@@ -217,41 +233,59 @@ ExecutorNode::getOrderedSubGoals()
   }
 
   auto goal = problem_client_->getGoal();
-  auto local_predicates = problem_client_->getPredicates();
   auto local_functions = problem_client_->getFunctions();
 
+  FactIndex fact_index;
+  FactState state;
+  state.build(fact_index, problem_client_->getPredicates(), local_functions);
+
   std::vector<plansys2_msgs::msg::Tree> ordered_goals;
-  std::vector<uint32_t> unordered_subgoals = parser::pddl::getSubtrees(goal);
+  std::vector<std::pair<uint32_t, CompiledExpression>> unordered_subgoals;
+  for (auto subgoal : parser::pddl::getSubtrees(goal)) {
+    unordered_subgoals.emplace_back(subgoal, CompiledExpression(goal, fact_index, subgoal));
+  }
+
+  auto add_satisfied_subgoals = [&]() {
+      for (auto it = unordered_subgoals.begin(); it != unordered_subgoals.end(); ) {
+        if (it->second.check(state)) {
+          plansys2_msgs::msg::Tree new_goal;
+          parser::pddl::fromString(
+            new_goal, "(and " + parser::pddl::toString(goal, it->first) + ")");
+          ordered_goals.push_back(new_goal);
+          it = unordered_subgoals.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    };
 
   // just in case some goals are already satisfied
-  for (auto it = unordered_subgoals.begin(); it != unordered_subgoals.end(); ) {
-    if (check(goal, local_predicates, local_functions, *it)) {
-      plansys2_msgs::msg::Tree new_goal;
-      parser::pddl::fromString(new_goal, "(and " + parser::pddl::toString(goal, (*it)) + ")");
-      ordered_goals.push_back(new_goal);
-      it = unordered_subgoals.erase(it);
-    } else {
-      ++it;
-    }
-  }
+  add_satisfied_subgoals();
 
   for (const auto & plan_item : current_plan_.value().items) {
     std::shared_ptr<plansys2_msgs::msg::DurativeAction> action =
       domain_client_->getDurativeAction(
       get_action_name(plan_item.action), get_action_params(plan_item.action));
-    apply(action->at_start_effects, local_predicates, local_functions);
-    apply(action->at_end_effects, local_predicates, local_functions);
-
-    for (auto it = unordered_subgoals.begin(); it != unordered_subgoals.end(); ) {
-      if (check(goal, local_predicates, local_functions, *it)) {
-        plansys2_msgs::msg::Tree new_goal;
-        parser::pddl::fromString(new_goal, "(and " + parser::pddl::toString(goal, (*it)) + ")");
-        ordered_goals.push_back(new_goal);
-        it = unordered_subgoals.erase(it);
-      } else {
-        ++it;
+
+    for (const auto * effects : {&action->at_start_effects, &action->at_end_effects}) {
+      std::vector<plansys2::Predicate> remove_predicates;
+      std::vector<plansys2::Predicate> add_predicates;
+      std::vector<plansys2::Function> update_functions;
+      get_effects(
+        *effects, local_functions, remove_predicates, add_predicates, update_functions);
+
+      for (const auto & predicate : remove_predicates) {
+        state.set(fact_index.getId(predicate), false);
+      }
+      for (const auto & predicate : add_predicates) {
+        state.set(fact_index.getId(predicate), true);
+      }
+      for (const auto & function : update_functions) {
+        state.set(fact_index.getId(function), true, function.value);
       }
     }
+
+    add_satisfied_subgoals();
   }
 
   return ordered_goals;
@@ -292,6 +326,7 @@ ExecutorNode::handle_cancel(
   RCLCPP_DEBUG(this->get_logger(), "Received request to cancel goal");
 
   cancel_plan_requested_ = true;
+  request_tick();
 
   return rclcpp_action::CancelResponse::ACCEPT;
 }
@@ -322,6 +357,8 @@ ExecutorNode::execute(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
     (*action_map)[index] = ActionExecutionInfo();
     (*action_map)[index].action_executor =
       ActionExecutor::make_shared(plan_item.action, shared_from_this());
+    (*action_map)[index].action_executor->set_change_callback(
+      std::bind(&ExecutorNode::request_tick, this));
     (*action_map)[index].durative_action_info =
       domain_client_->getDurativeAction(
       get_action_name(plan_item.action), get_action_params(plan_item.action));
@@ -342,7 +379,6 @@ ExecutorNode::execute(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
   }
   ordered_sub_goals_ = getOrderedSubGoals();
 
-  BTBuilder bt_builder(aux_node_, action_bt_xml_);
   auto blackboard = BT::Blackboard::create();
 
   blackboard->set("action_map", action_map);
@@ -360,19 +396,25 @@ ExecutorNode::execute(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
   factory.registerNodeType<ApplyAtEndEffect>("ApplyAtEndEffect");
   factory.registerNodeType<CheckTimeout>("CheckTimeout");
 
-  auto bt_xml_tree = bt_builder.get_tree(current_plan_.value());
-  auto action_graph = bt_builder.get_graph(current_plan_.value());
+  auto action_graph = bt_builder_->get_graph(current_plan_.value());
+  auto bt_xml_tree = bt_builder_->get_tree(action_graph);
+
+  const bool enable_dotgraph_legend = this->get_parameter("enable_dotgraph_legend").as_bool();
+  size_t dotgraph_subscribers = dotgraph_pub_->get_subscription_count();
   std_msgs::msg::String dotgraph_msg;
-  dotgraph_msg.data =
-    bt_builder.get_dotgraph(
-    action_graph, action_map, this->get_parameter(
-      "enable_dotgraph_legend").as_bool(), this->get_parameter("print_graph").as_bool());
-  dotgraph_pub_->publish(dotgraph_msg);
+  if (dotgraph_subscribers > 0 || this->get_parameter("print_graph").as_bool()) {
+    dotgraph_msg.data =
+      bt_builder_->get_dotgraph(
+      action_graph, action_map, enable_dotgraph_legend,
+      this->get_parameter("print_graph").as_bool());
+    dotgraph_pub_->publish(dotgraph_msg);
+  }
 
-  std::filesystem::path tp = std::filesystem::temp_directory_path();
-  std::ofstream out(std::string("/tmp/") + get_namespace() + "/bt.xml");
-  out << bt_xml_tree;
-  out.close();
+  if (this->get_parameter("enable_bt_xml_output").as_bool()) {
+    std::ofstream out(std::string("/tmp/") + get_namespace() + "/bt.xml");
+    out << bt_xml_tree;
+    out.close();
+  }
 
   auto tree = factory.createTreeFromText(bt_xml_tree, blackboard);
 
@@ -400,17 +442,54 @@ ExecutorNode::execute(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
 
   auto info_pub = create_wall_timer(
     1s, [this, &action_map]() {
+      if (execution_info_pub_->get_subscription_count() == 0) {
+        return;
+      }
+
       auto msgs = get_feedback_info(action_map);
       for (const auto & msg : msgs) {
         execution_info_pub_->publish(msg);
       }
     });
 
-  rclcpp::Rate rate(10);
-  auto start = now();
+  // Ticks are triggered by changes in the actions or in the problem, limited to
+  // bt_max_tick_rate. Without changes, the tree is still ticked at bt_min_tick_rate
+  // to check timeouts and requirements.
+  using Seconds = std::chrono::duration<double>;
+  const auto min_tick_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    Seconds(1.0 / std::max(this->get_parameter("bt_max_tick_rate").as_double(), 1e-3)));
+  const auto max_tick_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    Seconds(1.0 / std::max(this->get_parameter("bt_min_tick_rate").as_double(), 1e-3)));
+
+  auto last_tick = std::chrono::steady_clock::now() - min_tick_period;
+  bool feedback_published = false;
+  uint64_t feedback_changes = 0;
+  uint64_t dotgraph_changes = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(tick_mutex_);
+    tick_requested_ = false;
+    dotgraph_changes = changes_;
+  }
+
   auto status = BT::NodeStatus::RUNNING;
 
   while (status == BT::NodeStatus::RUNNING && !cancel_plan_requested_) {
+    {
+      std::unique_lock<std::mutex> lock(tick_mutex_);
+      tick_cv_.wait_until(
+        lock, last_tick + max_tick_period,
+        [this] {return tick_requested_ || cancel_plan_requested_;});
+      tick_requested_ = false;
+    }
+
+    std::this_thread::sleep_until(last_tick + min_tick_period);
+    last_tick = std::chrono::steady_clock::now();
+
+    if (cancel_plan_requested_) {
+      break;
+    }
+
     try {
       status = tree.tickRoot();
     } catch (std::exception & e) {
@@ -418,16 +497,28 @@ ExecutorNode::execute(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
       status == BT::NodeStatus::FAILURE;
     }
 
-    feedback->action_execution_status = get_feedback_info(action_map);
-    goal_handle->publish_feedback(feedback);
+    uint64_t changes;
+    {
+      std::lock_guard<std::mutex> lock(tick_mutex_);
+      changes = changes_;
+    }
 
-    dotgraph_msg.data =
-      bt_builder.get_dotgraph(
-      action_graph, action_map, this->get_parameter(
-        "enable_dotgraph_legend").as_bool());
-    dotgraph_pub_->publish(dotgraph_msg);
+    if (!feedback_published || changes != feedback_changes) {
+      feedback->action_execution_status = get_feedback_info(action_map);
+      goal_handle->publish_feedback(feedback);
+      feedback_published = true;
+      feedback_changes = changes;
+    }
 
-    rate.sleep();
+    // The dot graph is only built if someone listens, and it changed or is new for them
+    size_t subscribers = dotgraph_pub_->get_subscription_count();
+    if (subscribers > 0 && (changes != dotgraph_changes || subscribers > dotgraph_subscribers)) {
+      dotgraph_msg.data = bt_builder_->get_dotgraph(
+        action_graph, action_map, enable_dotgraph_legend);
+      dotgraph_pub_->publish(dotgraph_msg);
+      dotgraph_changes = changes;
+    }
+    dotgraph_subscribers = subscribers;
   }
 
   if (cancel_plan_requested_) {
@@ -439,11 +530,11 @@ ExecutorNode::execute(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
     RCLCPP_ERROR(get_logger(), "Executor BT finished with FAILURE state");
   }
 
-  dotgraph_msg.data =
-    bt_builder.get_dotgraph(
-    action_graph, action_map, this->get_parameter(
-      "enable_dotgraph_legend").as_bool());
-  dotgraph_pub_->publish(dotgraph_msg);
+  if (dotgraph_pub_->get_subscription_count() > 0) {
+    dotgraph_msg.data =
+      bt_builder_->get_dotgraph(action_graph, action_map, enable_dotgraph_legend);
+    dotgraph_pub_->publish(dotgraph_msg);
+  }
 
   result->success = status == BT::NodeStatus::SUCCESS;
   result->action_execution_status = get_feedback_info(action_map);
@@ -468,6 +559,17 @@ ExecutorNode::execute(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
   }
 }
 
+void
+ExecutorNode::request_tick()
+{
+  {
+    std::lock_guard<std::mutex> lock(tick_mutex_);
+    tick_requested_ = true;
+    changes_++;
+  }
+  tick_cv_.notify_one();
+}
+
 void
 ExecutorNode::handle_accepted(const std::shared_ptr<GoalHandleExecutePlan> goal_handle)
 {
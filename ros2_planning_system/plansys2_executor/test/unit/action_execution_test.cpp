@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <regex>
@@ -124,6 +125,9 @@ TEST(action_execution, protocol_basic)
   ASSERT_EQ(move_action_executor->get_action_params()[0], "r2d2");
   ASSERT_EQ(move_action_executor->get_action_params()[2], "assembly_zone");
 
+  std::atomic<int> changes {0};
+  move_action_executor->set_change_callback([&changes]() {changes++;});
+
   move_action_node->set_parameter({"action_name", "move"});
 
   rclcpp::executors::MultiThreadedExecutor exe(rclcpp::executor::ExecutorArgs(), 8);
@@ -216,6 +220,8 @@ TEST(action_execution, protocol_basic)
   ASSERT_EQ(action_execution_msgs[6].type, plansys2_msgs::msg::ActionExecution::FEEDBACK);
   ASSERT_EQ(action_execution_msgs[7].type, plansys2_msgs::msg::ActionExecution::FINISH);
 
+  // Dealing, running, four feedbacks and the finish
+  ASSERT_EQ(changes, 7);
 
   ASSERT_EQ(move_action_executor->get_internal_status(), plansys2::ActionExecutor::Status::SUCCESS);
   ASSERT_EQ(
@@ -348,6 +354,89 @@ TEST(action_execution, protocol_cancelation)
   t.join();
 }
 
+TEST(action_execution, protocol_routed)
+{
+  auto test_node = rclcpp::Node::make_shared("test_node");
+  auto test_lf_node = rclcpp_lifecycle::LifecycleNode::make_shared("test_lf_node");
+  test_lf_node->declare_parameter("routed_actions_hub", true);
+
+  auto move_action_node = std::make_shared<MoveAction>("move_action", 1s);
+  move_action_node->set_parameter({"action_name", "move"});
+  move_action_node->set_parameter({"routed_actions_hub", true});
+
+  auto move_action_executor = plansys2::ActionExecutor::make_shared(
+    "(move r2d2 steering_wheels_zone assembly_zone)", test_lf_node);
+  auto other_action_executor = plansys2::ActionExecutor::make_shared(
+    "(move r2d2 assembly_zone steering_wheels_zone)", test_lf_node);
+
+  rclcpp::executors::MultiThreadedExecutor exe(rclcpp::executor::ExecutorArgs(), 8);
+
+  exe.add_node(test_node);
+  exe.add_node(test_lf_node->get_node_base_interface());
+  exe.add_node(move_action_node->get_node_base_interface());
+
+  std::vector<plansys2_msgs::msg::ActionExecution> action_execution_msgs;
+  std::vector<plansys2_msgs::msg::ActionExecution> performer_msgs;
+
+  auto action_hub_sub = test_node->create_subscription<plansys2_msgs::msg::ActionExecution>(
+    "/actions_hub", rclcpp::QoS(100).reliable(),
+    [&action_execution_msgs](const plansys2_msgs::msg::ActionExecution::SharedPtr msg) {
+      action_execution_msgs.push_back(*msg);
+    });
+  auto performer_sub = test_node->create_subscription<plansys2_msgs::msg::ActionExecution>(
+    plansys2::ActionHub::get_performer_topic("move_action"),
+    rclcpp::QoS(100).reliable().transient_local(),
+    [&performer_msgs](const plansys2_msgs::msg::ActionExecution::SharedPtr msg) {
+      performer_msgs.push_back(*msg);
+    });
+
+  bool finish = false;
+  std::thread t([&]() {
+      while (!finish) {exe.spin_some();}
+    });
+
+  move_action_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+
+  {
+    rclcpp::Rate rate(10);
+    auto start = test_node->now();
+    while ((test_node->now() - start).seconds() < 0.5) {
+      rate.sleep();
+    }
+  }
+
+  {
+    rclcpp::Rate rate(10);
+    auto start = test_node->now();
+    while ((test_node->now() - start).seconds() < 6) {
+      move_action_executor->tick(test_node->now());
+      rate.sleep();
+    }
+  }
+
+  ASSERT_EQ(move_action_executor->get_internal_status(), plansys2::ActionExecutor::Status::SUCCESS);
+  ASSERT_EQ(other_action_executor->get_internal_status(), plansys2::ActionExecutor::Status::IDLE);
+  ASSERT_EQ(
+    move_action_node->get_internal_status().state,
+    plansys2_msgs::msg::ActionPerformerStatus::READY);
+
+  // Only messages from the performer go through the shared hub
+  ASSERT_FALSE(action_execution_msgs.empty());
+  for (const auto & msg : action_execution_msgs) {
+    ASSERT_TRUE(
+      msg.type == plansys2_msgs::msg::ActionExecution::RESPONSE ||
+      msg.type == plansys2_msgs::msg::ActionExecution::FEEDBACK ||
+      msg.type == plansys2_msgs::msg::ActionExecution::FINISH);
+  }
+  ASSERT_EQ(action_execution_msgs.back().type, plansys2_msgs::msg::ActionExecution::FINISH);
+
+  ASSERT_EQ(performer_msgs.size(), 1u);
+  ASSERT_EQ(performer_msgs[0].type, plansys2_msgs::msg::ActionExecution::CONFIRM);
+
+  finish = true;
+  t.join();
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -668,6 +668,16 @@ TEST(btbuilder_tests, test_plan_3)
 
   std::cerr << bt << std::endl;
 
+  // Building the graph again reuses the compiled actions
+  auto graph_1 = btbuilder->get_graph(plan.value());
+  auto graph_2 = btbuilder->get_graph(plan.value());
+  ASSERT_EQ(graph_1->roots.size(), graph_2->roots.size());
+  ASSERT_EQ(graph_1->levels.size(), graph_2->levels.size());
+  ASSERT_FALSE(graph_1->roots.empty());
+  ASSERT_NE(graph_1->roots.front()->action_template, nullptr);
+  ASSERT_EQ(
+    graph_1->roots.front()->action_template,
+    graph_2->roots.front()->action_template);
 
   finish = true;
   t.join();
@@ -791,6 +801,113 @@ TEST(btbuilder_tests, test_plan_4)
 }
 
 
+TEST(btbuilder_tests, test_domain_change)
+{
+  auto test_node = rclcpp::Node::make_shared("test_domain_change");
+  auto domain_node = std::make_shared<plansys2::DomainExpertNode>();
+  auto problem_node = std::make_shared<plansys2::ProblemExpertNode>();
+
+  auto problem_client = std::make_shared<plansys2::ProblemExpertClient>();
+
+  auto btbuilder = std::make_shared<BTBuilderTest>(test_node);
+
+  std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_executor");
+
+  domain_node->set_parameter({"model_file", pkgpath + "/pddl/domain_simple_2.pddl"});
+  problem_node->set_parameter({"model_file", pkgpath + "/pddl/domain_simple_2.pddl"});
+
+  rclcpp::executors::MultiThreadedExecutor exe(rclcpp::executor::ExecutorArgs(), 8);
+
+  exe.add_node(domain_node->get_node_base_interface());
+  exe.add_node(problem_node->get_node_base_interface());
+
+  bool finish = false;
+  std::thread t([&]() {
+      while (!finish) {exe.spin_some();}
+    });
+
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+  problem_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+
+  {
+    rclcpp::Rate rate(10);
+    auto start = test_node->now();
+    while ((test_node->now() - start).seconds() < 0.5) {
+      rate.sleep();
+    }
+  }
+
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_ACTIVATE);
+  problem_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_ACTIVATE);
+
+  {
+    rclcpp::Rate rate(10);
+    auto start = test_node->now();
+    while ((test_node->now() - start).seconds() < 0.5) {
+      rate.sleep();
+    }
+  }
+
+  ASSERT_TRUE(problem_client->addInstance(plansys2::Instance("leia", "robot")));
+  ASSERT_TRUE(problem_client->addInstance(plansys2::Instance("entrance", "room")));
+  ASSERT_TRUE(problem_client->addInstance(plansys2::Instance("kitchen", "room")));
+
+  std::vector<std::string> predicate_strings = {
+    "(connected entrance kitchen)",
+    "(battery_full leia)",
+    "(robot_at leia entrance)"};
+
+  for (const auto & pred : predicate_strings) {
+    ASSERT_TRUE(problem_client->addPredicate(plansys2::Predicate(pred)));
+  }
+
+  plansys2_msgs::msg::Plan plan;
+  plansys2_msgs::msg::PlanItem item;
+  item.time = 0.0;
+  item.action = "(move leia entrance kitchen)";
+  item.duration = 5.0;
+  plan.items.push_back(item);
+
+  // The first build compiles the move action of the first domain
+  ASSERT_NE(btbuilder->get_graph(plan), nullptr);
+  auto action_sequence = btbuilder->get_plan_actions(plan);
+  ASSERT_EQ(action_sequence.size(), 1u);
+  ASSERT_NE(action_sequence[0].action, nullptr);
+  ASSERT_NE(
+    parser::pddl::toString(action_sequence[0].action->over_all_requirements).find(
+      "battery_full"), std::string::npos);
+
+  // Load a domain where move has no over all requirements
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_DEACTIVATE);
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CLEANUP);
+  domain_node->set_parameter({"model_file", pkgpath + "/pddl/domain_simple.pddl"});
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_ACTIVATE);
+
+  {
+    rclcpp::Rate rate(10);
+    auto start = test_node->now();
+    while ((test_node->now() - start).seconds() < 0.5) {
+      rate.sleep();
+    }
+  }
+
+  // The second build must not reuse the action compiled for the first domain
+  ASSERT_NE(btbuilder->get_graph(plan), nullptr);
+  action_sequence = btbuilder->get_plan_actions(plan);
+  ASSERT_EQ(action_sequence.size(), 1u);
+  ASSERT_NE(action_sequence[0].action, nullptr);
+  ASSERT_EQ(
+    parser::pddl::toString(action_sequence[0].action->over_all_requirements).find(
+      "battery_full"), std::string::npos);
+  ASSERT_EQ(
+    parser::pddl::toString(action_sequence[0].action->at_start_requirements).find(
+      "connected"), std::string::npos);
+
+  finish = true;
+  t.join();
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,104 @@
+// Copyright 2019 Intelligent Robotics Lab
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLANSYS2_POPF_PLAN_SOLVER__POPF_DIRECT_PLAN_SOLVER_HPP_
+#define PLANSYS2_POPF_PLAN_SOLVER__POPF_DIRECT_PLAN_SOLVER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plansys2_core/PlanSolverBase.hpp"
+
+namespace plansys2
+{
+
+/// Plan solver that runs popf without going through files or ros2 run.
+/**
+ * The popf executable is resolved once at configure time and started directly.
+ * The domain and the problem are passed as in-memory files, and the plan is
+ * read and parsed from the solver output. Requests are served by a persistent
+ * pool of worker threads, each one bounded by a timeout, and can be cancelled.
+ *
+ * Parameters, prefixed with the plugin name:
+ *  - arguments: extra arguments for popf.
+ *  - timeout: maximum time in seconds for each request (<= 0 disables it).
+ *  - workers: number of requests that can be solved at the same time.
+ */
+class POPFDirectPlanSolver : public PlanSolverBase
+{
+public:
+  POPFDirectPlanSolver();
+  ~POPFDirectPlanSolver();
+
+  void configure(rclcpp_lifecycle::LifecycleNode::SharedPtr &, const std::string &);
+
+  std::optional<plansys2_msgs::msg::Plan> getPlan(
+    const std::string & domain, const std::string & problem,
+    const std::string & node_namespace = "");
+
+  /// Queue a request and return without waiting for the plan.
+  std::future<std::optional<plansys2_msgs::msg::Plan>> getPlanAsync(
+    const std::string & domain, const std::string & problem);
+
+  /// Abort every queued and running request. Their result is an empty plan.
+  void cancel();
+
+  std::string check_domain(
+    const std::string & domain,
+    const std::string & node_namespace = "");
+
+protected:
+  struct Job
+  {
+    std::string domain;
+    std::string problem;
+    std::vector<std::string> arguments;
+    std::chrono::steady_clock::duration timeout;
+    std::atomic<bool> cancelled {false};
+    std::promise<std::optional<std::string>> output;
+  };
+
+  std::future<std::optional<std::string>> submit(
+    const std::string & domain, const std::string & problem,
+    const std::vector<std::string> & arguments);
+  void worker();
+  std::optional<std::string> run_popf(Job & job);
+  std::vector<std::string> get_arguments();
+
+  std::string popf_path_;
+  std::string arguments_parameter_;
+  std::string timeout_parameter_;
+  rclcpp_lifecycle::LifecycleNode::SharedPtr lc_node_;
+
+  std::mutex mutex_;
+  std::condition_variable jobs_cv_;
+  std::deque<std::shared_ptr<Job>> pending_jobs_;
+  std::list<std::shared_ptr<Job>> running_jobs_;
+  std::vector<std::thread> workers_;
+  bool stop_;
+};
+
+}  // namespace plansys2
+
+#endif  // PLANSYS2_POPF_PLAN_SOLVER__POPF_DIRECT_PLAN_SOLVER_HPP_
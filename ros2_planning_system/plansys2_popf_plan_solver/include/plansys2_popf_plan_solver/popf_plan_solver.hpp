@@ -15,6 +15,7 @@
 #ifndef PLANSYS2_POPF_PLAN_SOLVER__POPF_PLAN_SOLVER_HPP_
 #define PLANSYS2_POPF_PLAN_SOLVER__POPF_PLAN_SOLVER_HPP_
 
+#include <istream>
 #include <optional>
 #include <memory>
 #include <string>
@@ -24,6 +25,13 @@
 namespace plansys2
 {
 
+/// Extract the plan from the output of popf.
+/**
+ * \param[in] popf_output The text written by popf to its standard output.
+ * \return The plan, or nothing if popf did not find a solution.
+ */
+std::optional<plansys2_msgs::msg::Plan> parse_popf_plan(std::istream & popf_output);
+
 class POPFPlanSolver : public PlanSolverBase
 {
 private:
@@ -0,0 +1,333 @@
+// Copyright 2019 Intelligent Robotics Lab
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ament_index_cpp/get_package_prefix.hpp"
+
+#include "plansys2_popf_plan_solver/popf_plan_solver.hpp"
+#include "plansys2_popf_plan_solver/popf_direct_plan_solver.hpp"
+
+namespace plansys2
+{
+
+namespace
+{
+
+bool write_all(int fd, const std::string & data)
+{
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t ret = write(fd, data.data() + written, data.size() - written);
+    if (ret < 0) {
+      return false;
+    }
+    written += ret;
+  }
+  return lseek(fd, 0, SEEK_SET) == 0;
+}
+
+}  // namespace
+
+POPFDirectPlanSolver::POPFDirectPlanSolver()
+: stop_(false)
+{
+}
+
+POPFDirectPlanSolver::~POPFDirectPlanSolver()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cancel();
+  jobs_cv_.notify_all();
+
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+void POPFDirectPlanSolver::configure(
+  rclcpp_lifecycle::LifecycleNode::SharedPtr & lc_node,
+  const std::string & plugin_name)
+{
+  arguments_parameter_ = plugin_name + ".arguments";
+  timeout_parameter_ = plugin_name + ".timeout";
+  lc_node_ = lc_node;
+  lc_node_->declare_parameter<std::string>(arguments_parameter_, "");
+  lc_node_->declare_parameter<double>(timeout_parameter_, 15.0);
+  lc_node_->declare_parameter<int>(plugin_name + ".workers", 2);
+
+  try {
+    popf_path_ = ament_index_cpp::get_package_prefix("popf") + "/lib/popf/popf";
+  } catch (const std::exception & e) {
+    RCLCPP_ERROR(lc_node_->get_logger(), "Unable to find popf: %s", e.what());
+    return;
+  }
+
+  int n_workers = std::max(
+    1, static_cast<int>(lc_node_->get_parameter(plugin_name + ".workers").as_int()));
+
+  if (workers_.empty()) {
+    for (int i = 0; i < n_workers; i++) {
+      workers_.emplace_back(&POPFDirectPlanSolver::worker, this);
+    }
+  }
+}
+
+std::optional<plansys2_msgs::msg::Plan>
+POPFDirectPlanSolver::getPlan(
+  const std::string & domain, const std::string & problem,
+  const std::string & node_namespace)
+{
+  return getPlanAsync(domain, problem).get();
+}
+
+std::future<std::optional<plansys2_msgs::msg::Plan>>
+POPFDirectPlanSolver::getPlanAsync(
+  const std::string & domain, const std::string & problem)
+{
+  auto output = submit(domain, problem, get_arguments());
+
+  return std::async(
+    std::launch::deferred,
+    [output = std::move(output)]() mutable -> std::optional<plansys2_msgs::msg::Plan> {
+      auto result = output.get();
+      if (!result.has_value()) {
+        return {};
+      }
+      std::istringstream popf_output(result.value());
+      return parse_popf_plan(popf_output);
+    });
+}
+
+void
+POPFDirectPlanSolver::cancel()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & job : pending_jobs_) {
+    job->cancelled = true;
+  }
+  for (auto & job : running_jobs_) {
+    job->cancelled = true;
+  }
+}
+
+std::string
+POPFDirectPlanSolver::check_domain(
+  const std::string & domain,
+  const std::string & node_namespace)
+{
+  auto output = submit(domain, "(define (problem void) (:domain plansys2))", {}).get();
+
+  if (!output.has_value()) {
+    return "Domain check could not be completed";
+  }
+  return output.value();
+}
+
+std::future<std::optional<std::string>>
+POPFDirectPlanSolver::submit(
+  const std::string & domain, const std::string & problem,
+  const std::vector<std::string> & arguments)
+{
+  auto job = std::make_shared<Job>();
+  job->domain = domain;
+  job->problem = problem;
+  job->arguments = arguments;
+  job->timeout = std::chrono::steady_clock::duration::zero();
+  if (lc_node_ != nullptr) {
+    job->timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(
+        lc_node_->get_parameter(timeout_parameter_).as_double()));
+  }
+
+  auto ret = job->output.get_future();
+
+  if (workers_.empty()) {
+    job->output.set_value({});
+    return ret;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_jobs_.push_back(job);
+  }
+  jobs_cv_.notify_one();
+
+  return ret;
+}
+
+void
+POPFDirectPlanSolver::worker()
+{
+  while (true) {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobs_cv_.wait(lock, [this] {return stop_ || !pending_jobs_.empty();});
+
+      if (pending_jobs_.empty()) {
+        return;
+      }
+
+      job = pending_jobs_.front();
+      pending_jobs_.pop_front();
+      running_jobs_.push_back(job);
+    }
+
+    std::optional<std::string> output;
+    if (!job->cancelled) {
+      output = run_popf(*job);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_jobs_.remove(job);
+    }
+
+    job->output.set_value(output);
+  }
+}
+
+std::optional<std::string>
+POPFDirectPlanSolver::run_popf(Job & job)
+{
+  int domain_fd = memfd_create("domain.pddl", MFD_CLOEXEC);
+  int problem_fd = memfd_create("problem.pddl", MFD_CLOEXEC);
+  int out_pipe[2] = {-1, -1};
+
+  auto close_fds = [&]() {
+      for (int fd : {domain_fd, problem_fd, out_pipe[0], out_pipe[1]}) {
+        if (fd >= 0) {
+          close(fd);
+        }
+      }
+    };
+
+  if (domain_fd < 0 || problem_fd < 0 || pipe2(out_pipe, O_CLOEXEC) != 0 ||
+    !write_all(domain_fd, job.domain) || !write_all(problem_fd, job.problem))
+  {
+    close_fds();
+    return {};
+  }
+
+  // Everything the child needs is built before fork, so it does not allocate
+  std::vector<std::string> args = {popf_path_};
+  args.insert(args.end(), job.arguments.begin(), job.arguments.end());
+  args.push_back("/dev/fd/" + std::to_string(domain_fd));
+  args.push_back("/dev/fd/" + std::to_string(problem_fd));
+
+  std::vector<char *> argv;
+  for (auto & arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    close_fds();
+    return {};
+  }
+
+  if (pid == 0) {
+    dup2(out_pipe[1], STDOUT_FILENO);
+    fcntl(domain_fd, F_SETFD, 0);
+    fcntl(problem_fd, F_SETFD, 0);
+    execv(argv[0], argv.data());
+    _exit(127);
+  }
+
+  close(out_pipe[1]);
+  out_pipe[1] = -1;
+
+  const auto start = std::chrono::steady_clock::now();
+  const bool use_timeout = job.timeout > std::chrono::steady_clock::duration::zero();
+
+  std::string output;
+  char buffer[4096];
+  bool aborted = false;
+
+  while (true) {
+    if (job.cancelled ||
+      (use_timeout && std::chrono::steady_clock::now() - start > job.timeout))
+    {
+      aborted = true;
+      kill(pid, SIGKILL);
+      break;
+    }
+
+    pollfd pfd {out_pipe[0], POLLIN, 0};
+    int ready = poll(&pfd, 1, 50);
+    if (ready < 0 && errno != EINTR) {
+      aborted = true;
+      kill(pid, SIGKILL);
+      break;
+    }
+    if (ready <= 0) {
+      continue;
+    }
+
+    ssize_t n = read(out_pipe[0], buffer, sizeof(buffer));
+    if (n > 0) {
+      output.append(buffer, n);
+    } else if (n == 0 || errno != EINTR) {
+      break;
+    }
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  close_fds();
+
+  if (aborted) {
+    return {};
+  }
+  return output;
+}
+
+std::vector<std::string>
+POPFDirectPlanSolver::get_arguments()
+{
+  std::vector<std::string> ret;
+  if (lc_node_ == nullptr) {
+    return ret;
+  }
+
+  std::istringstream arguments(lc_node_->get_parameter(arguments_parameter_).as_string());
+  std::string argument;
+  while (arguments >> argument) {
+    ret.push_back(argument);
+  }
+  return ret;
+}
+
+}  // namespace plansys2
+
+#include "pluginlib/class_list_macros.hpp"
+PLUGINLIB_EXPORT_CLASS(plansys2::POPFDirectPlanSolver, plansys2::PlanSolverBase);
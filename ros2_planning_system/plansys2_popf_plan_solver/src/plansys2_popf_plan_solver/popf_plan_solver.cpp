@@ -28,6 +28,44 @@
 namespace plansys2
 {
 
+std::optional<plansys2_msgs::msg::Plan>
+parse_popf_plan(std::istream & popf_output)
+{
+  plansys2_msgs::msg::Plan ret;
+  std::string line;
+  bool solution = false;
+
+  while (getline(popf_output, line)) {
+    if (!solution) {
+      if (line.find("Solution Found") != std::string::npos) {
+        solution = true;
+      }
+    } else if (!line.empty() && line.front() != ';') {
+      plansys2_msgs::msg::PlanItem item;
+      size_t colon_pos = line.find(":");
+      size_t colon_par = line.find(")");
+      size_t colon_bra = line.find("[");
+
+      std::string time = line.substr(0, colon_pos);
+      std::string action = line.substr(colon_pos + 2, colon_par - colon_pos - 1);
+      std::string duration = line.substr(colon_bra + 1);
+      duration.pop_back();
+
+      item.time = std::stof(time);
+      item.action = action;
+      item.duration = std::stof(duration);
+
+      ret.items.push_back(item);
+    }
+  }
+
+  if (ret.items.empty()) {
+    return {};
+  } else {
+    return ret;
+  }
+}
+
 POPFPlanSolver::POPFPlanSolver()
 {
 }
@@ -56,7 +94,6 @@ POPFPlanSolver::getPlan(
     std::filesystem::create_directories(tp);
   }
 
-  plansys2_msgs::msg::Plan ret;
   std::ofstream domain_out("/tmp/" + node_namespace + "/domain.pddl");
   domain_out << domain;
   domain_out.close();
@@ -71,42 +108,12 @@ POPFPlanSolver::getPlan(
     " /tmp/" + node_namespace + "/domain.pddl /tmp/" + node_namespace +
     "/problem.pddl > /tmp/" + node_namespace + "/plan").c_str());
 
-  std::string line;
   std::ifstream plan_file("/tmp/" + node_namespace + "/plan");
-  bool solution = false;
-
-  if (plan_file.is_open()) {
-    while (getline(plan_file, line)) {
-      if (!solution) {
-        if (line.find("Solution Found") != std::string::npos) {
-          solution = true;
-        }
-      } else if (line.front() != ';') {
-        plansys2_msgs::msg::PlanItem item;
-        size_t colon_pos = line.find(":");
-        size_t colon_par = line.find(")");
-        size_t colon_bra = line.find("[");
-
-        std::string time = line.substr(0, colon_pos);
-        std::string action = line.substr(colon_pos + 2, colon_par - colon_pos - 1);
-        std::string duration = line.substr(colon_bra + 1);
-        duration.pop_back();
-
-        item.time = std::stof(time);
-        item.action = action;
-        item.duration = std::stof(duration);
-
-        ret.items.push_back(item);
-      }
-    }
-    plan_file.close();
-  }
-
-  if (ret.items.empty()) {
+  if (!plan_file.is_open()) {
     return {};
-  } else {
-    return ret;
   }
+
+  return parse_popf_plan(plan_file);
 }
 
 std::string
@@ -22,6 +22,7 @@
 
 #include "gtest/gtest.h"
 #include "plansys2_popf_plan_solver/popf_plan_solver.hpp"
+#include "plansys2_popf_plan_solver/popf_direct_plan_solver.hpp"
 
 #include "pluginlib/class_loader.hpp"
 #include "pluginlib/class_list_macros.hpp"
@@ -113,6 +114,75 @@ TEST(popf_plan_solver, check_2_error_domain)
   ASSERT_FALSE(result.empty());
 }
 
+TEST(popf_plan_solver, direct_generate_plan_good)
+{
+  std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_popf_plan_solver");
+  std::ifstream domain_ifs(pkgpath + "/pddl/domain_simple.pddl");
+  std::string domain_str((
+      std::istreambuf_iterator<char>(domain_ifs)),
+    std::istreambuf_iterator<char>());
+
+  std::ifstream problem_ifs(pkgpath + "/pddl/problem_simple_1.pddl");
+  std::string problem_str((
+      std::istreambuf_iterator<char>(problem_ifs)),
+    std::istreambuf_iterator<char>());
+
+  auto node = rclcpp_lifecycle::LifecycleNode::make_shared("test_node");
+  auto planner = std::make_shared<plansys2::POPFDirectPlanSolver>();
+  planner->configure(node, "POPF");
+
+  auto plan_1 = planner->getPlanAsync(domain_str, problem_str);
+  auto plan_2 = planner->getPlanAsync(domain_str, problem_str);
+
+  for (auto plan : {plan_1.get(), plan_2.get()}) {
+    ASSERT_TRUE(plan);
+    ASSERT_EQ(plan.value().items.size(), 3);
+    ASSERT_EQ(plan.value().items[0].action, "(move leia kitchen bedroom)");
+    ASSERT_EQ(plan.value().items[1].action, "(approach leia bedroom jack)");
+    ASSERT_EQ(plan.value().items[2].action, "(talk leia jack jack m1)");
+  }
+
+  ASSERT_TRUE(planner->check_domain(domain_str).empty());
+}
+
+TEST(popf_plan_solver, direct_cancel)
+{
+  std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_popf_plan_solver");
+  std::ifstream domain_ifs(pkgpath + "/pddl/domain_simple.pddl");
+  std::string domain_str((
+      std::istreambuf_iterator<char>(domain_ifs)),
+    std::istreambuf_iterator<char>());
+
+  std::ifstream problem_ifs(pkgpath + "/pddl/problem_simple_1.pddl");
+  std::string problem_str((
+      std::istreambuf_iterator<char>(problem_ifs)),
+    std::istreambuf_iterator<char>());
+
+  auto node = rclcpp_lifecycle::LifecycleNode::make_shared("test_node");
+  auto planner = std::make_shared<plansys2::POPFDirectPlanSolver>();
+  planner->configure(node, "POPF");
+
+  auto plan = planner->getPlanAsync(domain_str, problem_str);
+  planner->cancel();
+  ASSERT_FALSE(plan.get());
+
+  ASSERT_TRUE(planner->getPlan(domain_str, problem_str));
+}
+
+TEST(popf_plan_solver, load_popf_direct_plugin)
+{
+  try {
+    pluginlib::ClassLoader<plansys2::PlanSolverBase> lp_loader(
+      "plansys2_core", "plansys2::PlanSolverBase");
+    plansys2::PlanSolverBase::Ptr plugin =
+      lp_loader.createUniqueInstance("plansys2/POPFDirectPlanSolver");
+    ASSERT_TRUE(true);
+  } catch (std::exception & e) {
+    std::cerr << e.what() << std::endl;
+    ASSERT_TRUE(false);
+  }
+}
+
 /*
 TEST(popf_plan_solver, generate_plan_unsolvable)
 {
@@ -26,6 +26,7 @@
 
 #include "plansys2_pddl_parser/Utils.h"
 #include "plansys2_problem_expert/ProblemExpertInterface.hpp"
+#include "plansys2_problem_expert/Utils.hpp"
 #include "plansys2_domain_expert/DomainExpert.hpp"
 
 namespace plansys2
@@ -54,6 +55,17 @@ public:
   bool updateFunction(const plansys2::Function & function);
   std::optional<plansys2::Function> getFunction(const std::string & expr);
 
+  /// Apply a set of state changes atomically.
+  /**
+   * Removals are applied before additions, so a predicate present in both lists
+   * ends up in the state, as in PDDL effect semantics. Functions are added or
+   * updated. If any element is not valid, nothing is changed.
+   */
+  bool updateState(
+    const std::vector<plansys2::Predicate> & remove_predicates,
+    const std::vector<plansys2::Predicate> & add_predicates,
+    const std::vector<plansys2::Function> & update_functions);
+
   plansys2::Goal getGoal();
   bool setGoal(const plansys2::Goal & goal);
   bool isGoalSatisfied(const plansys2::Goal & goal);
@@ -84,6 +96,11 @@ private:
   std::vector<plansys2::Function> functions_;
   plansys2::Goal goal_;
 
+  // Indexed copy of predicates_ and functions_, to check goals without searching them
+  FactIndex fact_index_;
+  FactState fact_state_;
+  CompiledExpression goal_expression_;
+
   std::shared_ptr<DomainExpert> domain_expert_;
 };
 
@@ -24,6 +24,7 @@
 
 #include "plansys2_msgs/msg/node.hpp"
 #include "plansys2_msgs/msg/param.hpp"
+#include "plansys2_msgs/msg/state_delta.hpp"
 #include "plansys2_msgs/msg/tree.hpp"
 #include "plansys2_msgs/srv/add_problem.hpp"
 #include "plansys2_msgs/srv/add_problem_goal.hpp"
@@ -36,9 +37,11 @@
 #include "plansys2_msgs/srv/get_problem_instances.hpp"
 #include "plansys2_msgs/srv/get_node_details.hpp"
 #include "plansys2_msgs/srv/get_states.hpp"
+#include "plansys2_msgs/srv/get_state_snapshot.hpp"
 #include "plansys2_msgs/srv/is_problem_goal_satisfied.hpp"
 #include "plansys2_msgs/srv/remove_problem_goal.hpp"
 #include "plansys2_msgs/srv/clear_problem_knowledge.hpp"
+#include "plansys2_msgs/srv/update_state.hpp"
 
 #include "rclcpp/rclcpp.hpp"
 
@@ -68,6 +71,22 @@ public:
   bool updateFunction(const plansys2::Function & function);
   std::optional<plansys2::Function> getFunction(const std::string & function);
 
+  /// Apply a set of state changes in a single, atomic request.
+  bool updateState(
+    const std::vector<plansys2::Predicate> & remove_predicates,
+    const std::vector<plansys2::Predicate> & add_predicates,
+    const std::vector<plansys2::Function> & update_functions);
+
+  /// Keep a local copy of predicates and functions.
+  /**
+   * When enabled, getPredicates() and getFunctions() are served from a local
+   * mirror kept up to date from the problem_expert/state_delta topic. A full
+   * snapshot is only requested when the mirror is first used, after a gap in
+   * the delta versions, or after this client changes the state with a
+   * non-batched call.
+   */
+  void enableStateMirror(bool enable = true);
+
   plansys2::Goal getGoal();
   bool setGoal(const plansys2::Goal & goal);
   bool isGoalSatisfied(const plansys2::Goal & goal);
@@ -79,6 +98,11 @@ public:
   bool addProblem(const std::string & problem_str);
 
 private:
+  void state_delta_callback(const plansys2_msgs::msg::StateDelta::SharedPtr msg);
+  void applyDelta(const plansys2_msgs::msg::StateDelta & delta);
+  bool syncStateMirror();
+  void invalidateStateMirror() {mirror_valid_ = false;}
+
   rclcpp::Client<plansys2_msgs::srv::AddProblem>::SharedPtr
     add_problem_client_;
   rclcpp::Client<plansys2_msgs::srv::AddProblemGoal>::SharedPtr
@@ -123,7 +147,19 @@ private:
     update_problem_function_client_;
   rclcpp::Client<plansys2_msgs::srv::IsProblemGoalSatisfied>::SharedPtr
     is_problem_goal_satisfied_client_;
+  rclcpp::Client<plansys2_msgs::srv::UpdateState>::SharedPtr
+    update_problem_state_client_;
+  rclcpp::Client<plansys2_msgs::srv::GetStateSnapshot>::SharedPtr
+    get_problem_state_snapshot_client_;
+  rclcpp::Subscription<plansys2_msgs::msg::StateDelta>::SharedPtr
+    state_delta_sub_;
   rclcpp::Node::SharedPtr node_;
+
+  bool use_state_mirror_;
+  bool mirror_valid_;
+  uint64_t mirror_version_;
+  std::vector<plansys2::Predicate> mirror_predicates_;
+  std::vector<plansys2::Function> mirror_functions_;
 };
 
 }  // namespace plansys2
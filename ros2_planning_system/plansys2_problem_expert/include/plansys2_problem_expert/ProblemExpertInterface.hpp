@@ -50,6 +50,11 @@ public:
   virtual bool updateFunction(const plansys2::Function & function) = 0;
   virtual std::optional<plansys2::Function> getFunction(const std::string & expr) = 0;
 
+  virtual bool updateState(
+    const std::vector<plansys2::Predicate> & remove_predicates,
+    const std::vector<plansys2::Predicate> & add_predicates,
+    const std::vector<plansys2::Function> & update_functions) = 0;
+
   virtual plansys2::Goal getGoal() = 0;
   virtual bool setGoal(const plansys2::Goal & goal) = 0;
   virtual bool isGoalSatisfied(const plansys2::Goal & goal) = 0;
@@ -24,6 +24,7 @@
 #include "lifecycle_msgs/msg/state.hpp"
 #include "lifecycle_msgs/msg/transition.hpp"
 #include "plansys2_msgs/msg/knowledge.hpp"
+#include "plansys2_msgs/msg/state_delta.hpp"
 #include "plansys2_msgs/srv/affect_node.hpp"
 #include "plansys2_msgs/srv/affect_param.hpp"
 #include "plansys2_msgs/srv/add_problem.hpp"
@@ -35,9 +36,11 @@
 #include "plansys2_msgs/srv/get_problem_instances.hpp"
 #include "plansys2_msgs/srv/get_node_details.hpp"
 #include "plansys2_msgs/srv/get_states.hpp"
+#include "plansys2_msgs/srv/get_state_snapshot.hpp"
 #include "plansys2_msgs/srv/is_problem_goal_satisfied.hpp"
 #include "plansys2_msgs/srv/remove_problem_goal.hpp"
 #include "plansys2_msgs/srv/clear_problem_knowledge.hpp"
+#include "plansys2_msgs/srv/update_state.hpp"
 
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
@@ -172,7 +175,20 @@ public:
     const std::shared_ptr<plansys2_msgs::srv::AffectNode::Request> request,
     const std::shared_ptr<plansys2_msgs::srv::AffectNode::Response> response);
 
+  void update_problem_state_service_callback(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<plansys2_msgs::srv::UpdateState::Request> request,
+    const std::shared_ptr<plansys2_msgs::srv::UpdateState::Response> response);
+
+  void get_problem_state_snapshot_service_callback(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<plansys2_msgs::srv::GetStateSnapshot::Request> request,
+    const std::shared_ptr<plansys2_msgs::srv::GetStateSnapshot::Response> response);
+
 private:
+  void publish_state_delta(plansys2_msgs::msg::StateDelta & delta);
+  void publish_state_reset();
+
   std::shared_ptr<ProblemExpert> problem_expert_;
 
   rclcpp::Service<plansys2_msgs::srv::AddProblem>::SharedPtr
@@ -219,9 +235,17 @@ private:
     exist_problem_function_service_;
   rclcpp::Service<plansys2_msgs::srv::AffectNode>::SharedPtr
     update_problem_function_service_;
+  rclcpp::Service<plansys2_msgs::srv::UpdateState>::SharedPtr
+    update_problem_state_service_;
+  rclcpp::Service<plansys2_msgs::srv::GetStateSnapshot>::SharedPtr
+    get_problem_state_snapshot_service_;
 
   rclcpp_lifecycle::LifecyclePublisher<std_msgs::msg::Empty>::SharedPtr update_pub_;
   rclcpp_lifecycle::LifecyclePublisher<plansys2_msgs::msg::Knowledge>::SharedPtr knowledge_pub_;
+  rclcpp_lifecycle::LifecyclePublisher<plansys2_msgs::msg::StateDelta>::SharedPtr
+    state_delta_pub_;
+
+  uint64_t state_version_;
 };
 
 }  // namespace plansys2
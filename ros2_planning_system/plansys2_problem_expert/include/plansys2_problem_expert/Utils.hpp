@@ -21,6 +21,7 @@
 #include <map>
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <utility>
 
 #include "plansys2_problem_expert/ProblemExpertClient.hpp"
@@ -86,13 +87,146 @@ bool check(
   std::vector<plansys2::Function> & functions,
   uint32_t node_id = 0);
 
+/// Dense ids for the predicates and functions of a state.
+/**
+ * Two nodes get the same id when checkNodeEquality would consider them equal,
+ * so ids can be used instead of searching the state vectors.
+ */
+class FactIndex
+{
+public:
+  /// Get the id of a predicate or function, adding it if it is new.
+  uint32_t getId(const plansys2_msgs::msg::Node & node);
+
+  /// Get the id of a predicate or function, or -1 if it has no id yet.
+  int findId(const plansys2_msgs::msg::Node & node) const;
+
+  size_t size() const {return ids_.size();}
+
+private:
+  static std::string getKey(const plansys2_msgs::msg::Node & node);
+
+  std::unordered_map<std::string, uint32_t> ids_;
+};
+
+/// A state indexed by FactIndex ids.
+/**
+ * For predicates, present means that the predicate holds. For functions, it
+ * means that the function is defined, and values holds its value.
+ */
+struct FactState
+{
+  std::vector<bool> present;
+  std::vector<double> values;
+
+  void set(uint32_t id, bool is_present, double value = 0.0);
+  void clear();
+
+  bool isPresent(uint32_t id) const {return id < present.size() && present[id];}
+  double getValue(uint32_t id) const {return id < values.size() ? values[id] : 0.0;}
+
+  /// Fill the state from predicate and function vectors.
+  void build(
+    FactIndex & index,
+    const std::vector<plansys2::Predicate> & predicates,
+    const std::vector<plansys2::Function> & functions);
+};
+
+/// A PDDL expression compiled to a flat program over fact ids.
+/**
+ * The tree is compiled once into a postfix program whose leaves refer to
+ * FactIndex ids. Evaluating it against a FactState gives the same result as
+ * evaluate() without apply, in a single pass over the program and without
+ * searching the state or allocating memory.
+ */
+class CompiledExpression
+{
+public:
+  CompiledExpression();
+
+  /**
+   * \param[in] tree The PDDL expression.
+   * \param[in,out] index Fact ids. Facts not seen before are added to it.
+   * \param[in] node_id The root node of the expression.
+   */
+  CompiledExpression(
+    const plansys2_msgs::msg::Tree & tree,
+    FactIndex & index,
+    uint32_t node_id = 0);
+
+  /// Evaluate the expression. Returns the same tuple as evaluate().
+  std::tuple<bool, bool, double> evaluate(const FactState & state) const;
+
+  /// Truth value of the expression.
+  bool check(const FactState & state) const {return std::get<1>(evaluate(state));}
+
+  bool empty() const {return program_.empty();}
+
+private:
+  enum Opcode : uint8_t
+  {
+    PREDICATE,
+    FUNCTION,
+    NUMBER,
+    AND,
+    OR,
+    EXPRESSION,
+    FUNCTION_MODIFIER,
+    INVALID
+  };
+
+  struct Instruction
+  {
+    Opcode opcode;
+    uint8_t type;  // expression_type or modifier_type
+    bool negate;
+    uint32_t arg;  // fact id or number of children
+    double value;
+  };
+
+  struct Value
+  {
+    bool success;
+    bool truth;
+    double value;
+  };
+
+  void compile(
+    const plansys2_msgs::msg::Tree & tree, FactIndex & index,
+    uint32_t node_id, bool negate);
+
+  std::vector<Instruction> program_;
+  size_t stack_size_;
+};
+
+/// Collect the state changes produced by a PDDL effect represented as a tree.
+/**
+ * \param[in] tree The PDDL effect expression.
+ * \param[in,out] functions Current functions state. Function modifiers are applied to it.
+ * \param[out] remove_predicates Predicates deleted by the effect.
+ * \param[out] add_predicates Predicates added by the effect.
+ * \param[out] update_functions Functions whose value is modified by the effect.
+ * \param[in] node_id The root node of the PDDL expression.
+ * \param[in] negate Invert the truth value.
+ * \return success Indicates whether all the changes could be computed.
+ */
+bool get_effects(
+  const plansys2_msgs::msg::Tree & tree,
+  std::vector<plansys2::Function> & functions,
+  std::vector<plansys2::Predicate> & remove_predicates,
+  std::vector<plansys2::Predicate> & add_predicates,
+  std::vector<plansys2::Function> & update_functions,
+  uint32_t node_id = 0,
+  bool negate = false);
+
 /// Apply a PDDL expression represented as a tree.
 /**
  * \param[in] node The root node of the PDDL expression.
  * \param[in] problem_client The problem expert client.
  * \return success Indicates whether the execution was successful.
  *
- * This function calls the evaluate function.
+ * When using the problem client, all the changes are sent in a single
+ * atomic request. Otherwise, this function calls the evaluate function.
  */
 bool apply(
   const plansys2_msgs::msg::Tree & tree,
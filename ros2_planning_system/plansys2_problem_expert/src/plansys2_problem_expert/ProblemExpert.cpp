@@ -112,6 +112,7 @@ ProblemExpert::addPredicate(const plansys2::Predicate & predicate)
   if (!existPredicate(predicate)) {
     if (isValidPredicate(predicate)) {
       predicates_.push_back(predicate);
+      fact_state_.set(fact_index_.getId(predicate), true);
       return true;
     } else {
       return false;
@@ -134,6 +135,7 @@ ProblemExpert::removePredicate(const plansys2::Predicate & predicate)
     if (parser::pddl::checkNodeEquality(predicates_[i], predicate)) {
       found = true;
       predicates_.erase(predicates_.begin() + i);
+      fact_state_.set(fact_index_.getId(predicate), false);
     }
     i++;
   }
@@ -176,6 +178,7 @@ ProblemExpert::addFunction(const plansys2::Function & function)
   if (!existFunction(function)) {
     if (isValidFunction(function)) {
       functions_.push_back(function);
+      fact_state_.set(fact_index_.getId(function), true, function.value);
       return true;
     } else {
       return false;
@@ -198,6 +201,7 @@ ProblemExpert::removeFunction(const plansys2::Function & function)
     if (parser::pddl::checkNodeEquality(functions_[i], function)) {
       found = true;
       functions_.erase(functions_.begin() + i);
+      fact_state_.set(fact_index_.getId(function), false);
     }
     i++;
   }
@@ -212,6 +216,7 @@ ProblemExpert::updateFunction(const plansys2::Function & function)
     if (isValidFunction(function)) {
       removeFunction(function);
       functions_.push_back(function);
+      fact_state_.set(fact_index_.getId(function), true, function.value);
       return true;
     } else {
       return false;
@@ -244,6 +249,41 @@ ProblemExpert::getFunction(const std::string & expr)
   }
 }
 
+bool
+ProblemExpert::updateState(
+  const std::vector<plansys2::Predicate> & remove_predicates,
+  const std::vector<plansys2::Predicate> & add_predicates,
+  const std::vector<plansys2::Function> & update_functions)
+{
+  for (const auto & predicate : remove_predicates) {
+    if (!isValidPredicate(predicate)) {
+      return false;
+    }
+  }
+  for (const auto & predicate : add_predicates) {
+    if (!isValidPredicate(predicate)) {
+      return false;
+    }
+  }
+  for (const auto & function : update_functions) {
+    if (!isValidFunction(function)) {
+      return false;
+    }
+  }
+
+  for (const auto & predicate : remove_predicates) {
+    removePredicate(predicate);
+  }
+  for (const auto & predicate : add_predicates) {
+    addPredicate(predicate);
+  }
+  for (const auto & function : update_functions) {
+    addFunction(function);
+  }
+
+  return true;
+}
+
 bool
 ProblemExpert::removeFunctionsReferencing(const plansys2_msgs::msg::Param & param)
 {
@@ -253,6 +293,7 @@ ProblemExpert::removeFunctionsReferencing(const plansys2_msgs::msg::Param & para
     bool found = false;
     for (plansys2::Instance parameter : functions_[i].parameters) {
       if (parameter.name == param.name) {
+        fact_state_.set(fact_index_.getId(functions_[i]), false);
         functions_.erase(functions_.begin() + i);
         found = true;
         break;
@@ -274,6 +315,7 @@ ProblemExpert::removePredicatesReferencing(const plansys2_msgs::msg::Param & par
     bool found = false;
     for (plansys2::Instance parameter : predicates_[i].parameters) {
       if (parameter.name == param.name) {
+        fact_state_.set(fact_index_.getId(predicates_[i]), false);
         predicates_.erase(predicates_.begin() + i);
         found = true;
         break;
@@ -297,6 +339,7 @@ ProblemExpert::setGoal(const plansys2::Goal & goal)
 {
   if (isValidGoal(goal)) {
     goal_ = goal;
+    goal_expression_ = CompiledExpression(goal_, fact_index_);
     return true;
   } else {
     return false;
@@ -305,13 +348,17 @@ ProblemExpert::setGoal(const plansys2::Goal & goal)
 
 bool ProblemExpert::isGoalSatisfied(const plansys2::Goal & goal)
 {
-  return check(goal, predicates_, functions_);
+  if (goal == goal_) {
+    return goal_expression_.check(fact_state_);
+  }
+  return CompiledExpression(goal, fact_index_).check(fact_state_);
 }
 
 bool
 ProblemExpert::clearGoal()
 {
   goal_.nodes.clear();
+  goal_expression_ = CompiledExpression();
   return true;
 }
 
@@ -321,6 +368,7 @@ ProblemExpert::clearKnowledge()
   instances_.clear();
   predicates_.clear();
   functions_.clear();
+  fact_state_.clear();
   return true;
 }
 
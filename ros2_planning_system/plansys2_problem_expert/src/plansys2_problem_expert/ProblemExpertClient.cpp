@@ -26,6 +26,9 @@ namespace plansys2
 {
 
 ProblemExpertClient::ProblemExpertClient()
+: use_state_mirror_(false),
+  mirror_valid_(false),
+  mirror_version_(0)
 {
   node_ = rclcpp::Node::make_shared("problem_expert_client");
 
@@ -83,6 +86,12 @@ ProblemExpertClient::ProblemExpertClient()
   is_problem_goal_satisfied_client_ =
     node_->create_client<plansys2_msgs::srv::IsProblemGoalSatisfied>(
     "problem_expert/is_problem_goal_satisfied");
+  update_problem_state_client_ =
+    node_->create_client<plansys2_msgs::srv::UpdateState>(
+    "problem_expert/update_problem_state");
+  get_problem_state_snapshot_client_ =
+    node_->create_client<plansys2_msgs::srv::GetStateSnapshot>(
+    "problem_expert/get_problem_state_snapshot");
 }
 
 std::vector<plansys2::Instance>
@@ -181,6 +190,7 @@ ProblemExpertClient::removeInstance(const plansys2::Instance & instance)
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -231,6 +241,10 @@ ProblemExpertClient::getInstance(const std::string & name)
 std::vector<plansys2::Predicate>
 ProblemExpertClient::getPredicates()
 {
+  if (use_state_mirror_ && syncStateMirror()) {
+    return mirror_predicates_;
+  }
+
   while (!get_problem_predicates_client_->wait_for_service(std::chrono::seconds(5))) {
     if (!rclcpp::ok()) {
       return {};
@@ -288,6 +302,7 @@ ProblemExpertClient::addPredicate(const plansys2::Predicate & predicate)
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -323,6 +338,7 @@ ProblemExpertClient::removePredicate(const plansys2::Predicate & predicate)
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -399,6 +415,10 @@ ProblemExpertClient::getPredicate(const std::string & predicate)
 std::vector<plansys2::Function>
 ProblemExpertClient::getFunctions()
 {
+  if (use_state_mirror_ && syncStateMirror()) {
+    return mirror_functions_;
+  }
+
   while (!get_problem_functions_client_->wait_for_service(std::chrono::seconds(5))) {
     if (!rclcpp::ok()) {
       return {};
@@ -459,6 +479,7 @@ ProblemExpertClient::addFunction(const plansys2::Function & function)
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -494,6 +515,7 @@ ProblemExpertClient::removeFunction(const plansys2::Function & function)
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -555,6 +577,7 @@ bool ProblemExpertClient::updateFunction(const plansys2::Function & function)
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -601,6 +624,182 @@ ProblemExpertClient::getFunction(const std::string & function)
   }
 }
 
+bool
+ProblemExpertClient::updateState(
+  const std::vector<plansys2::Predicate> & remove_predicates,
+  const std::vector<plansys2::Predicate> & add_predicates,
+  const std::vector<plansys2::Function> & update_functions)
+{
+  while (!update_problem_state_client_->wait_for_service(std::chrono::seconds(5))) {
+    if (!rclcpp::ok()) {
+      return false;
+    }
+    RCLCPP_ERROR_STREAM(
+      node_->get_logger(),
+      update_problem_state_client_->get_service_name() <<
+        " service  client: waiting for service to appear...");
+  }
+
+  auto request = std::make_shared<plansys2_msgs::srv::UpdateState::Request>();
+  request->remove_predicates =
+    plansys2::convertVector<plansys2_msgs::msg::Node, plansys2::Predicate>(remove_predicates);
+  request->add_predicates =
+    plansys2::convertVector<plansys2_msgs::msg::Node, plansys2::Predicate>(add_predicates);
+  request->update_functions =
+    plansys2::convertVector<plansys2_msgs::msg::Node, plansys2::Function>(update_functions);
+
+  auto future_result = update_problem_state_client_->async_send_request(request);
+
+  if (rclcpp::spin_until_future_complete(node_, future_result, std::chrono::seconds(1)) !=
+    rclcpp::FutureReturnCode::SUCCESS)
+  {
+    return false;
+  }
+
+  if (future_result.get()->success) {
+    if (use_state_mirror_) {
+      // Our own change is the next version, unless other deltas are still in flight
+      rclcpp::spin_some(node_);
+
+      plansys2_msgs::msg::StateDelta delta;
+      delta.version = future_result.get()->version;
+      delta.removed_predicates = request->remove_predicates;
+      delta.added_predicates = request->add_predicates;
+      delta.updated_functions = request->update_functions;
+      applyDelta(delta);
+    }
+    return true;
+  } else {
+    RCLCPP_ERROR_STREAM(
+      node_->get_logger(),
+      update_problem_state_client_->get_service_name() << ": " <<
+        future_result.get()->error_info);
+    return false;
+  }
+}
+
+void
+ProblemExpertClient::enableStateMirror(bool enable)
+{
+  use_state_mirror_ = enable;
+  invalidateStateMirror();
+
+  if (enable && state_delta_sub_ == nullptr) {
+    state_delta_sub_ = node_->create_subscription<plansys2_msgs::msg::StateDelta>(
+      "problem_expert/state_delta",
+      rclcpp::QoS(100).reliable(),
+      std::bind(&ProblemExpertClient::state_delta_callback, this, std::placeholders::_1));
+  } else if (!enable) {
+    state_delta_sub_ = nullptr;
+    mirror_predicates_.clear();
+    mirror_functions_.clear();
+  }
+}
+
+void
+ProblemExpertClient::state_delta_callback(const plansys2_msgs::msg::StateDelta::SharedPtr msg)
+{
+  applyDelta(*msg);
+}
+
+void
+ProblemExpertClient::applyDelta(const plansys2_msgs::msg::StateDelta & delta)
+{
+  if (!mirror_valid_ || delta.version <= mirror_version_) {
+    return;
+  }
+
+  if (delta.reset || delta.version != mirror_version_ + 1) {
+    invalidateStateMirror();
+    return;
+  }
+
+  for (const auto & predicate : delta.removed_predicates) {
+    auto it = std::find_if(
+      mirror_predicates_.begin(), mirror_predicates_.end(),
+      std::bind(&parser::pddl::checkNodeEquality, std::placeholders::_1, predicate));
+    if (it != mirror_predicates_.end()) {
+      mirror_predicates_.erase(it);
+    }
+  }
+
+  for (const auto & predicate : delta.added_predicates) {
+    auto it = std::find_if(
+      mirror_predicates_.begin(), mirror_predicates_.end(),
+      std::bind(&parser::pddl::checkNodeEquality, std::placeholders::_1, predicate));
+    if (it == mirror_predicates_.end()) {
+      mirror_predicates_.push_back(predicate);
+    }
+  }
+
+  for (const auto & function : delta.removed_functions) {
+    auto it = std::find_if(
+      mirror_functions_.begin(), mirror_functions_.end(),
+      std::bind(&parser::pddl::checkNodeEquality, std::placeholders::_1, function));
+    if (it != mirror_functions_.end()) {
+      mirror_functions_.erase(it);
+    }
+  }
+
+  for (const auto & function : delta.updated_functions) {
+    auto it = std::find_if(
+      mirror_functions_.begin(), mirror_functions_.end(),
+      std::bind(&parser::pddl::checkNodeEquality, std::placeholders::_1, function));
+    if (it != mirror_functions_.end()) {
+      it->value = function.value;
+    } else {
+      mirror_functions_.push_back(function);
+    }
+  }
+
+  mirror_version_ = delta.version;
+}
+
+bool
+ProblemExpertClient::syncStateMirror()
+{
+  rclcpp::spin_some(node_);
+
+  if (mirror_valid_) {
+    return true;
+  }
+
+  while (!get_problem_state_snapshot_client_->wait_for_service(std::chrono::seconds(5))) {
+    if (!rclcpp::ok()) {
+      return false;
+    }
+    RCLCPP_ERROR_STREAM(
+      node_->get_logger(),
+      get_problem_state_snapshot_client_->get_service_name() <<
+        " service  client: waiting for service to appear...");
+  }
+
+  auto request = std::make_shared<plansys2_msgs::srv::GetStateSnapshot::Request>();
+
+  auto future_result = get_problem_state_snapshot_client_->async_send_request(request);
+
+  if (rclcpp::spin_until_future_complete(node_, future_result, std::chrono::seconds(1)) !=
+    rclcpp::FutureReturnCode::SUCCESS)
+  {
+    return false;
+  }
+
+  if (future_result.get()->success) {
+    mirror_predicates_ = plansys2::convertVector<plansys2::Predicate, plansys2_msgs::msg::Node>(
+      future_result.get()->predicates);
+    mirror_functions_ = plansys2::convertVector<plansys2::Function, plansys2_msgs::msg::Node>(
+      future_result.get()->functions);
+    mirror_version_ = future_result.get()->version;
+    mirror_valid_ = true;
+  } else {
+    RCLCPP_ERROR_STREAM(
+      node_->get_logger(),
+      get_problem_state_snapshot_client_->get_service_name() << ": " <<
+        future_result.get()->error_info);
+  }
+
+  return mirror_valid_;
+}
 
 plansys2::Goal
 ProblemExpertClient::getGoal()
@@ -767,6 +966,7 @@ ProblemExpertClient::clearKnowledge()
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -837,6 +1037,7 @@ ProblemExpertClient::addProblem(const std::string & problem_str)
   }
 
   if (future_result.get()->success) {
+    invalidateStateMirror();
     return true;
   } else {
     RCLCPP_ERROR_STREAM(
@@ -43,7 +43,8 @@ namespace plansys2
 {
 
 ProblemExpertNode::ProblemExpertNode()
-: rclcpp_lifecycle::LifecycleNode("problem_expert")
+: rclcpp_lifecycle::LifecycleNode("problem_expert"),
+  state_version_(0)
 {
   declare_parameter("model_file", "");
   declare_parameter("problem_file", "");
@@ -201,6 +202,20 @@ ProblemExpertNode::ProblemExpertNode()
       this, std::placeholders::_1, std::placeholders::_2,
       std::placeholders::_3));
 
+  update_problem_state_service_ = create_service<plansys2_msgs::srv::UpdateState>(
+    "problem_expert/update_problem_state",
+    std::bind(
+      &ProblemExpertNode::update_problem_state_service_callback,
+      this, std::placeholders::_1, std::placeholders::_2,
+      std::placeholders::_3));
+
+  get_problem_state_snapshot_service_ = create_service<plansys2_msgs::srv::GetStateSnapshot>(
+    "problem_expert/get_problem_state_snapshot",
+    std::bind(
+      &ProblemExpertNode::get_problem_state_snapshot_service_callback,
+      this, std::placeholders::_1, std::placeholders::_2,
+      std::placeholders::_3));
+
   update_pub_ = create_publisher<std_msgs::msg::Empty>(
     "problem_expert/update_notify",
     rclcpp::QoS(100));
@@ -208,6 +223,10 @@ ProblemExpertNode::ProblemExpertNode()
   knowledge_pub_ = create_publisher<plansys2_msgs::msg::Knowledge>(
     "problem_expert/knowledge",
     rclcpp::QoS(100).transient_local());
+
+  state_delta_pub_ = create_publisher<plansys2_msgs::msg::StateDelta>(
+    "problem_expert/state_delta",
+    rclcpp::QoS(100).reliable());
 }
 
 
@@ -261,6 +280,7 @@ ProblemExpertNode::on_activate(const rclcpp_lifecycle::State & state)
   RCLCPP_INFO(get_logger(), "[%s] Activating...", get_name());
   update_pub_->on_activate();
   knowledge_pub_->on_activate();
+  state_delta_pub_->on_activate();
   RCLCPP_INFO(get_logger(), "[%s] Activated", get_name());
   return CallbackReturnT::SUCCESS;
 }
@@ -271,6 +291,7 @@ ProblemExpertNode::on_deactivate(const rclcpp_lifecycle::State & state)
   RCLCPP_INFO(get_logger(), "[%s] Deactivating...", get_name());
   update_pub_->on_deactivate();
   knowledge_pub_->on_deactivate();
+  state_delta_pub_->on_deactivate();
   RCLCPP_INFO(get_logger(), "[%s] Deactivated", get_name());
 
   return CallbackReturnT::SUCCESS;
@@ -319,6 +340,7 @@ ProblemExpertNode::add_problem_service_callback(
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
       knowledge_pub_->publish(*get_knowledge_as_msg());
+      publish_state_reset();
     } else {
       response->error_info = "Problem not valid";
     }
@@ -387,6 +409,10 @@ ProblemExpertNode::add_problem_predicate_service_callback(
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
       knowledge_pub_->publish(*get_knowledge_as_msg());
+
+      plansys2_msgs::msg::StateDelta delta;
+      delta.added_predicates.push_back(request->node);
+      publish_state_delta(delta);
     } else {
       response->error_info =
         "Predicate [" + parser::pddl::toString(request->node) + "] not valid";
@@ -409,6 +435,10 @@ ProblemExpertNode::add_problem_function_service_callback(
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
       knowledge_pub_->publish(*get_knowledge_as_msg());
+
+      plansys2_msgs::msg::StateDelta delta;
+      delta.updated_functions.push_back(request->node);
+      publish_state_delta(delta);
     } else {
       response->error_info =
         "Function [" + parser::pddl::toString(request->node) + "] not valid";
@@ -619,6 +649,7 @@ ProblemExpertNode::clear_problem_knowledge_service_callback(
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
       knowledge_pub_->publish(*get_knowledge_as_msg());
+      publish_state_reset();
     } else {
       response->error_info = "Error clearing knowledge";
     }
@@ -641,6 +672,7 @@ ProblemExpertNode::remove_problem_instance_service_callback(
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
       knowledge_pub_->publish(*get_knowledge_as_msg());
+      publish_state_reset();
     } else {
       response->error_info = "Error removing instance";
     }
@@ -662,6 +694,10 @@ ProblemExpertNode::remove_problem_predicate_service_callback(
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
       knowledge_pub_->publish(*get_knowledge_as_msg());
+
+      plansys2_msgs::msg::StateDelta delta;
+      delta.removed_predicates.push_back(request->node);
+      publish_state_delta(delta);
     } else {
       response->error_info = "Error removing predicate";
     }
@@ -682,6 +718,10 @@ ProblemExpertNode::remove_problem_function_service_callback(
     response->success = problem_expert_->removeFunction(request->node);
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
+
+      plansys2_msgs::msg::StateDelta delta;
+      delta.removed_functions.push_back(request->node);
+      publish_state_delta(delta);
     } else {
       response->error_info = "Error removing function";
     }
@@ -730,12 +770,82 @@ ProblemExpertNode::update_problem_function_service_callback(
     response->success = problem_expert_->updateFunction(request->node);
     if (response->success) {
       update_pub_->publish(std_msgs::msg::Empty());
+
+      plansys2_msgs::msg::StateDelta delta;
+      delta.updated_functions.push_back(request->node);
+      publish_state_delta(delta);
     } else {
       response->error_info = "Function not valid";
     }
   }
 }
 
+void
+ProblemExpertNode::update_problem_state_service_callback(
+  const std::shared_ptr<rmw_request_id_t> request_header,
+  const std::shared_ptr<plansys2_msgs::srv::UpdateState::Request> request,
+  const std::shared_ptr<plansys2_msgs::srv::UpdateState::Response> response)
+{
+  if (problem_expert_ == nullptr) {
+    response->success = false;
+    response->error_info = "Requesting service in non-active state";
+    RCLCPP_WARN(get_logger(), "Requesting service in non-active state");
+  } else {
+    response->success = problem_expert_->updateState(
+      request->remove_predicates, request->add_predicates, request->update_functions);
+    if (response->success) {
+      update_pub_->publish(std_msgs::msg::Empty());
+      knowledge_pub_->publish(*get_knowledge_as_msg());
+
+      plansys2_msgs::msg::StateDelta delta;
+      delta.removed_predicates = request->remove_predicates;
+      delta.added_predicates = request->add_predicates;
+      delta.updated_functions = request->update_functions;
+      publish_state_delta(delta);
+    } else {
+      response->error_info = "State update not valid";
+    }
+    response->version = state_version_;
+  }
+}
+
+void
+ProblemExpertNode::get_problem_state_snapshot_service_callback(
+  const std::shared_ptr<rmw_request_id_t> request_header,
+  const std::shared_ptr<plansys2_msgs::srv::GetStateSnapshot::Request> request,
+  const std::shared_ptr<plansys2_msgs::srv::GetStateSnapshot::Response> response)
+{
+  if (problem_expert_ == nullptr) {
+    response->success = false;
+    response->error_info = "Requesting service in non-active state";
+    RCLCPP_WARN(get_logger(), "Requesting service in non-active state");
+  } else {
+    response->success = true;
+    response->version = state_version_;
+    response->predicates =
+      plansys2::convertVector<plansys2_msgs::msg::Node, plansys2::Predicate>(
+      problem_expert_->getPredicates());
+    response->functions =
+      plansys2::convertVector<plansys2_msgs::msg::Node, plansys2::Function>(
+      problem_expert_->getFunctions());
+  }
+}
+
+void
+ProblemExpertNode::publish_state_delta(plansys2_msgs::msg::StateDelta & delta)
+{
+  delta.version = ++state_version_;
+  state_delta_pub_->publish(delta);
+}
+
+void
+ProblemExpertNode::publish_state_reset()
+{
+  plansys2_msgs::msg::StateDelta delta;
+  delta.reset = true;
+  publish_state_delta(delta);
+}
+
 plansys2_msgs::msg::Knowledge::SharedPtr
 ProblemExpertNode::get_knowledge_as_msg() const
 {
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <tuple>
+#include <unordered_map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -345,14 +347,394 @@ bool check(
   return std::get<1>(ret);
 }
 
+std::string
+FactIndex::getKey(const plansys2_msgs::msg::Node & node)
+{
+  std::string key = std::to_string(node.node_type) + " " + node.name;
+  for (const auto & param : node.parameters) {
+    key += " " + param.name;
+  }
+  return key;
+}
+
+uint32_t
+FactIndex::getId(const plansys2_msgs::msg::Node & node)
+{
+  return ids_.emplace(getKey(node), ids_.size()).first->second;
+}
+
+int
+FactIndex::findId(const plansys2_msgs::msg::Node & node) const
+{
+  auto it = ids_.find(getKey(node));
+  if (it == ids_.end()) {
+    return -1;
+  }
+  return it->second;
+}
+
+void
+FactState::set(uint32_t id, bool is_present, double value)
+{
+  if (id >= present.size()) {
+    present.resize(id + 1, false);
+    values.resize(id + 1, 0.0);
+  }
+  present[id] = is_present;
+  values[id] = value;
+}
+
+void
+FactState::clear()
+{
+  present.assign(present.size(), false);
+  values.assign(values.size(), 0.0);
+}
+
+void
+FactState::build(
+  FactIndex & index,
+  const std::vector<plansys2::Predicate> & predicates,
+  const std::vector<plansys2::Function> & functions)
+{
+  clear();
+  for (const auto & predicate : predicates) {
+    set(index.getId(predicate), true);
+  }
+  for (const auto & function : functions) {
+    set(index.getId(function), true, function.value);
+  }
+}
+
+CompiledExpression::CompiledExpression()
+: stack_size_(0)
+{
+}
+
+CompiledExpression::CompiledExpression(
+  const plansys2_msgs::msg::Tree & tree,
+  FactIndex & index,
+  uint32_t node_id)
+: stack_size_(0)
+{
+  if (tree.nodes.empty()) {  // No expression
+    return;
+  }
+
+  compile(tree, index, node_id, false);
+
+  size_t depth = 0;
+  for (const auto & instruction : program_) {
+    switch (instruction.opcode) {
+      case AND:
+      case OR:
+        depth = depth - instruction.arg + 1;
+        break;
+      case EXPRESSION:
+      case FUNCTION_MODIFIER:
+        depth--;
+        break;
+      default:
+        depth++;
+        break;
+    }
+    stack_size_ = std::max(stack_size_, depth);
+  }
+}
+
+void
+CompiledExpression::compile(
+  const plansys2_msgs::msg::Tree & tree, FactIndex & index,
+  uint32_t node_id, bool negate)
+{
+  const auto & node = tree.nodes[node_id];
+
+  switch (node.node_type) {
+    case plansys2_msgs::msg::Node::AND:
+    case plansys2_msgs::msg::Node::OR:
+      for (auto child_id : node.children) {
+        compile(tree, index, child_id, negate);
+      }
+      program_.push_back(
+        {node.node_type == plansys2_msgs::msg::Node::AND ? AND : OR, 0, false,
+          static_cast<uint32_t>(node.children.size()), 0.0});
+      break;
+
+    case plansys2_msgs::msg::Node::NOT:
+      compile(tree, index, node.children[0], !negate);
+      break;
+
+    case plansys2_msgs::msg::Node::PREDICATE:
+      program_.push_back({PREDICATE, 0, negate, index.getId(node), 0.0});
+      break;
+
+    case plansys2_msgs::msg::Node::FUNCTION:
+      program_.push_back({FUNCTION, 0, false, index.getId(node), 0.0});
+      break;
+
+    case plansys2_msgs::msg::Node::EXPRESSION:
+      compile(tree, index, node.children[0], negate);
+      compile(tree, index, node.children[1], negate);
+      program_.push_back({EXPRESSION, node.expression_type, false, 0, 0.0});
+      break;
+
+    case plansys2_msgs::msg::Node::FUNCTION_MODIFIER:
+      compile(tree, index, node.children[0], negate);
+      compile(tree, index, node.children[1], negate);
+      program_.push_back({FUNCTION_MODIFIER, node.modifier_type, false, 0, 0.0});
+      break;
+
+    case plansys2_msgs::msg::Node::NUMBER:
+      program_.push_back({NUMBER, 0, false, 0, node.value});
+      break;
+
+    default:
+      std::cerr << "evaluate: Error parsing expresion [" <<
+        parser::pddl::toString(tree, node_id) << "]" << std::endl;
+      program_.push_back({INVALID, 0, false, 0, 0.0});
+      break;
+  }
+}
+
+std::tuple<bool, bool, double>
+CompiledExpression::evaluate(const FactState & state) const
+{
+  if (program_.empty()) {  // No expression
+    return std::make_tuple(true, true, 0);
+  }
+
+  // Expressions deeper than this are rare enough to pay for an allocation
+  constexpr size_t kLocalStackSize = 32;
+  Value local_stack[kLocalStackSize];
+  std::vector<Value> heap_stack;
+  Value * stack = local_stack;
+  if (stack_size_ > kLocalStackSize) {
+    heap_stack.resize(stack_size_);
+    stack = heap_stack.data();
+  }
+
+  size_t top = 0;
+  for (const auto & instruction : program_) {
+    switch (instruction.opcode) {
+      case PREDICATE:
+        stack[top++] = {true, instruction.negate ^ state.isPresent(instruction.arg), 0.0};
+        break;
+
+      case FUNCTION: {
+          bool defined = state.isPresent(instruction.arg);
+          stack[top++] = {defined, false, defined ? state.getValue(instruction.arg) : 0.0};
+          break;
+        }
+
+      case NUMBER:
+        stack[top++] = {true, true, instruction.value};
+        break;
+
+      case AND:
+      case OR: {
+          Value result {true, instruction.opcode == AND, 0.0};
+          for (size_t i = top - instruction.arg; i < top; i++) {
+            result.success = result.success && stack[i].success;
+            if (instruction.opcode == AND) {
+              result.truth = result.truth && stack[i].truth;
+            } else {
+              result.truth = result.truth || stack[i].truth;
+            }
+          }
+          top -= instruction.arg;
+          stack[top++] = result;
+          break;
+        }
+
+      case EXPRESSION: {
+          const Value right = stack[--top];
+          const Value left = stack[--top];
+          Value result {false, false, 0.0};
+
+          if (left.success && right.success) {
+            result.success = true;
+            switch (instruction.type) {
+              case plansys2_msgs::msg::Node::COMP_GE:
+                result.truth = left.value >= right.value;
+                break;
+              case plansys2_msgs::msg::Node::COMP_GT:
+                result.truth = left.value > right.value;
+                break;
+              case plansys2_msgs::msg::Node::COMP_LE:
+                result.truth = left.value <= right.value;
+                break;
+              case plansys2_msgs::msg::Node::COMP_LT:
+                result.truth = left.value < right.value;
+                break;
+              case plansys2_msgs::msg::Node::ARITH_MULT:
+                result.value = left.value * right.value;
+                break;
+              case plansys2_msgs::msg::Node::ARITH_DIV:
+                // Division by zero not allowed.
+                if (std::abs(right.value) > 1e-5) {
+                  result.value = left.value / right.value;
+                } else {
+                  result.success = false;
+                }
+                break;
+              case plansys2_msgs::msg::Node::ARITH_ADD:
+                result.value = left.value + right.value;
+                break;
+              case plansys2_msgs::msg::Node::ARITH_SUB:
+                result.value = left.value - right.value;
+                break;
+              default:
+                result.success = false;
+                break;
+            }
+          }
+          stack[top++] = result;
+          break;
+        }
+
+      case FUNCTION_MODIFIER: {
+          const Value right = stack[--top];
+          const Value left = stack[--top];
+          Value result {false, false, 0.0};
+
+          if (left.success && right.success) {
+            result.success = true;
+            switch (instruction.type) {
+              case plansys2_msgs::msg::Node::ASSIGN:
+                result.value = right.value;
+                break;
+              case plansys2_msgs::msg::Node::INCREASE:
+                result.value = left.value + right.value;
+                break;
+              case plansys2_msgs::msg::Node::DECREASE:
+                result.value = left.value - right.value;
+                break;
+              case plansys2_msgs::msg::Node::SCALE_UP:
+                result.value = left.value * right.value;
+                break;
+              case plansys2_msgs::msg::Node::SCALE_DOWN:
+                // Division by zero not allowed.
+                if (std::abs(right.value) > 1e-5) {
+                  result.value = left.value / right.value;
+                } else {
+                  result.success = false;
+                }
+                break;
+              default:
+                result.success = false;
+                break;
+            }
+          }
+          stack[top++] = result;
+          break;
+        }
+
+      default:
+        stack[top++] = {false, false, 0.0};
+        break;
+    }
+  }
+
+  return std::make_tuple(stack[0].success, stack[0].truth, stack[0].value);
+}
+
+bool get_effects(
+  const plansys2_msgs::msg::Tree & tree,
+  std::vector<plansys2::Function> & functions,
+  std::vector<plansys2::Predicate> & remove_predicates,
+  std::vector<plansys2::Predicate> & add_predicates,
+  std::vector<plansys2::Function> & update_functions,
+  uint32_t node_id,
+  bool negate)
+{
+  if (tree.nodes.empty()) {  // No expression
+    return true;
+  }
+
+  switch (tree.nodes[node_id].node_type) {
+    case plansys2_msgs::msg::Node::AND: {
+        bool success = true;
+        for (auto & child_id : tree.nodes[node_id].children) {
+          success = get_effects(
+            tree, functions, remove_predicates, add_predicates, update_functions,
+            child_id, negate) && success;
+        }
+        return success;
+      }
+
+    case plansys2_msgs::msg::Node::NOT: {
+        return get_effects(
+          tree, functions, remove_predicates, add_predicates, update_functions,
+          tree.nodes[node_id].children[0], !negate);
+      }
+
+    case plansys2_msgs::msg::Node::PREDICATE: {
+        if (negate) {
+          remove_predicates.push_back(tree.nodes[node_id]);
+        } else {
+          add_predicates.push_back(tree.nodes[node_id]);
+        }
+        return true;
+      }
+
+    case plansys2_msgs::msg::Node::FUNCTION_MODIFIER: {
+        // Modify the local copy of the functions, and keep the result to send it
+        std::vector<plansys2::Predicate> predicates;
+        std::tuple<bool, bool, double> ret = evaluate(
+          tree, predicates, functions, true, node_id);
+        if (!std::get<0>(ret)) {
+          return false;
+        }
+
+        plansys2::Function function = tree.nodes[tree.nodes[node_id].children[0]];
+        function.value = std::get<2>(ret);
+
+        auto it = std::find_if(
+          update_functions.begin(), update_functions.end(),
+          std::bind(&parser::pddl::checkNodeEquality, std::placeholders::_1, function));
+        if (it != update_functions.end()) {
+          it->value = function.value;
+        } else {
+          update_functions.push_back(function);
+        }
+        return true;
+      }
+
+    default:
+      // Other expressions have no effects on the state
+      return true;
+  }
+}
+
 bool apply(
   const plansys2_msgs::msg::Tree & tree,
   std::shared_ptr<plansys2::ProblemExpertClient> problem_client,
   uint32_t node_id)
 {
-  std::tuple<bool, bool, double> ret = evaluate(tree, problem_client, true, node_id);
+  // Function modifiers need the current values. Predicates do not.
+  std::vector<plansys2::Function> functions;
+  auto is_modifier = [](const plansys2_msgs::msg::Node & node) {
+      return node.node_type == plansys2_msgs::msg::Node::FUNCTION_MODIFIER;
+    };
+  if (std::any_of(tree.nodes.begin(), tree.nodes.end(), is_modifier)) {
+    functions = problem_client->getFunctions();
+  }
 
-  return std::get<0>(ret);
+  std::vector<plansys2::Predicate> remove_predicates;
+  std::vector<plansys2::Predicate> add_predicates;
+  std::vector<plansys2::Function> update_functions;
+
+  if (!get_effects(
+      tree, functions, remove_predicates, add_predicates, update_functions, node_id, false))
+  {
+    return false;
+  }
+
+  if (remove_predicates.empty() && add_predicates.empty() && update_functions.empty()) {
+    return true;
+  }
+
+  return problem_client->updateState(remove_predicates, add_predicates, update_functions);
 }
 
 bool apply(
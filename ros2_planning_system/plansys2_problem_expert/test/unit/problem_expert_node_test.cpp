@@ -691,6 +691,80 @@ TEST(problem_expert_node, addget_goal_is_satisfied)
   t.join();
 }
 
+TEST(problem_expert_node, update_state_and_mirror)
+{
+  auto domain_node = std::make_shared<plansys2::DomainExpertNode>();
+  auto problem_node = std::make_shared<plansys2::ProblemExpertNode>();
+  auto problem_client = std::make_shared<plansys2::ProblemExpertClient>();
+  auto other_client = std::make_shared<plansys2::ProblemExpertClient>();
+
+  std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_problem_expert");
+
+  domain_node->set_parameter({"model_file", pkgpath + "/pddl/domain_simple.pddl"});
+  problem_node->set_parameter({"model_file", pkgpath + "/pddl/domain_simple.pddl"});
+
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+  problem_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+
+  domain_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_ACTIVATE);
+  problem_node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_ACTIVATE);
+
+  rclcpp::executors::MultiThreadedExecutor exe(rclcpp::executor::ExecutorArgs(), 8);
+
+  exe.add_node(domain_node->get_node_base_interface());
+  exe.add_node(problem_node->get_node_base_interface());
+
+  bool finish = false;
+  std::thread t([&]() {
+      while (!finish) {exe.spin_some();}
+    });
+
+  problem_client->enableStateMirror();
+
+  ASSERT_TRUE(problem_client->addInstance(plansys2::Instance("leia", "robot")));
+  ASSERT_TRUE(problem_client->addInstance(plansys2::Instance("bedroom", "room")));
+  ASSERT_TRUE(problem_client->addInstance(plansys2::Instance("kitchen", "room")));
+
+  ASSERT_TRUE(problem_client->addPredicate(plansys2::Predicate("(robot_at leia kitchen)")));
+  ASSERT_TRUE(
+    problem_client->addFunction(plansys2::Function("(= (room_distance kitchen bedroom) 1.0)")));
+  ASSERT_EQ(problem_client->getPredicates().size(), 1u);
+  ASSERT_EQ(problem_client->getFunctions().size(), 1u);
+
+  ASSERT_TRUE(
+    problem_client->updateState(
+      {plansys2::Predicate("(robot_at leia kitchen)")},
+      {plansys2::Predicate("(robot_at leia bedroom)")},
+      {plansys2::Function("(= (room_distance kitchen bedroom) 3.0)")}));
+
+  auto predicates = problem_client->getPredicates();
+  ASSERT_EQ(predicates.size(), 1u);
+  ASSERT_EQ(parser::pddl::toString(predicates[0]), "(robot_at leia bedroom)");
+  auto functions = problem_client->getFunctions();
+  ASSERT_EQ(functions.size(), 1u);
+  ASSERT_EQ(functions[0].value, 3.0);
+
+  ASSERT_FALSE(
+    problem_client->updateState(
+      {}, {plansys2::Predicate("(robot_at leia bathroom)")}, {}));
+  ASSERT_EQ(problem_client->getPredicates().size(), 1u);
+
+  // Changes from other clients arrive through the delta topic
+  ASSERT_TRUE(other_client->addPredicate(plansys2::Predicate("(robot_at leia kitchen)")));
+
+  auto start = std::chrono::steady_clock::now();
+  while (problem_client->getPredicates().size() != 2u &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(problem_client->getPredicates().size(), 2u);
+  ASSERT_EQ(problem_client->getPredicates(), other_client->getPredicates());
+
+  finish = true;
+  t.join();
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -672,6 +672,60 @@ TEST(problem_expert, is_goal_satisfied)
   ASSERT_TRUE(problem_expert.isGoalSatisfied(goal));
 }
 
+TEST(problem_expert, update_state)
+{
+  std::string pkgpath = ament_index_cpp::get_package_share_directory("plansys2_problem_expert");
+  std::ifstream domain_ifs(pkgpath + "/pddl/domain_simple.pddl");
+  std::string domain_str((
+      std::istreambuf_iterator<char>(domain_ifs)),
+    std::istreambuf_iterator<char>());
+
+  auto domain_expert = std::make_shared<plansys2::DomainExpert>(domain_str);
+  plansys2::ProblemExpert problem_expert(domain_expert);
+
+  ASSERT_TRUE(problem_expert.addInstance(parser::pddl::fromStringParam("leia", "robot")));
+  ASSERT_TRUE(problem_expert.addInstance(parser::pddl::fromStringParam("kitchen", "room")));
+  ASSERT_TRUE(problem_expert.addInstance(parser::pddl::fromStringParam("bedroom", "room")));
+
+  ASSERT_TRUE(
+    problem_expert.addPredicate(parser::pddl::fromStringPredicate("(robot_at leia kitchen)")));
+  ASSERT_TRUE(
+    problem_expert.addFunction(
+      parser::pddl::fromStringFunction("(= (room_distance kitchen bedroom) 1.0)")));
+
+  ASSERT_TRUE(
+    problem_expert.updateState(
+      {parser::pddl::fromStringPredicate("(robot_at leia kitchen)")},
+      {parser::pddl::fromStringPredicate("(robot_at leia bedroom)")},
+      {parser::pddl::fromStringFunction("(= (room_distance kitchen bedroom) 5.0)")}));
+
+  ASSERT_EQ(problem_expert.getPredicates().size(), 1u);
+  ASSERT_TRUE(
+    problem_expert.existPredicate(parser::pddl::fromStringPredicate("(robot_at leia bedroom)")));
+  auto function = problem_expert.getFunction("(room_distance kitchen bedroom)");
+  ASSERT_TRUE(function.has_value());
+  ASSERT_EQ(function.value().value, 5.0);
+
+  // A predicate both removed and added remains in the state
+  ASSERT_TRUE(
+    problem_expert.updateState(
+      {parser::pddl::fromStringPredicate("(robot_at leia bedroom)")},
+      {parser::pddl::fromStringPredicate("(robot_at leia bedroom)")},
+      {}));
+  ASSERT_TRUE(
+    problem_expert.existPredicate(parser::pddl::fromStringPredicate("(robot_at leia bedroom)")));
+
+  // One invalid element rejects the whole update
+  ASSERT_FALSE(
+    problem_expert.updateState(
+      {parser::pddl::fromStringPredicate("(robot_at leia bedroom)")},
+      {parser::pddl::fromStringPredicate("(robot_at leia bathroom)")},
+      {}));
+  ASSERT_EQ(problem_expert.getPredicates().size(), 1u);
+  ASSERT_TRUE(
+    problem_expert.existPredicate(parser::pddl::fromStringPredicate("(robot_at leia bedroom)")));
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
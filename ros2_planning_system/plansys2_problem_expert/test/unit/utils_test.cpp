@@ -847,6 +847,69 @@ TEST(utils, evaluate_invalid)
     std::make_tuple(false, false, 0));
 }
 
+TEST(utils, compiled_expression)
+{
+  std::vector<plansys2::Predicate> predicates;
+  std::vector<plansys2::Function> functions;
+  plansys2::FactIndex index;
+  plansys2::FactState state;
+
+  plansys2::CompiledExpression empty_expression(plansys2_msgs::msg::Tree(), index);
+  ASSERT_EQ(empty_expression.evaluate(state), std::make_tuple(true, true, 0));
+
+  std::vector<std::string> expressions = {
+    "(and (patrolled wp1) (not (patrolled wp2)))",
+    "(or (patrolled wp1) (patrolled wp2))",
+    "(and (>= (battery_level r2d2) 30.0) (patrolled wp1))",
+    "(and (< (* (battery_level r2d2) 2.0) (/ (distance wp1 wp2) 0.5)))",
+    "(and (> (distance wp1 wp2) (- (battery_level r2d2) 5.0)))",
+    "(and (> (distance wp1 wp2) (/ (battery_level r2d2) 0.0)))",
+  };
+  std::vector<plansys2_msgs::msg::Tree> trees;
+  std::vector<plansys2::CompiledExpression> compiled;
+  for (const auto & expression : expressions) {
+    plansys2_msgs::msg::Tree tree;
+    parser::pddl::fromString(tree, expression);
+    trees.push_back(tree);
+    compiled.push_back(plansys2::CompiledExpression(tree, index));
+  }
+
+  auto check_all = [&]() {
+      state.build(index, predicates, functions);
+      for (size_t i = 0; i < trees.size(); i++) {
+        ASSERT_EQ(
+          compiled[i].evaluate(state),
+          plansys2::evaluate(trees[i], predicates, functions)) << expressions[i];
+      }
+    };
+
+  check_all();
+  predicates.push_back(parser::pddl::fromStringPredicate("(patrolled wp1)"));
+  check_all();
+  functions.push_back(parser::pddl::fromStringFunction("(= (battery_level r2d2) 40.0)"));
+  check_all();
+  functions.push_back(parser::pddl::fromStringFunction("(= (distance wp1 wp2) 20.0)"));
+  check_all();
+  predicates.push_back(parser::pddl::fromStringPredicate("(patrolled wp2)"));
+  functions[0].value = 10.0;
+  check_all();
+  predicates.erase(predicates.begin());
+  check_all();
+
+  // Subtrees of a goal can be compiled on their own
+  auto subtrees = parser::pddl::getSubtrees(trees[0]);
+  ASSERT_EQ(subtrees.size(), 2u);
+  ASSERT_FALSE(plansys2::CompiledExpression(trees[0], index, subtrees[0]).check(state));
+  ASSERT_FALSE(plansys2::CompiledExpression(trees[0], index, subtrees[1]).check(state));
+
+  // Facts not present in the state are false, even if they have never been seen
+  plansys2_msgs::msg::Tree tree;
+  parser::pddl::fromString(tree, "(and (patrolled wp3))");
+  plansys2::CompiledExpression unseen(tree, index);
+  ASSERT_FALSE(unseen.check(state));
+  ASSERT_EQ(index.findId(parser::pddl::fromStringPredicate("(patrolled wp4)")), -1);
+}
+
 TEST(utils, get_subtrees)
 {
   std::vector<uint32_t> empty_expected;